@@ -4,6 +4,7 @@
 #include "FIT3094_A1_CodeGameModeBase.h"
 
 #include "Misc/FileHelper.h"
+#include "Pathfinding/CookedMap.h"
 
 TArray<FString> AFIT3094_A1_CodeGameModeBase::GetMapFileList()
 {
@@ -40,26 +41,63 @@ TArray<FString> AFIT3094_A1_CodeGameModeBase::GetMapArray(FString MapString)
 
 FString AFIT3094_A1_CodeGameModeBase::GetAssessedMapFile()
 {
-	TArray<FString> MapFiles;
-
-	const FString MapsDir = FPaths::ProjectContentDir() + "MapFiles/Assessed/Map/";
-	FPlatformFileManager::Get().GetPlatformFile().FindFiles(MapFiles, *MapsDir, nullptr);
-	
 	FString MapText;
-	FFileHelper::LoadFileToString(MapText, *MapFiles[0]);
+	FFileHelper::LoadFileToString(MapText, *GetAssessedMapPath());
 	
 	return MapText;
 }
 
 FString AFIT3094_A1_CodeGameModeBase::GetScenarioFile()
+{
+	FString ScenarioText;
+	FFileHelper::LoadFileToString(ScenarioText, *GetScenarioPath());
+	
+	return ScenarioText;
+}
+
+FString AFIT3094_A1_CodeGameModeBase::GetAssessedMapPath()
+{
+	TArray<FString> MapFiles;
+
+	const FString MapsDir = FPaths::ProjectContentDir() + "MapFiles/Assessed/Map/";
+	//Only .map files, the cooked copy lives in the same folder
+	FPlatformFileManager::Get().GetPlatformFile().FindFiles(MapFiles, *MapsDir, TEXT(".map"));
+
+	return MapFiles.Num() > 0 ? MapFiles[0] : FString();
+}
+
+FString AFIT3094_A1_CodeGameModeBase::GetScenarioPath()
 {
 	TArray<FString> ScenarioFiles;
 
 	const FString ScenarioDir = FPaths::ProjectContentDir() + "MapFiles/Assessed/Scen/";
 	FPlatformFileManager::Get().GetPlatformFile().FindFiles(ScenarioFiles, *ScenarioDir, nullptr);
 
-	FString ScenarioText;
-	FFileHelper::LoadFileToString(ScenarioText, *ScenarioFiles[0]);
-	
-	return ScenarioText;
+	return ScenarioFiles.Num() > 0 ? ScenarioFiles[0] : FString();
+}
+
+bool AFIT3094_A1_CodeGameModeBase::LoadCookedMap(const TArray<uint8>& MapFileBytes, TArray<uint8>& OutCookedBytes)
+{
+	const FString MapPath = GetAssessedMapPath();
+	if(MapPath.IsEmpty() || MapFileBytes.Num() == 0)
+	{
+		return false;
+	}
+
+	const FString CookedPath = FPaths::ChangeExtension(MapPath, TEXT("cmap"));
+	if(!FPaths::FileExists(CookedPath) || !FFileHelper::LoadFileToArray(OutCookedBytes, *CookedPath))
+	{
+		return false;
+	}
+
+	//Cooked from an older version of the .map or by an older cook step
+	Pathfinding::CookedMapInfo Info;
+	if(!Pathfinding::ReadCookedMapInfo(OutCookedBytes.GetData(), OutCookedBytes.Num(), Info)
+		|| !Pathfinding::IsCookedMapCurrent(Info, MapFileBytes.GetData(), MapFileBytes.Num()))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cooked map %s is out of date, loading the .map instead"), *CookedPath)
+		OutCookedBytes.Reset();
+		return false;
+	}
+	return true;
 }
@@ -31,6 +31,15 @@ public:
 	    FString GetAssessedMapFile();
 	UFUNCTION()
 		FString GetScenarioFile();
+
+	//Full paths of the assessed files, for callers that load the bytes themselves
+	UFUNCTION()
+		FString GetAssessedMapPath();
+	UFUNCTION()
+		FString GetScenarioPath();
+
+	//Loads the cooked .cmap next to the assessed map when it exists and was cooked from MapFileBytes
+	bool LoadCookedMap(const TArray<uint8>& MapFileBytes, TArray<uint8>& OutCookedBytes);
 	
 	
 };
@@ -5,18 +5,32 @@
 
 #include "FIT3094_A1_CodeGameModeBase.h"
 #include "Ship.h"
+#include "Async/ParallelFor.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
 #include "Engine/World.h"
 #include "Kismet/GameplayStatics.h"
+#include "Materials/MaterialInterface.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Pathfinding/CookedMap.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
 DEFINE_LOG_CATEGORY(IndividualShips);
 DEFINE_LOG_CATEGORY(Heuristics);
 DEFINE_LOG_CATEGORY(Collisions)
 
+//Names the scope in Unreal Insights and, with CollectStats on, times it into Metrics. Off it never reads the clock
+#define LEVEL_PHASE_SCOPE(Phase) TRACE_CPUPROFILER_EVENT_SCOPE_STR("LevelGenerator " #Phase); \
+	const Pathfinding::ScopedPhaseTimer Phase##Timer(CollectStats ? &Metrics : nullptr, #Phase)
+
 // Sets default values
 ALevelGenerator::ALevelGenerator()
 {
  	// Set this actor to call Tick() every frame. 
 	PrimaryActorTick.bCanEverTick = true;
+	//The instanced terrain and path markers are attached to this
+	SetRootComponent(CreateDefaultSubobject<USceneComponent>(TEXT("Root")));
 }
 
 // Called when the game starts or when spawned
@@ -25,8 +39,36 @@ void ALevelGenerator::BeginPlay()
 	Super::BeginPlay();
 
 	AFIT3094_A1_CodeGameModeBase* GameModeBase = Cast<AFIT3094_A1_CodeGameModeBase>(UGameplayStatics::GetGameMode(GetWorld()));
-	GenerateWorldFromFile(GameModeBase->GetMapArray(GameModeBase->GetAssessedMapFile()));
-	GenerateScenarioFromFile(GameModeBase->GetMapArray(GameModeBase->GetScenarioFile()));
+	if(CollectStats)
+	{
+		Metrics.BeginScenario("Map");
+	}
+
+	//The raw bytes go straight to the parsers, no FString conversion and no array of lines
+	TArray<uint8> FileBytes;
+	if(!FFileHelper::LoadFileToArray(FileBytes, *GameModeBase->GetAssessedMapPath()))
+	{
+		FileBytes.Reset();
+	}
+	//A cooked map that matches the .map skips the parse and the precomputation
+	TArray<uint8> CookedBytes;
+	if(GameModeBase->LoadCookedMap(FileBytes, CookedBytes))
+	{
+		GenerateWorldFromCookedMap(CookedBytes);
+	}
+	else
+	{
+		GenerateWorldFromFile(FileBytes);
+	}
+	if(!FFileHelper::LoadFileToArray(FileBytes, *GameModeBase->GetScenarioPath()))
+	{
+		FileBytes.Reset();
+	}
+	GenerateScenarioFromFile(FileBytes);
+	if(HeadlessReplay)
+	{
+		ReplayScenarios();
+	}
 	NextLevel();
 	
 }
@@ -36,25 +78,59 @@ void ALevelGenerator::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	int ShipsAtGoal = 0;
-
-	for(int i = 0; i < Ships.Num(); i++)
+	if(bLockstep && Ships.Num() > 0)
 	{
-		if(Ships[i]->AtGoal)
+		//Every ship moves at the same speed, so one clock for all of them keeps the reserved steps in sync
+		StepProgress += DeltaTime * Ships[0]->MoveSpeed / GRID_SIZE_WORLD;
+		while(StepProgress >= 1)
 		{
-			ShipsAtGoal++;
+			StepProgress -= 1;
+			AdvanceLockstep();
 		}
+		GlideLockstepShips();
 	}
+	else
+	{
+		SimulateShips(DeltaTime);
+	}
+	PushShipTransforms();
+	FlushPathMarkers();
 
-	if(ShipsAtGoal == Ships.Num())
+	//The fleet counts the ships as they reach their goal, no level has to be scanned for it
+	if(Fleet.AllAtGoal())
 	{
 		NextLevel();
 	}
 }
 
-void ALevelGenerator::SpawnWorldActors(TArray<TArray<char>> Grid)
+void ALevelGenerator::SpawnWorldActors()
 {
-	if(DeepBlueprint && ShallowBlueprint && LandBlueprint)
+	LEVEL_PHASE_SCOPE(SpawnWorld);
+	const double StartTime = FPlatformTime::Seconds();
+	if(CellMesh)
+	{
+		//One instance per cell, in a single batch per terrain type. The components are indexed by TerrainType
+		UMaterialInterface* Materials[3] = {DeepMaterial, LandMaterial, ShallowMaterial};
+		TArray<FTransform> Cells[3];
+		for(int Y = 0; Y < MapSizeY; Y++)
+		{
+			for(int X = 0; X < MapSizeX; X++)
+			{
+				const int Type = static_cast<int>(Grid.GetTerrain(Grid.ToIndex(X, Y)));
+				Cells[Type].Add(FTransform(FRotator(0, 0, 0), FVector(X * GRID_SIZE_WORLD, Y * GRID_SIZE_WORLD, 0), CellScale));
+			}
+		}
+		for(int Type = 0; Type < 3; Type++)
+		{
+			if(TerrainInstances.Num() <= Type)
+			{
+				TerrainInstances.Add(CreateInstances(CellMesh, Materials[Type]));
+			}
+			TerrainInstances[Type]->ClearInstances();
+			TerrainInstances[Type]->AddInstances(Cells[Type], false, true);
+		}
+	}
+	else if(DeepBlueprint && ShallowBlueprint && LandBlueprint)
 	{
 		for(int Y = 0; Y < MapSizeY; Y++)
 		{
@@ -65,24 +141,25 @@ void ALevelGenerator::SpawnWorldActors(TArray<TArray<char>> Grid)
 
 				FVector Position(XPos, YPos, 0);
 
-				switch(Grid[Y][X])
+				switch(Grid.GetTerrain(Grid.ToIndex(X, Y)))
 				{
-				case '.':
+				case Pathfinding::TerrainType::DeepWater:
 					Terrain.Add(GetWorld()->SpawnActor(DeepBlueprint, &Position));
 					break;
-				case 'T':
+				case Pathfinding::TerrainType::ShallowWater:
 					Terrain.Add(GetWorld()->SpawnActor(ShallowBlueprint, &Position));
 					break;
-				case '@':
-					Terrain.Add(GetWorld()->SpawnActor(LandBlueprint, &Position));
-					break;
 				default:
+					Terrain.Add(GetWorld()->SpawnActor(LandBlueprint, &Position));
 					break;
 				}
 			}
 		}
 	}
 
+	UE_LOG(Heuristics, Warning, TEXT("World: %d cells drawn as %d actors and %d instanced meshes in %.3f ms"), MapSizeX * MapSizeY, Terrain.Num(), TerrainInstances.Num(),
+		(FPlatformTime::Seconds() - StartTime) * 1000.0);
+
 	if(Camera)
 	{
 		FVector CameraPosition = Camera->GetActorLocation();
@@ -107,159 +184,262 @@ void ALevelGenerator::SpawnWorldActors(TArray<TArray<char>> Grid)
 	}
 }
 
-void ALevelGenerator::GenerateNodeGrid(TArray<TArray<char>> Grid)
+//Search mode, heuristic and path cache from the planning settings, shared by the level's planner and the replay's
+void ALevelGenerator::ConfigurePlanner(Pathfinding::BatchPlanner& Target) const
 {
-	for(int Y = 0; Y < MapSizeY; Y++)
+	if(HierarchicalPlanning)
 	{
-		for(int X = 0; X < MapSizeX; X++)
-		{
-			WorldArray[Y][X] = new GridNode();
-			WorldArray[Y][X]->Y = Y;
-			WorldArray[Y][X]->X = X;
+		Target.SetSectorSize(SectorSize);
+		Target.SetSearchMode(Pathfinding::SearchMode::Hierarchical);
+	}
+	else
+	{
+		Target.SetSearchMode(JumpPointSearch ? Pathfinding::SearchMode::JumpPoint : Pathfinding::SearchMode::AStar);
+	}
+	Target.SetLandmarks(LandmarkCount, RandomLandmarks ? Pathfinding::LandmarkSelection::Random : Pathfinding::LandmarkSelection::Farthest);
+	Target.SetHeuristicWeight(LandmarkCount > 0 ? 1 : 2);
+	Target.SetPathCache(static_cast<size_t>(FMath::Max(PathCacheKB, 0)) * 1024);
+}
 
-			switch(Grid[Y][X])
-			{
-			case '.':
-				WorldArray[Y][X]->GridType = GridNode::DeepWater;
-				break;
-			case '@':
-				WorldArray[Y][X]->GridType = GridNode::Land;
-				break;
-			case 'T':
-				WorldArray[Y][X]->GridType = GridNode::ShallowWater;
-				break;
-			default:
-				break;
-			}
-			
-		}
+void ALevelGenerator::GenerateNodeGrid(Pathfinding::ConnectedComponents* CookedComponents, Pathfinding::LandmarkTable* CookedLandmarks)
+{
+	//Grid already holds the terrain, the map loader decodes the rows straight into it
+	//The jump table or sector graph of the chosen mode and the landmark distances are precomputed here, once per map
+	ConfigurePlanner(Planner);
+	Occupancy.Init(Grid.Num());
+	Planner.SetOccupancy(&Occupancy);
+	//The water components are labelled here as well, so a query with an unreachable goal is rejected without a search
+	if(CookedComponents)
+	{
+		Pathfinding::LandmarkTable NoLandmarks;
+		Planner.SetGrid(&Grid, MoveTemp(*CookedComponents), MoveTemp(CookedLandmarks ? *CookedLandmarks : NoLandmarks));
+	}
+	else
+	{
+		Planner.SetGrid(&Grid);
+	}
+	//One set of goal fields for the grid, the multi ship planners read the same ones
+	GoalFields.SetGrid(&Grid);
+	GoalFields.SetCapacity(GoalFieldCapacity);
+	GoalFields.SetComponents(&Planner.GetFreeWater());
+	GoalFields.SetOccupancy(&Occupancy);
+	Cooperative.SetGrid(&Grid);
+	Cooperative.SetGoalFields(&GoalFields);
+	ConflictSolver.SetGrid(&Grid);
+	ConflictSolver.SetGoalFields(&GoalFields);
+	if(ParallelPlanning)
+	{
+		Planner.SetWorkerCount(PlanningThreads > 0 ? PlanningThreads : FPlatformMisc::NumberOfWorkerThreadsToSpawn() + 1);
+	}
+	else
+	{
+		Planner.SetWorkerCount(1);
 	}
 }
 
 void ALevelGenerator::ResetAllNodes()
 {
-	for( int Y = 0; Y < MapSizeY; Y++)
+	//G, F and Parent are only valid for the search generation stamped on the cell, so they never need a sweep here
+	//Only the occupancy is reset, every ship of the new level holds the cell it spawned on
+	Occupancy.Clear();
+	for(int i = 0; i < Ships.Num(); i++)
 	{
-		for(int X = 0; X < MapSizeX; X++)
-		{
-			WorldArray[Y][X]->F = 0;
-			WorldArray[Y][X]->G = 0;
-			WorldArray[Y][X]->H = 0;
-			WorldArray[Y][X]->Parent = nullptr;
-			WorldArray[Y][X]->ObjectAtLocation = nullptr;
-		}
+		Occupancy.Place(Ships[i]->ShipId, GetShipCell(Ships[i]));
 	}
+	Planner.OnOccupancyCleared();
 }
 
-float ALevelGenerator::CalculateDistanceBetween(GridNode* First, GridNode* Second)
+float ALevelGenerator::CalculateDistanceBetween(int First, int Second)
 {
-	FVector DistToTarget = FVector(Second->X - First->X,Second->Y - First->Y, 0);
+	FVector DistToTarget = FVector(Grid.GetX(Second) - Grid.GetX(First), Grid.GetY(Second) - Grid.GetY(First), 0);
 	return DistToTarget.Size();
 }
 
-void ALevelGenerator::GenerateWorldFromFile(TArray<FString> WorldArrayStrings)
+void ALevelGenerator::GenerateWorldFromFile(const TArray<uint8>& MapFileBytes)
 {
-	if(WorldArrayStrings.Num() == 0)
+	LEVEL_PHASE_SCOPE(MapLoad);
+	if(MapFileBytes.Num() == 0 || !Pathfinding::ParseMap(reinterpret_cast<const char*>(MapFileBytes.GetData()), MapFileBytes.Num(), Grid))
 	{
 		UE_LOG(LogTemp, Error, TEXT("Map file not found!"))
 		return;
 	}
 
-	FString Height = WorldArrayStrings[1];
-	Height.RemoveFromStart("height ");
-	MapSizeY = FCString::Atoi(*Height);
-
-	FString Width = WorldArrayStrings[2];
-	Width.RemoveFromStart("width ");
-	MapSizeX = FCString::Atoi(*Width);
+	MapSizeX = Grid.GetWidth();
+	MapSizeY = Grid.GetHeight();
 
-	TArray<TArray<char>> CharMapArray;
-	CharMapArray.Init( TArray<char>(), MAX_MAP_SIZE);
+	GenerateNodeGrid();
+	SpawnWorldActors();
 	
-	for(int i = 0; i < CharMapArray.Num(); i++)
+}
+
+void ALevelGenerator::GenerateWorldFromCookedMap(const TArray<uint8>& CookedMapBytes)
+{
+	LEVEL_PHASE_SCOPE(MapLoad);
+	Pathfinding::CookedMapInfo Info;
+	if(!Pathfinding::ReadCookedMapInfo(CookedMapBytes.GetData(), CookedMapBytes.Num(), Info))
 	{
-		CharMapArray[i].Init('x', MAX_MAP_SIZE);
+		UE_LOG(LogTemp, Error, TEXT("Cooked map is unreadable!"))
+		return;
 	}
-	
-	for(int LineNum = 4; LineNum < MapSizeY + 4; LineNum++)
+
+	//The stored landmarks are only used when they were cooked with the settings this level generator asks for
+	const Pathfinding::LandmarkSelection Selection = RandomLandmarks ? Pathfinding::LandmarkSelection::Random : Pathfinding::LandmarkSelection::Farthest;
+	const bool bUseLandmarks = LandmarkCount > 0 && Info.LandmarkCount == LandmarkCount && Info.Selection == Selection;
+
+	Pathfinding::ConnectedComponents CookedComponents;
+	Pathfinding::LandmarkTable CookedLandmarks;
+	if(!Pathfinding::ReadCookedMap(CookedMapBytes.GetData(), CookedMapBytes.Num(), Grid, &CookedComponents, bUseLandmarks ? &CookedLandmarks : nullptr))
 	{
-		for(int CharNum = 0; CharNum < MapSizeX; CharNum++)
-		{
-			CharMapArray[LineNum-4][CharNum] = WorldArrayStrings[LineNum][CharNum];
-		}
+		UE_LOG(LogTemp, Error, TEXT("Cooked map failed its checksum!"))
+		return;
 	}
 
-	GenerateNodeGrid(CharMapArray);
-	SpawnWorldActors(CharMapArray);
-	
+	MapSizeX = Grid.GetWidth();
+	MapSizeY = Grid.GetHeight();
+
+	GenerateNodeGrid(&CookedComponents, bUseLandmarks ? &CookedLandmarks : nullptr);
+	SpawnWorldActors();
 }
 
-void ALevelGenerator::GenerateScenarioFromFile(TArray<FString> ScenarioArrayStrings)
+void ALevelGenerator::GenerateScenarioFromFile(const TArray<uint8>& ScenarioFileBytes)
 {
-	if(ScenarioArrayStrings.Num() == 0)
+	LEVEL_PHASE_SCOPE(ScenarioLoad);
+	std::vector<Pathfinding::ScenarioEntry> Entries;
+	if(ScenarioFileBytes.Num() == 0 || !Pathfinding::ParseScenario(reinterpret_cast<const char*>(ScenarioFileBytes.GetData()), ScenarioFileBytes.Num(), Entries))
 	{
 		return;
 	}
-	
-	for(int i = 1; i < ScenarioArrayStrings.Num(); i++)
-	{
-		TArray<FString> SplitLine;
-		FString CurrentLine = ScenarioArrayStrings[i];
-		
-		CurrentLine.ParseIntoArray(SplitLine,TEXT("\t"));
-
-		int ShipX = FCString::Atoi(*SplitLine[4]);
-		int ShipY = FCString::Atoi(*SplitLine[5]);
-		int GoldX = FCString::Atoi(*SplitLine[6]);
-		int GoldY = FCString::Atoi(*SplitLine[7]);
 
-		ShipSpawns.Add(FVector2d(ShipX, ShipY));
-		GoldSpawns.Add(FVector2d(GoldX, GoldY));
+	ShipSpawns.Reserve(ShipSpawns.Num() + Entries.size());
+	GoldSpawns.Reserve(GoldSpawns.Num() + Entries.size());
+	for(const Pathfinding::ScenarioEntry& Entry : Entries)
+	{
+		ShipSpawns.Add(FVector2d(Entry.StartX, Entry.StartY));
+		GoldSpawns.Add(FVector2d(Entry.GoalX, Entry.GoalY));
 	}
 }
 
 void ALevelGenerator::InitialisePaths()
 {
 	ResetPath();
-	CalculatePath();
+	{
+		LEVEL_PHASE_SCOPE(Plan);
+		CalculatePath();
+		FlushPathMarkers();
+	}
 	DetailPlan();
 }
 
 void ALevelGenerator::RenderPath(AShip* Ship)
 {
-	GridNode* CurrentNode = Ship->GoalNode;
-
-	if(CurrentNode)
+	const double StartTime = FPlatformTime::Seconds();
+	if(PathMarkerMesh)
+	{
+		PathMarkers.Add(PlannedPath);
+	}
+	else
 	{
-		while(CurrentNode->Parent != nullptr)
+		//PlannedPath is already in walking order, from the first move to the goal
+		for(const int32_t CurrentNode : PlannedPath)
 		{
-			FVector Position(CurrentNode->X * GRID_SIZE_WORLD, CurrentNode->Y * GRID_SIZE_WORLD, 10);
+			FVector Position(Grid.GetX(CurrentNode) * GRID_SIZE_WORLD, Grid.GetY(CurrentNode) * GRID_SIZE_WORLD, 10);
 			AActor* PathActor = GetWorld()->SpawnActor(PathDisplayBlueprint, &Position);
 			PathDisplayActors.Add(PathActor);
-
-			Ship->Path.EmplaceAt(0, WorldArray[CurrentNode->Y][CurrentNode->X]);
-			CurrentNode = CurrentNode->Parent;
 		}
 	}
-	
-	
+	MarkerTime += FPlatformTime::Seconds() - StartTime;
+	Ship->Path.Assign(PlannedPath);
 }
 
 void ALevelGenerator::ResetPath()
 {
 	SearchCount = 0;
+	SearchTime = 0;
+	MarkerTime = 0;
+	Planner.ResetStats();
 	ResetAllNodes();
 
+	const double StartTime = FPlatformTime::Seconds();
 	for(int i = 0; i < PathDisplayActors.Num(); i++)
 	{
 		PathDisplayActors[i]->Destroy();
 	}
 	PathDisplayActors.Empty();
+	//The instances stay, FlushPathMarkers moves them onto the next plans
+	PathMarkers.Clear();
+	MarkerTime += FPlatformTime::Seconds() - StartTime;
 
 	for(int i = 0; i < Ships.Num(); i++)
 	{
-		Ships[i]->Path.Empty();
+		Ships[i]->Path.Clear();
+	}
+}
+
+UHierarchicalInstancedStaticMeshComponent* ALevelGenerator::CreateInstances(UStaticMesh* Mesh, UMaterialInterface* Material)
+{
+	UHierarchicalInstancedStaticMeshComponent* Instances = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+	Instances->SetStaticMesh(Mesh);
+	if(Material)
+	{
+		Instances->SetMaterial(0, Material);
 	}
+	//Nothing collides with the terrain or the markers, the ships are moved without sweeps
+	Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Instances->SetupAttachment(GetRootComponent());
+	Instances->RegisterComponent();
+	AddInstanceComponent(Instances);
+	return Instances;
+}
+
+/*
+ * Description:
+ *			Writes the path markers that changed since the last flush into the path marker instances, at most one
+ *			batch update and one batch of new instances. Only touches the instances, the ships' paths were handed over
+ *			in RenderPath
+ */
+void ALevelGenerator::FlushPathMarkers()
+{
+	if(!PathMarkerMesh || !PathMarkers.IsChanged())
+	{
+		return;
+	}
+	LEVEL_PHASE_SCOPE(PathMarkers);
+	const double StartTime = FPlatformTime::Seconds();
+	if(!PathMarkerInstances)
+	{
+		PathMarkerInstances = CreateInstances(PathMarkerMesh, PathMarkerMaterial);
+	}
+
+	const Pathfinding::MarkerFlush Plan = PathMarkers.Flush();
+	const std::vector<int32_t>& Cells = PathMarkers.GetCells();
+	auto MarkerAt = [this](int32_t Cell)
+	{
+		return FTransform(FRotator(0, 0, 0), FVector(Grid.GetX(Cell) * GRID_SIZE_WORLD, Grid.GetY(Cell) * GRID_SIZE_WORLD, 10), PathMarkerScale);
+	};
+	if(Plan.Moved + Plan.Hidden > 0)
+	{
+		PathMarkerScratch.Reset();
+		for(int i = Plan.First; i < Plan.First + Plan.Moved; i++)
+		{
+			PathMarkerScratch.Add(MarkerAt(Cells[i]));
+		}
+		const FTransform Hidden(FRotator(0, 0, 0), FVector(0, 0, 0), FVector(0, 0, 0));
+		for(int i = 0; i < Plan.Hidden; i++)
+		{
+			PathMarkerScratch.Add(Hidden);
+		}
+		PathMarkerInstances->BatchUpdateInstancesTransforms(Plan.First, PathMarkerScratch, true, true, true);
+	}
+	if(Plan.Added > 0)
+	{
+		PathMarkerScratch.Reset();
+		for(int i = Plan.First + Plan.Moved; i < Plan.First + Plan.Moved + Plan.Added; i++)
+		{
+			PathMarkerScratch.Add(MarkerAt(Cells[i]));
+		}
+		PathMarkerInstances->AddInstances(PathMarkerScratch, false, true);
+	}
+	MarkerTime += FPlatformTime::Seconds() - StartTime;
 }
 
 void ALevelGenerator::DetailPlan()
@@ -279,7 +459,11 @@ void ALevelGenerator::DetailPlan()
 		
 		for(int j = 1; j < Ships[i]->Path.Num(); j++)
 		{
-			TotalPathCost += Ships[i]->Path[j]->GetTravelCost();
+			//A cooperative plan repeats the cell when the ship waits, which costs nothing
+			if(Ships[i]->Path[j] != Ships[i]->Path[j - 1])
+			{
+				TotalPathCost += Grid.GetTravelCost(Ships[i]->Path[j]);
+			}
 		}
 		
 		if(IndividualStats)
@@ -292,17 +476,42 @@ void ALevelGenerator::DetailPlan()
 	
 	GEngine->AddOnScreenDebugMessage(-1, 12.f, FColor::Red, FString::Printf(TEXT("Total Estimated Path Cost: %d"), TotalPathCost));
 	GEngine->AddOnScreenDebugMessage(-1, 12.f, FColor::Red, FString::Printf(TEXT("Total Cells Expanded: %d with a Total Path Action Amount of: %d"), SearchCount, ShipPathLength));
+	GEngine->AddOnScreenDebugMessage(-1, 12.f, FColor::Red, FString::Printf(TEXT("Total Search Time: %.3f ms (%.3f us per expansion)"), SearchTime * 1000.0, SearchCount > 0 ? SearchTime * 1000000.0 / SearchCount : 0.0));
 	GEngine->AddOnScreenDebugMessage(-1, 12.f, FColor::Red, FString::Printf(TEXT("CURRENT SCENARIO TOTAL")));
 	
 	UE_LOG(Heuristics, Warning, TEXT("CURRENT SCENARIO TOTAL"));
 	UE_LOG(Heuristics, Warning, TEXT("Total Cells Expanded: %d with a total path length of: %d"), SearchCount, ShipPathLength);
 	UE_LOG(Heuristics, Warning, TEXT("Total Estimated Path Cost: %d"), TotalPathCost);
+	UE_LOG(Heuristics, Warning, TEXT("Total Search Time: %.3f ms (%.3f us per expansion)"), SearchTime * 1000.0, SearchCount > 0 ? SearchTime * 1000000.0 / SearchCount : 0.0);
+	UE_LOG(Heuristics, Warning, TEXT("Path Markers: %d drawn as %d actors and %d instances in %.3f ms"), PathDisplayActors.Num() + static_cast<int>(PathMarkers.GetCells().size()),
+		PathDisplayActors.Num(), PathMarkers.GetInstanceCount(), MarkerTime * 1000.0);
+	UE_LOG(Heuristics, Warning, TEXT("Node Resets Skipped: %lld (Nodes Touched: %lld over %lld searches)"), Planner.GetNodeResetsSkipped(), Planner.GetStats().NodesTouched, Planner.GetStats().Searches);
+	UE_LOG(Heuristics, Warning, TEXT("Unreachable Goals Rejected: %lld"), Planner.GetStats().Unreachable);
+	const Pathfinding::PathCacheStats& CacheStats = Planner.GetPathCache().GetStats();
+	UE_LOG(Heuristics, Warning, TEXT("Path Cache: %lld of %lld queries answered (%.1f%%, %lld from the tail of a kept path), %lld expansions saved"), CacheStats.Hits, CacheStats.Lookups,
+		CacheStats.Lookups > 0 ? 100.0 * CacheStats.Hits / CacheStats.Lookups : 0.0, CacheStats.SuffixHits, CacheStats.SavedExpansions);
+	UE_LOG(Heuristics, Warning, TEXT("Path Cache: %d paths in %.1f KB, %lld cells packed into %lld bytes of runs"), Planner.GetPathCache().GetPathCount(), Planner.GetPathCache().GetMemoryBytes() / 1024.0,
+		CacheStats.StoredCells, CacheStats.StoredRunBytes);
+	//What the planners hold for this scenario, the scratch is reused from one scenario to the next
+	size_t ScratchBytes = 0;
+	for (int Worker = 0; Worker < Planner.GetWorkerCount(); Worker++)
+	{
+		ScratchBytes += Planner.GetContext(Worker).GetFlatMemoryBytes();
+	}
+	UE_LOG(Heuristics, Warning, TEXT("Memory: grid %.1f KB, occupancy %.1f KB, search scratch %.1f KB, goal fields %.1f KB"), Grid.GetMemoryBytes() / 1024.0, Occupancy.GetMemoryBytes() / 1024.0,
+		ScratchBytes / 1024.0, GoalFields.GetMemoryBytes() / 1024.0);
+	if(ConflictBasedPlanning)
+	{
+		const Pathfinding::PathArena& Arena = ConflictSolver.GetPathArena();
+		UE_LOG(Heuristics, Warning, TEXT("Conflict Search Paths: %lld allocations (%lld cells) from %lld heap blocks, peak %.1f KB of %.1f KB reserved"), Arena.GetStats().Allocations, Arena.GetStats().Cells,
+			Arena.GetStats().BlockAllocations, Arena.GetStats().PeakBytes / 1024.0, Arena.GetReservedBytes() / 1024.0);
+	}
 
 }
 
 void ALevelGenerator::DetailActual()
 {
-	if(CollisionAndReplanning)
+	if(CollisionAndReplanning || bLockstep)
 	{
 		int TotalPathCost = 0;
 	
@@ -321,15 +530,83 @@ void ALevelGenerator::DetailActual()
 		UE_LOG(Heuristics, Warning, TEXT("PREVIOUS SCENARIO"));
 		UE_LOG(Heuristics, Warning, TEXT("Actual Total Cells Expanded: %d with actual Total Path Action Amount of: %d"), SearchCount, PathCostTaken.Num());
 		UE_LOG(Heuristics, Warning, TEXT("Actual Total Path Cost including Crashes & Replanning: %d"), TotalPathCost);
+		UE_LOG(Heuristics, Warning, TEXT("Actual Total Search Time including Replanning: %.3f ms"), SearchTime * 1000.0);
+		UE_LOG(Heuristics, Warning, TEXT("Actual Path Marker Time including Replanning: %.3f ms"), MarkerTime * 1000.0);
+		UE_LOG(Heuristics, Warning, TEXT("Actual Node Resets Skipped: %lld (Nodes Touched: %lld over %lld searches)"), Planner.GetNodeResetsSkipped(), Planner.GetStats().NodesTouched, Planner.GetStats().Searches);
+		UE_LOG(Heuristics, Warning, TEXT("Actual Unreachable Goals Rejected: %lld"), Planner.GetStats().Unreachable + Planner.GetReplanStats().Unreachable);
+		if(bConflictSolved)
+		{
+			const Pathfinding::ConflictSearchStats& Stats = ConflictSolver.GetStats();
+			UE_LOG(Heuristics, Warning, TEXT("Actual Conflict-Based Search: %d conflicts solved in %.3f ms with %lld nodes, sum of costs %lld (lower bound %lld)"), Stats.InitialConflicts, Stats.Milliseconds, Stats.HighLevelNodes, ConflictSolver.GetSumOfCosts(), ConflictSolver.GetLowerBound());
+		}
+		else if(CooperativePlanning)
+		{
+			const Pathfinding::CooperativeStats& Stats = Cooperative.GetStats();
+			const Pathfinding::ReservationTable& Reservations = Cooperative.GetReservations();
+			UE_LOG(Heuristics, Warning, TEXT("Actual Cooperative Windows: %lld planned with %lld expansions, %lld boxed in"), Stats.Searches, Stats.Expansions, Stats.Failed);
+			UE_LOG(Heuristics, Warning, TEXT("Actual Peak Reservations: %d (%.1f bytes per reservation)"), Stats.PeakReservations, Reservations.GetCount() > 0 ? (double)Reservations.GetSlotBytes() / Reservations.GetCount() : 0.0);
+		}
+		else if(IncrementalReplanning && !SharedGoalFields)
+		{
+			UE_LOG(Heuristics, Warning, TEXT("Actual Incremental Replans: %lld repaired with %lld expansions"), Planner.GetReplanStats().Searches, Planner.GetReplanStats().Expansions);
+		}
+		const Pathfinding::GoalFieldStats& FieldStats = GoalFields.GetStats();
+		UE_LOG(Heuristics, Warning, TEXT("Actual Goal Fields: %lld hits, %lld misses, %lld evicted, %d kept in %.1f KB"), FieldStats.Hits, FieldStats.Misses, FieldStats.Evictions, GoalFields.GetFieldCount(), GoalFields.GetMemoryBytes() / 1024.0);
+		UE_LOG(Heuristics, Warning, TEXT("Actual Goal Field Paths: %lld followed downhill, %lld searched around blocked cells with %lld expansions"), FieldStats.Descents, FieldStats.LocalSearches, FieldStats.LocalExpansions);
+		const Pathfinding::OccupancyStats& MoveStats = Occupancy.GetStats();
+		UE_LOG(Heuristics, Warning, TEXT("Actual Occupancy: %lld moves, %lld followed a ship out of its cell, %lld blocked, %lld head on"), MoveStats.Moves, MoveStats.Followed, MoveStats.Blocked, MoveStats.Oncoming);
 		UE_LOG(Heuristics, Warning, TEXT("Ratio of Actual vs Planned: %fx"), (float)(TotalPathCost)/PreviousPlannedCost);
 	}
 
 	CrashPenalty = 0;
 	PathCostTaken.Empty();
+	GoalFields.ResetStats();
+	Occupancy.ResetStats();
+}
+
+/*
+ * Description:
+ *			Run every level of the ladder through a Pathfinding::ShipSimulation with the planning settings of this level
+ *			generator and log what the ships paid. Moves take whole steps instead of frame time, so the same map,
+ *			scenario, settings and ReplaySeed always log the same numbers and checksum. Goal fields and the multi ship
+ *			planners are not replayed, their levels use the planner's paths
+ */
+void ALevelGenerator::ReplayScenarios()
+{
+	Pathfinding::ShipSimulation Simulation;
+	ConfigurePlanner(Simulation.GetPlanner());
+	Simulation.SetGrid(&Grid);
+	Pathfinding::SimulationSettings Settings;
+	Settings.bReplan = CollisionAndReplanning;
+	Settings.bIncremental = IncrementalReplanning;
+	Settings.Seed = static_cast<uint32>(ReplaySeed);
+
+	const double StartTime = FPlatformTime::Seconds();
+	int Row = TotalIndex;
+	std::vector<Pathfinding::PathQuery> Queries;
+	for(int Level = 0; Level < 7; Level++)
+	{
+		Queries.clear();
+		for(int i = 0; i < Scenarios[Level] && Row < ShipSpawns.Num() && Row < GoldSpawns.Num(); i++, Row++)
+		{
+			Pathfinding::PathQuery Query;
+			Query.Start = Grid.ToIndex(ShipSpawns[Row].X, ShipSpawns[Row].Y);
+			Query.Goal = Grid.ToIndex(GoldSpawns[Row].X, GoldSpawns[Row].Y);
+			Queries.push_back(Query);
+		}
+		const Pathfinding::SimulationResult Result = Simulation.Run(Queries, Settings);
+		UE_LOG(Heuristics, Warning, TEXT("Replay L%d: %d of %d ships arrived after %d steps, planned %lld, actual %lld including %lld crashes, %lld replans, %lld cells expanded, checksum %016llx"),
+			Level + 1, Result.Arrived, Result.Ships, Result.Steps, Result.PlannedCost, Result.CostTaken + Result.CrashPenalty, Result.Crashes, Result.Replans, Result.Expansions, Result.Checksum);
+	}
+	UE_LOG(Heuristics, Warning, TEXT("Replay took %.3f ms"), (FPlatformTime::Seconds() - StartTime) * 1000.0);
 }
 
 void ALevelGenerator::NextLevel()
 {
+	if(CollectStats && ScenarioIndex > 0 && !FinishedScenarios)
+	{
+		ExportStats();
+	}
 	DestroyAllActors();
 	
 	if(ScenarioIndex >= 7)
@@ -348,36 +625,69 @@ void ALevelGenerator::NextLevel()
 		{
 			DetailActual();
 		}
+		if(CollectStats)
+		{
+			Metrics.BeginScenario("L" + std::to_string(ScenarioIndex + 1));
+		}
 		
-		for(int i = 0; i < Scenarios[ScenarioIndex]; i++)
+		SpawnShips();
+		TotalIndex += Scenarios[ScenarioIndex];
+		ScenarioIndex++;
+		InitialisePaths();
+	}
+}
+
+void ALevelGenerator::SpawnShips()
+{
+	LEVEL_PHASE_SCOPE(SpawnShips);
+	for(int i = 0; i < Scenarios[ScenarioIndex]; i++)
+	{
+		if(GoldBlueprint && ShipBlueprint)
 		{
-			if(GoldBlueprint && ShipBlueprint)
-			{
-				int GoldXPos = GoldSpawns[i + TotalIndex].X;
-				int GoldYPos = GoldSpawns[i + TotalIndex].Y;
+			int GoldXPos = GoldSpawns[i + TotalIndex].X;
+			int GoldYPos = GoldSpawns[i + TotalIndex].Y;
 
-				FVector GoldPosition(GoldXPos* GRID_SIZE_WORLD, GoldYPos* GRID_SIZE_WORLD, 20);
-				AActor* Gold = GetWorld()->SpawnActor(GoldBlueprint, &GoldPosition);
-				
-				Goals.Add(Gold);
+			FVector GoldPosition(GoldXPos* GRID_SIZE_WORLD, GoldYPos* GRID_SIZE_WORLD, 20);
+			AActor* Gold = GetWorld()->SpawnActor(GoldBlueprint, &GoldPosition);
+			
+			Goals.Add(Gold);
 
-				int ShipXPos = ShipSpawns[i + TotalIndex].X;
-				int ShipYPos = ShipSpawns[i + TotalIndex].Y;
+			int ShipXPos = ShipSpawns[i + TotalIndex].X;
+			int ShipYPos = ShipSpawns[i + TotalIndex].Y;
 
-				FVector ShipPosition(ShipXPos* GRID_SIZE_WORLD, ShipYPos* GRID_SIZE_WORLD, 20);
-				AShip* Ship = Cast<AShip>(GetWorld()->SpawnActor(ShipBlueprint, &ShipPosition));
+			FVector ShipPosition(ShipXPos* GRID_SIZE_WORLD, ShipYPos* GRID_SIZE_WORLD, 20);
+			AShip* Ship = Cast<AShip>(GetWorld()->SpawnActor(ShipBlueprint, &ShipPosition));
 
-				Ship->GoalNode = WorldArray[GoldYPos][GoldXPos];
-				Ships.Add(Ship);
-			}
+			Ship->GoalNode = Grid.ToIndex(GoldXPos, GoldYPos);
+			Ship->ShipId = Ships.Add(Ship);
+			Fleet.Add(ShipPosition.X, ShipPosition.Y, ShipPosition.Z, Ship->MoveSpeed, Ship->Tolerance);
 		}
-		
-		TotalIndex += Scenarios[ScenarioIndex];
-		ScenarioIndex++;
-		InitialisePaths();
 	}
 }
 
+/*
+ * Description:
+ *			Adds the counters of the level that just ended to its scenario, its phases were timed while it ran, and
+ *			writes every scenario so far to Saved/PathfindingStats.json
+ */
+void ALevelGenerator::ExportStats()
+{
+	const Pathfinding::PlannerStats Searches = Planner.GetStats();
+	const Pathfinding::PlannerStats& Repairs = Planner.GetReplanStats();
+	Metrics.AddCount("Ships", Ships.Num());
+	Metrics.AddCount("Expansions", SearchCount);
+	Metrics.AddCount("Searches", Searches.Searches + Repairs.Searches);
+	Metrics.SetMax("OpenPeak", Searches.OpenPeak);
+	Metrics.AddCount("DecreaseKeys", Searches.DecreaseKeys);
+	Metrics.AddCount("HeuristicEvaluations", Searches.HeuristicEvaluations);
+	Metrics.AddCount("CrashPenalty", CrashPenalty);
+	Metrics.AddCount("Actors", Terrain.Num() + PathDisplayActors.Num() + Goals.Num() + Ships.Num());
+	Metrics.AddCount("PathMarkerInstances", PathMarkers.GetInstanceCount());
+
+	const FString StatsPath = FPaths::ProjectSavedDir() + TEXT("PathfindingStats.json");
+	FFileHelper::SaveStringToFile(UTF8_TO_TCHAR(Metrics.ToJson().c_str()), *StatsPath);
+}
+
 void ALevelGenerator::DestroyAllActors()
 {
 	for(int i = 0; i < Goals.Num(); i++)
@@ -391,12 +701,14 @@ void ALevelGenerator::DestroyAllActors()
 		PathDisplayActors[i]->Destroy();
 	}
 	PathDisplayActors.Empty();
+	PathMarkers.Clear();
 	
 	for(int i = 0; i < Ships.Num(); i++)
 	{
 		Ships[i]->Destroy();
 	}
 	Ships.Empty();
+	Fleet.Clear();
 	
 }
 
@@ -404,218 +716,531 @@ void ALevelGenerator::DestroyAllActors()
 
 void ALevelGenerator::CalculatePath()
 {
-	//INSERT YOUR PATHFINDING ALGORITHM HERE
-	//Loop through every ship in the level by using the for each loop
-	for (const auto Ship:Ships)
-	{
-		ResetAllNodes();
-		//Get the start node and end node
-		const int StartLocationX = Ship->GetActorLocation().X/GRID_SIZE_WORLD;
-		const int StartLocationY = Ship->GetActorLocation().Y/GRID_SIZE_WORLD;
-		GridNode* GoalLocation = Ship->GoalNode;
-		GridNode* StartNode = WorldArray[StartLocationY][StartLocationX];
-		//Initialize the openlist by add start node in it.
-		OpenList.Add(StartNode);
-		//Main loop of the search algorithms 
-		while (!OpenList.IsEmpty())
-		{
-			//get the node that has minimum f value.
-			//The FindMinNode is used to search the node that has lowest f value in the open list. And return that node
-			GridNode* CurrentNode = FindMinNode();
-			//update open and close list
-			CloseList.Add(CurrentNode);
-			OpenList.Remove(CurrentNode);
-			//Check to see the current node is the target node or not. This will break the loop if it reach the target node.
-			if (CurrentNode == GoalLocation)
+	bLockstep = false;
+	bConflictSolved = false;
+	if(CooperativePlanning)
+	{
+		CalculateCooperativePaths();
+		return;
+	}
+	if(ConflictBasedPlanning && CalculateConflictFreePaths())
+	{
+		return;
+	}
+	if(SharedGoalFields)
+	{
+		//The fields are kept in one cache, so these plans stay on the game thread
+		for (int i = 0; i < Ships.Num(); i++)
+		{
+			FollowGoalField(Ships[i]);
+			RenderPath(Ships[i]);
+		}
+		return;
+	}
+	//The search itself lives in Pathfinding::PathPlanner so it can also run outside of the engine
+	//Collect one query per ship first, the searches only read the grid so they can run on any thread
+	ShipQueries.resize(Ships.Num());
+	ShipResults.resize(Ships.Num());
+	for (int i = 0; i < Ships.Num(); i++)
+	{
+		ShipQueries[i].Start = GetShipCell(Ships[i]);
+		ShipQueries[i].Goal = Ships[i]->GoalNode;
+		ShipQueries[i].Options = Pathfinding::SearchOptions();
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	//The path cache is only read before and written after the searches, so thread timing never changes a plan
+	Planner.BeginBatch(ShipQueries, ShipResults);
+	const std::vector<int32_t>& Pending = Planner.GetPendingQueries();
+	const int Searches = static_cast<int>(Pending.size());
+	const int Workers = FMath::Min(Planner.GetWorkerCount(), Searches);
+	if (Workers > 1)
+	{
+		//Worker i plans pending ships i, i + Workers, ... with its own search context
+		ParallelFor(Workers, [this, &Pending, Searches, Workers](int32 Worker)
+		{
+			for (int i = Worker; i < Searches; i += Workers)
 			{
-				break;
+				Planner.SearchQuery(Worker, ShipQueries[Pending[i]], ShipResults[Pending[i]]);
 			}
-			//This if condition is used to prevent crash
-			if (CurrentNode)
+		});
+	}
+	else
+	{
+		for (int i = 0; i < Searches; i++)
+		{
+			Planner.SearchQuery(0, ShipQueries[Pending[i]], ShipResults[Pending[i]]);
+		}
+	}
+	Planner.EndBatch(ShipQueries, ShipResults);
+	SearchTime += FPlatformTime::Seconds() - StartTime;
+
+	//Spawning the path actors has to stay on the game thread
+	for (int i = 0; i < Ships.Num(); i++)
+	{
+		SearchCount += ShipResults[i].Expansions;
+		Ships[i]->CellsSearched += ShipResults[i].Expansions;
+		PlannedPath.swap(ShipResults[i].Path);
+		RenderPath(Ships[i]);
+	}
+}
+
+//Convert the location of a ship into the cell it stands on
+int ALevelGenerator::GetShipCell(const AShip* Ship) const
+{
+	const int LocationX = Fleet.GetX(Ship->ShipId)/GRID_SIZE_WORLD;
+	const int LocationY = Fleet.GetY(Ship->ShipId)/GRID_SIZE_WORLD;
+	return Grid.ToIndex(LocationX, LocationY);
+}
+
+//Ship sets off from its cell into To, both are held until EndShipMove. LeaveTime is when it is clear of the first cell
+void ALevelGenerator::BeginShipMove(AShip* Ship, int32 To, float LeaveTime)
+{
+	Occupancy.BeginMove(Ship->ShipId, To, LeaveTime);
+	//A cell taken over from another ship stays closed, the planner skips it
+	Planner.OnOccupancyChanged(To);
+}
+
+void ALevelGenerator::EndShipMove(AShip* Ship)
+{
+	const int32 From = Occupancy.GetCell(Ship->ShipId);
+	Occupancy.Arrive(Ship->ShipId);
+	Planner.OnOccupancyChanged(From);
+}
+
+void ALevelGenerator::PlaceShip(AShip* Ship, int32 Cell)
+{
+	RemoveShip(Ship);
+	Occupancy.Place(Ship->ShipId, Cell);
+	Planner.OnOccupancyChanged(Cell);
+}
+
+void ALevelGenerator::RemoveShip(AShip* Ship)
+{
+	const int32 Cell = Occupancy.GetCell(Ship->ShipId);
+	const int32 Next = Occupancy.GetNextCell(Ship->ShipId);
+	Occupancy.Remove(Ship->ShipId);
+	Planner.OnOccupancyChanged(Cell);
+	Planner.OnOccupancyChanged(Next);
+}
+
+/*
+ * Input:
+ *			The ship that needs a path, it is planned from the cell it stands on to its goal
+ *			Options passed on to the planner (cell to avoid and whether occupied cells are avoided)
+ * Description:
+ *			Run one search, or take the path from the path cache, store the result in PlannedPath and add the
+ *			expansions and time into the scenario stats
+ *			Return true if the goal has been reached
+ */
+bool ALevelGenerator::SearchPath(AShip* Ship, const Pathfinding::SearchOptions& Options)
+{
+	LEVEL_PHASE_SCOPE(Search);
+	const double StartTime = FPlatformTime::Seconds();
+	Pathfinding::PathQuery Query;
+	Query.Start = GetShipCell(Ship);
+	Query.Goal = Ship->GoalNode;
+	Query.Options = Options;
+	//Replanning happens on the game thread while the ships tick, so it always uses the first search context
+	//A query without options may be answered by the path cache instead
+	Planner.RunQuery(0, Query, RepairedPath);
+	PlannedPath.swap(RepairedPath.Path);
+	SearchTime += FPlatformTime::Seconds() - StartTime;
+
+	SearchCount += RepairedPath.Expansions;
+	Ship->CellsSearched += RepairedPath.Expansions;
+	return RepairedPath.bFound;
+}
+
+/*
+ * Input:
+ *			The ship that needs a new path
+ *			Options passed on to the planner (cell to avoid and whether occupied cells are avoided)
+ * Description:
+ *			Same as SearchPath, but the ship's search from its last replan is kept and only repaired around the cells
+ *			that were blocked or freed since then. Falls back to SearchPath when IncrementalReplanning is off
+ *			Return true if the goal has been reached
+ */
+bool ALevelGenerator::RepairPath(AShip* Ship, const Pathfinding::SearchOptions& Options)
+{
+	if(!IncrementalReplanning)
+	{
+		return SearchPath(Ship, Options);
+	}
+
+	LEVEL_PHASE_SCOPE(Search);
+	const double StartTime = FPlatformTime::Seconds();
+	Pathfinding::PathQuery Query;
+	Query.Start = GetShipCell(Ship);
+	Query.Goal = Ship->GoalNode;
+	Query.Options = Options;
+	const bool bFound = Planner.Replan(Ship->ShipId, Query, RepairedPath);
+	PlannedPath.swap(RepairedPath.Path);
+	SearchTime += FPlatformTime::Seconds() - StartTime;
+
+	SearchCount += RepairedPath.Expansions;
+	Ship->CellsSearched += RepairedPath.Expansions;
+	return bFound;
+}
+
+/*
+ * Input:
+ *			The ship that needs a path, it is planned from the cell it stands on to its goal
+ *			Options passed on to the goal field (cell to avoid and whether occupied cells are avoided)
+ * Description:
+ *			Same as SearchPath, but the path follows the cost field of the ship's goal, which is built on the first
+ *			request and shared with every later one. Only a path that runs into an avoided cell is searched, around it
+ *			Return true if the goal has been reached
+ */
+bool ALevelGenerator::FollowGoalField(AShip* Ship, const Pathfinding::SearchOptions& Options)
+{
+	LEVEL_PHASE_SCOPE(Search);
+	const double StartTime = FPlatformTime::Seconds();
+	const bool bFound = GoalFields.FindPath(GetShipCell(Ship), Ship->GoalNode, PlannedPath, Options);
+	SearchTime += FPlatformTime::Seconds() - StartTime;
+
+	SearchCount += GoalFields.GetLastExpansions();
+	Ship->CellsSearched += GoalFields.GetLastExpansions();
+	return bFound;
+}
+
+void ALevelGenerator::Replan(AShip* Ship)
+{
+	if(CollisionAndReplanning)
+	{
+		LEVEL_PHASE_SCOPE(Replan);
+		//This is the node that this ship potentially going to crash
+		Pathfinding::SearchOptions Options;
+		Options.AvoidCell = Ship->Path.Num() > 0 ? Ship->Path[0] : Pathfinding::NoCell;
+		Options.bAvoidOccupied = true;
+		//Clear the path of the current ship, prepare for the replan the path
+		Ship->Path.Clear();
+		//Same search as the calculate path function, but the potential crash node and the nodes that contain an object are never entered
+		//Goals that the other ships wall off are rejected by the planner's component check before any search runs
+		//With shared goal fields the ship's field is reused and only searched around the blocked cells
+		const bool bFound = SharedGoalFields ? FollowGoalField(Ship, Options) : RepairPath(Ship, Options);
+		if (!bFound)
+		{
+			//The other ships can wall the goal off, in that case search once more and only avoid the potential crash node
+			Options.bAvoidOccupied = false;
+			if (!SearchPath(Ship, Options))
 			{
-				//GetNeighbours function take the input of a GridNode and send all the neighbours of it into the open list
-				//Also I used this function to add the parents just after add them into open list as well as calculate g,h,f value and assign them into the variables in GridNode Class
-				GetNeighbours(CurrentNode, GoalLocation);
+				//The crash node itself is the only way through, keep going and take the risk
+				SearchPath(Ship);
 			}
-			//Add the search count
-			SearchCount++;
 		}
-		//Clear the list because of both lists are the global variable. We need clear it before get into the next ship
-		OpenList.Empty();
-		CloseList.Empty();
+		//render the new Path
 		RenderPath(Ship);
 	}
 }
+
 /*
- * Input:
- *			A GridNode that we want to search the neighbours of it
- *			A GridNode of goal location
  * Description:
- *			This function will store all the neighbours of the node that we provide into the OpenList and set the parent to the current node
- *			Also it will assign the f,g,h value into the that node
+ *			Cooperative counterpart of CalculatePath. Builds the cost to every ship's goal, plans the first window of
+ *			every ship around the others and starts the step clock that AdvanceLockstep runs on
  */
-void ALevelGenerator::GetNeighbours(GridNode* CurrNode, GridNode* TargetLocation)
-{
-	int X = CurrNode->X;
-	int Y = CurrNode->Y;
-	//check to see is it exceeded map size
-	//Is it has been expended (in the close list
-	//And because the land will cost 100 when our ship is travelled therefore I dont want my ship goes on the ground in any situation (cost < 100)
-	//Node of X+1
-	if (X + 1 < MapSizeX && !CloseList.Contains(WorldArray[Y][X+1]) && WorldArray[Y][X+1]->GetTravelCost() < 100)
-	{
-		GridNode* Neighbour = WorldArray[Y][X+1];
-		OpenList.Add(Neighbour);
-		Neighbour->Parent = CurrNode;
-		if (Neighbour->Parent)
-		{
-			Neighbour->G = Neighbour->Parent->G + Neighbour->GetTravelCost();
-			//GetDistance function is used to get the distance between this neighbour and the goal location by applied Manhattan Distance
-			Neighbour->H = GetDistance(Neighbour,TargetLocation);
+void ALevelGenerator::CalculateCooperativePaths()
+{
+	BeginLockstep();
+	const double StartTime = FPlatformTime::Seconds();
+	std::vector<int32_t> GoalCells(Ships.Num());
+	for (int i = 0; i < Ships.Num(); i++)
+	{
+		GoalCells[i] = Ships[i]->GoalNode;
+	}
+	Cooperative.SetWindow(CooperativeWindow);
+	Cooperative.ResetStats();
+	Cooperative.Begin(GoalCells);
+	SearchTime += FPlatformTime::Seconds() - StartTime;
+
+	PlanCooperativeWindows();
+	RenderLockstepPaths();
+	StartLockstepMoves();
+}
+
+/*
+ * Description:
+ *			Solve the whole level with conflict-based search, the ships then follow the paths in lockstep without
+ *			ever meeting. Return false when no plan was found within ConflictBudget, CalculatePath then plans the
+ *			ships on their own as usual
+ */
+bool ALevelGenerator::CalculateConflictFreePaths()
+{
+	std::vector<int32_t> StartCells(Ships.Num());
+	std::vector<int32_t> GoalCells(Ships.Num());
+	for (int i = 0; i < Ships.Num(); i++)
+	{
+		StartCells[i] = GetShipCell(Ships[i]);
+		GoalCells[i] = Ships[i]->GoalNode;
+	}
+
+	ConflictSolver.SetSuboptimality(ConflictSuboptimality);
+	ConflictSolver.SetBudget(ConflictBudget, 20000);
+	const bool bSolved = ConflictSolver.Solve(StartCells, GoalCells, CooperativePaths);
+	const Pathfinding::ConflictSearchStats& Stats = ConflictSolver.GetStats();
+	SearchTime += Stats.Milliseconds / 1000.0;
+	SearchCount += Stats.LowLevelExpansions;
+	if(!bSolved)
+	{
+		UE_LOG(Heuristics, Warning, TEXT("Conflict-based search found no plan in %.3f ms (%lld nodes), planning the ships on their own"), Stats.Milliseconds, Stats.HighLevelNodes);
+		return false;
+	}
+
+	bConflictSolved = true;
+	BeginLockstep();
+	RenderLockstepPaths();
+	StartLockstepMoves();
+	return true;
+}
+
+//Every ship starts on its cell at step 0 of the step clock
+void ALevelGenerator::BeginLockstep()
+{
+	bLockstep = true;
+	LockstepTime = 0;
+	StepProgress = 0;
+	LockstepPositions.resize(Ships.Num());
+	for (int i = 0; i < Ships.Num(); i++)
+	{
+		LockstepPositions[i] = GetShipCell(Ships[i]);
+		Ships[i]->LastNode = LockstepPositions[i];
+	}
+}
+
+//Hand the plans in CooperativePaths to the ships and show them
+void ALevelGenerator::RenderLockstepPaths()
+{
+	for (int i = 0; i < Ships.Num(); i++)
+	{
+		PlannedPath = CooperativePaths[i];
+		RenderPath(Ships[i]);
+	}
+}
+
+//Plan the next window of every ship from where it stands, the paths replace what is left of the old ones
+void ALevelGenerator::PlanCooperativeWindows()
+{
+	const double StartTime = FPlatformTime::Seconds();
+	const int64 Expansions = Cooperative.GetStats().Expansions;
+	Cooperative.PlanWindows(LockstepTime, LockstepPositions, CooperativePaths);
+	SearchTime += FPlatformTime::Seconds() - StartTime;
+	SearchCount += Cooperative.GetStats().Expansions - Expansions;
+
+	//The path actors still show the first plan, only the ships follow the new windows
+	for (int i = 0; i < Ships.Num(); i++)
+	{
+		Ships[i]->Path.Assign(CooperativePaths[i]);
+	}
+}
+
+/*
+ * Description:
+ *			Every ship starts the move to the next cell of its plan, or waits. The occupancy marks the cell each ship
+ *			is moving into. Two ships entering the same cell or swapping cells crash, which the reservations rule out,
+ *			so any crash counted here is a bug in the plans
+ */
+void ALevelGenerator::StartLockstepMoves()
+{
+	LockstepNext.resize(Ships.Num());
+	for (int i = 0; i < Ships.Num(); i++)
+	{
+		LockstepNext[i] = Ships[i]->Path.Num() > 0 ? Ships[i]->Path[0] : LockstepPositions[i];
+	}
+
+	//The occupancy still holds the cell every ship stands on
+	for (int i = 0; i < Ships.Num(); i++)
+	{
+		const int32 Other = Occupancy.GetHolder(LockstepNext[i]);
+		if(Other > i && LockstepNext[Other] == LockstepPositions[i] && LockstepNext[i] != LockstepPositions[i])
+		{
+			UE_LOG(Collisions, Warning, TEXT("Ship %s CRASHED WITH Ship %s!"), *Ships[i]->GetName(), *Ships[Other]->GetName());
+			CrashPenalty += 50;
 		}
-		Neighbour->F = Neighbour->G + Neighbour->H;
 	}
-	//Node of X-1
-	if (X - 1 >= 0 && !CloseList.Contains(WorldArray[Y][X-1]) && WorldArray[Y][X-1]->GetTravelCost() < 100)
+	//Steps are whole moves, so every ship simply holds the cell it moves into for the step and no time windows are needed
+	for (int i = 0; i < Ships.Num(); i++)
+	{
+		RemoveShip(Ships[i]);
+	}
+	for (int i = 0; i < Ships.Num(); i++)
 	{
-		GridNode* Neighbour = WorldArray[Y][X-1];
-		OpenList.Add(Neighbour);
-		Neighbour->Parent = CurrNode;
-		if (Neighbour->Parent)
+		const int32 Other = Occupancy.GetHolder(LockstepNext[i]);
+		if(Other != Pathfinding::NoShip)
 		{
-			Neighbour->G = Neighbour->Parent->G + Neighbour->GetTravelCost();
-			Neighbour->H = GetDistance(Neighbour,TargetLocation);
+			UE_LOG(Collisions, Warning, TEXT("Ship %s CRASHED WITH Ship %s!"), *Ships[i]->GetName(), *Ships[Other]->GetName());
+			CrashPenalty += 50;
 		}
-		Neighbour->F = Neighbour->G + Neighbour->H;
+		PlaceShip(Ships[i], LockstepNext[i]);
 	}
-	//Node of Y+1
-	if (Y + 1 < MapSizeY && !CloseList.Contains(WorldArray[Y+1][X]) && WorldArray[Y+1][X]->GetTravelCost() < 100)
+}
+
+//Called by Tick each time the step clock completes a step, every ship arrives in the cell it was moving to
+void ALevelGenerator::AdvanceLockstep()
+{
+	for (int i = 0; i < Ships.Num(); i++)
 	{
-		GridNode* Neighbour = WorldArray[Y+1][X];
-		OpenList.Add(Neighbour);
-		Neighbour->Parent = CurrNode;
-		if (Neighbour->Parent)
+		AShip* Ship = Ships[i];
+		if(Ship->Path.Num() > 0)
 		{
-			Neighbour->G = Neighbour->Parent->G + Neighbour->GetTravelCost();
-			Neighbour->H = GetDistance(Neighbour,TargetLocation);
+			const int32 Cell = Ship->Path[0];
+			if(Cell != LockstepPositions[i])
+			{
+				if(Ship->FirstMove)
+				{
+					Ship->FirstMove = false;
+				}
+				else
+				{
+					PathCostTaken.Add(Grid.GetTravelCost(Cell));
+				}
+			}
+			LockstepPositions[i] = Cell;
+			Ship->LastNode = Cell;
+			Fleet.SetPosition(i, Grid.GetX(Cell) * GRID_SIZE_WORLD, Grid.GetY(Cell) * GRID_SIZE_WORLD);
+			Ship->Path.PopFront();
+		}
+		if(LockstepPositions[i] == Ship->GoalNode)
+		{
+			MarkShipAtGoal(Ship);
 		}
-		Neighbour->F = Neighbour->G + Neighbour->H;
 	}
-	//Node of Y-1
-	if (Y - 1 >= 0 && !CloseList.Contains(WorldArray[Y-1][X]) && WorldArray[Y-1][X]->GetTravelCost() < 100)
+	if(Fleet.AllAtGoal())
+	{
+		return;
+	}
+
+	LockstepTime++;
+	//Conflict-based plans cover the whole level, only the cooperative windows run out
+	if(CooperativePlanning && LockstepTime % Cooperative.GetReplanInterval() == 0)
+	{
+		PlanCooperativeWindows();
+	}
+	StartLockstepMoves();
+}
+
+/*
+ * Input:
+ *			Seconds since the last frame
+ * Description:
+ *			Move every ship of a real time level. Ships standing in a cell with a path left set off for the next cell
+ *			first, then the fleet moves all of them in one loop and the ships that got there arrive, in ship order
+ */
+void ALevelGenerator::SimulateShips(float DeltaTime)
+{
+	for(int i = 0; i < Ships.Num(); i++)
 	{
-		GridNode* Neighbour = WorldArray[Y-1][X];
-		OpenList.Add(Neighbour);
-		Neighbour->Parent = CurrNode;
-		if (Neighbour->Parent)
+		if(!Fleet.IsMoving(i) && Ships[i]->Path.Num() > 0)
 		{
-			Neighbour->G = Neighbour->Parent->G + Neighbour->GetTravelCost();
-			Neighbour->H = GetDistance(Neighbour,TargetLocation);
+			SetOffShip(Ships[i]);
 		}
-		Neighbour->F = Neighbour->G + Neighbour->H;
+	}
+	Fleet.Advance(DeltaTime);
+	for(const int32_t i : Fleet.GetArrivals())
+	{
+		ArriveShip(Ships[i]);
 	}
 }
 
-//Return the distance between two nodes by using the Manhattan distance
-float ALevelGenerator::GetDistance(GridNode* CurrNode, GridNode* GoalLocation)
+//The ship claims its next cell, or replans when another ship is in the way, and heads for it
+void ALevelGenerator::SetOffShip(AShip* Ship)
 {
-	const int EndX = GoalLocation->X;
-	const int EndY = GoalLocation->Y;
-	const int StartX = CurrNode->X;
-	const int StartY = CurrNode->Y;
-	//Get the distance between currNode and the goal location, use Manhattan Distance.
-	//Used WA* which has weight of 2
-	return 2 * (abs(EndX - StartX) + abs(EndY - StartY));
+	//The ship crosses into the next cell halfway there and holds the cell it leaves until it arrives
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float CrossTime = Now + 0.5f * GRID_SIZE_WORLD / Ship->MoveSpeed;
+	int32 Other = Occupancy.FindConflict(Ship->ShipId, Ship->Path[0], CrossTime);
+	if(Ships.IsValidIndex(Other))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Ship %s has a potential crash with Ship %s!"), *Ship->GetName(), *Ships[Other]->GetName());
+		//Replan falls back to the plain path itself, so one call is enough
+		Replan(Ship);
+		if(Ship->Path.Num() == 0)
+		{
+			//The goal is cut off by the terrain, there is nothing left to move to
+			return;
+		}
+		Other = Occupancy.FindConflict(Ship->ShipId, Ship->Path[0], CrossTime);
+	}
+	//Only a ship that found no way around is still on course for the other one, it crashes once it gets there
+	Ship->PotentialCrash = Ships.IsValidIndex(Other) ? Ships[Other] : nullptr;
+	BeginShipMove(Ship, Ship->Path[0], Now + GRID_SIZE_WORLD / Ship->MoveSpeed);
+	Fleet.SetTarget(Ship->ShipId, Grid.GetX(Ship->Path[0]) * GRID_SIZE_WORLD, Grid.GetY(Ship->Path[0]) * GRID_SIZE_WORLD);
 }
 
-//Loop through all the nodes inside of OpenList and return the node that has the lowest f value
-GridNode* ALevelGenerator::FindMinNode()
+//The fleet has put the ship on its next cell: count a crash it was on course for, the cost of the cell and the goal
+void ALevelGenerator::ArriveShip(AShip* Ship)
 {
-	GridNode* CurrMinNode = nullptr;
-	if (!OpenList.IsEmpty())
+	if(Ship->PotentialCrash)
 	{
-		//Initialzie MinF as Infinity which means every f value will lower than this, this can make sure we assign the useful f value later
-		float MinF = INFINITY;
-		for(auto Node: OpenList)
+		UE_LOG(Collisions, Warning, TEXT("Ship %s CRASHED WITH Ship %s!"), *Ship->GetName(), *Ship->PotentialCrash->GetName());
+		CrashPenalty += 50;
+		//Two ships meeting head on are both on course for each other, the crash counts once
+		AShip* Other = Ship->PotentialCrash;
+		if(Other->PotentialCrash == Ship && Other->Path.Num() > 0 && Other->Path[0] == Ship->LastNode)
 		{
-			if (Node->F < MinF)
-				{
-					MinF = Node->F;
-					CurrMinNode = Node;
-				}
-			
+			Other->PotentialCrash = nullptr;
 		}
+		Ship->PotentialCrash = nullptr;
 	}
-	return  CurrMinNode;
 
-}
+	if(Ship->Path[0] == Ship->GoalNode)
+	{
+		MarkShipAtGoal(Ship);
+	}
+	//The ship now holds only the cell it arrived in, and keeps holding it parked on its goal
+	EndShipMove(Ship);
 
+	if(Ship->FirstMove)
+	{
+		Ship->FirstMove = false;
+	}
+	else
+	{
+		PathCostTaken.Add(Grid.GetTravelCost(Ship->Path[0]));
+	}
+	Ship->LastNode = Ship->Path[0];
+	Ship->Path.PopFront();
+}
 
-void ALevelGenerator::Replan(AShip* Ship)
+//Between two lockstep steps every moving ship is StepProgress of the way from its last cell to the next
+void ALevelGenerator::GlideLockstepShips()
 {
-	if(CollisionAndReplanning)
+	for(int i = 0; i < Ships.Num(); i++)
 	{
-		//INSERT REPLANNING HERE
-		//Reset All Nodes in the current level
-		ResetAllNodes();
-		//Clear the Open and Close list, prepare for the replan (make sure they are empty)
-		OpenList.Empty();
-		CloseList.Empty();
-		//Get the Node of start and end
-		GridNode* GoalLocation = Ship->GoalNode;
-		const int StartLocationX = Ship->GetActorLocation().X/GRID_SIZE_WORLD;
-		const int StartLocationY = Ship->GetActorLocation().Y/GRID_SIZE_WORLD;
-		GridNode* StartNode = WorldArray[StartLocationY][StartLocationX];
-		//This is the node that this ship potentially going to crash
-		GridNode* Crash = Ship->Path[0];
-		//Clear the path of the current ship, prepare for the replan the path
-		Ship->Path.Empty();
-		//Start search with StartNode
-		OpenList.Add(StartNode);
-		//Main Loop, very similar to the calculate path function
-		while (!OpenList.IsEmpty())
-		{
-			GridNode* CurrentNode = FindMinNode();
-			CloseList.Add(CurrentNode);
-			OpenList.Remove(CurrentNode);
-			if (CurrentNode == GoalLocation)
-			{
-				break;
-			}
-			if (CurrentNode)
-			{
-				GetNeighbours(CurrentNode, GoalLocation);
-			}
-			//Creat RemoveNode variable to store the node that I want to remove.
-			//I'm doing this because UE does not allow me to change the open list during the following for loop
-			//So I need to remove this node from open list outside of the loop
-			//Initialize it with nullptr
-			GridNode* RemoveNode = nullptr;
-			if (!OpenList.IsEmpty())
-			{
-				//Loop through all the neighbours that we added before. And sure it remove the node that contains an object or it is our potential crash node
-				for (auto Neighbour:OpenList)
-				{
-					if (Neighbour == Crash || Neighbour->ObjectAtLocation)
-					{
-						Neighbour->Parent = nullptr;
-						RemoveNode = Neighbour;
-					}
-				}
-				if (RemoveNode)
-				{
-					OpenList.Remove(RemoveNode);
-				}
-			}
-			//Increase the SearchCount
-			SearchCount++;
+		const AShip* Ship = Ships[i];
+		if(Ship->Path.Num() > 0 && Ship->Path[0] != Ship->LastNode)
+		{
+			const float FromX = Grid.GetX(Ship->LastNode) * GRID_SIZE_WORLD;
+			const float FromY = Grid.GetY(Ship->LastNode) * GRID_SIZE_WORLD;
+			const float ToX = Grid.GetX(Ship->Path[0]) * GRID_SIZE_WORLD;
+			const float ToY = Grid.GetY(Ship->Path[0]) * GRID_SIZE_WORLD;
+			//Lockstep moves are one cell along an axis, the heading is the sign of the move
+			Fleet.SetPosition(i, FMath::Lerp(FromX, ToX, StepProgress), FMath::Lerp(FromY, ToY, StepProgress));
+			Fleet.SetHeading(i, FMath::Sign(ToX - FromX), FMath::Sign(ToY - FromY));
 		}
-		//Clear both list and prepare for the next search
-		OpenList.Empty();
-		CloseList.Empty();
-		//render the new Path
-		RenderPath(Ship);
 	}
 }
 
+//Hand the fleet's positions and headings to the ship actors, only for the ships that moved since the last frame.
+//A ship only turns when it sets off somewhere new, every other frame it just needs its location
+void ALevelGenerator::PushShipTransforms()
+{
+	Fleet.CollectChanged(MovedShips, TurnedShips);
+	for(const int32_t i : MovedShips)
+	{
+		Ships[i]->SetActorLocation(FVector(Fleet.GetX(i), Fleet.GetY(i), Fleet.GetZ(i)));
+	}
+	for(const int32_t i : TurnedShips)
+	{
+		const FRotator Rotation = FVector(Fleet.GetDirX(i), Fleet.GetDirY(i), 0).Rotation();
+		Ships[i]->SetActorLocationAndRotation(FVector(Fleet.GetX(i), Fleet.GetY(i), Fleet.GetZ(i)), Rotation);
+	}
+}
 
+void ALevelGenerator::MarkShipAtGoal(AShip* Ship)
+{
+	if(!Fleet.IsAtGoal(Ship->ShipId))
+	{
+		Fleet.MarkAtGoal(Ship->ShipId);
+		Ship->MarkAtGoal();
+	}
+}
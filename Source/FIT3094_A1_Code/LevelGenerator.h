@@ -3,7 +3,17 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "GridNode.h"
+#include "Pathfinding/GridMap.h"
+#include "Pathfinding/BatchPlanner.h"
+#include "Pathfinding/ConflictSearch.h"
+#include "Pathfinding/CooperativePlanner.h"
+#include "Pathfinding/GoalFieldCache.h"
+#include "Pathfinding/MapLoader.h"
+#include "Pathfinding/OccupancyGrid.h"
+#include "Pathfinding/PathMarkerBuffer.h"
+#include "Pathfinding/ShipFleet.h"
+#include "Pathfinding/ShipSimulation.h"
+#include "Pathfinding/StatsCollector.h"
 #include "Ship.h"
 #include "GameFramework/Actor.h"
 #include "LevelGenerator.generated.h"
@@ -12,6 +22,10 @@ DECLARE_LOG_CATEGORY_EXTERN(IndividualShips, Warning, All);
 DECLARE_LOG_CATEGORY_EXTERN(Heuristics, Warning, All);
 DECLARE_LOG_CATEGORY_EXTERN(Collisions, Warning, All);
 
+class UHierarchicalInstancedStaticMeshComponent;
+class UMaterialInterface;
+class UStaticMesh;
+
 UCLASS()
 class FIT3094_A1_CODE_API ALevelGenerator : public AActor
 {
@@ -30,7 +44,6 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
-	static const int MAX_MAP_SIZE = 200;
 	static const int GRID_SIZE_WORLD = 100;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
@@ -58,19 +71,142 @@ public:
 		bool CollisionAndReplanning;
 	UPROPERTY(EditAnywhere, Category = "Debugging")
 		bool IndividualStats = false;
+	//Before play starts, run every level of the ladder through a step clock simulation of the ships, crashes and
+	//replans (Pathfinding::ShipSimulation) and log its costs. Unlike DetailActual they never depend on the frame rate
+	UPROPERTY(EditAnywhere, Category = "Debugging")
+		bool HeadlessReplay = false;
+	//Order the replay updates the ships in, 0 is ship order like the game
+	UPROPERTY(EditAnywhere, Category = "Debugging")
+		int ReplaySeed = 0;
+	//Time the phases of every level (map load, spawning, plans, searches, replans, path markers) and write them with
+	//the planner's counters to Saved/PathfindingStats.json after each level. The phases are CPU trace scopes either way
+	UPROPERTY(EditAnywhere, Category = "Debugging")
+		bool CollectStats = false;
+	//Plan the ships of a level concurrently, each worker has its own search context
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		bool ParallelPlanning = true;
+	//Number of search contexts when planning in parallel, 0 uses one per task graph worker plus the game thread
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		int PlanningThreads = 0;
+	//Use jump point search instead of plain weighted A*, finds paths of the same cost with fewer expansions
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		bool JumpPointSearch = false;
+	//Plan long paths over precomputed sector entrances (HPA*), faster but paths can cost a little more. Overrides JumpPointSearch
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		bool HierarchicalPlanning = false;
+	//Width and height of a sector in cells for HierarchicalPlanning
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		int SectorSize = 16;
+	//Landmarks for the ALT heuristic, precomputed per map. With any landmarks the search is plain A* and finds optimal paths,
+	//with 0 it falls back to 2 * Manhattan distance
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		int LandmarkCount = 8;
+	//Pick landmarks at random instead of spreading them as far apart as possible
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		bool RandomLandmarks = false;
+	//Memory for paths already found, a query for the same start and goal (or one on the way of a kept optimal path)
+	//is answered without a search. 0 turns the cache off
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		int PathCacheKB = 1024;
+	//Keep each ship's search between replans (D* Lite) and only repair what the moved ships changed
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		bool IncrementalReplanning = true;
+	//Plan and replan each ship by following the cost field of its goal (a reverse Dijkstra kept per goal) instead of
+	//searching. Building a field costs more than one search, it pays off when ships share a goal or replan towards it
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		bool SharedGoalFields = false;
+	//Goal fields kept at once, the least recently used one is dropped. Shared with the multi ship planners below
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		int GoalFieldCapacity = 64;
+	//Plan all ships together in space and time (windowed cooperative A*) so they never crash. The ships then move in
+	//lockstep, one cell or a wait per step, and every plan looks CooperativeWindow steps ahead. Overrides the modes above
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		bool CooperativePlanning = false;
+	//Steps each cooperative plan reserves, the plans are made again after half of them. Below 16 ships can get boxed in
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		int CooperativeWindow = 32;
+	//Solve each level for all ships at once with bounded suboptimal conflict-based search (ECBS), the ships then move in
+	//lockstep like with CooperativePlanning. Falls back to the modes above when no plan is found within ConflictBudget
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		bool ConflictBasedPlanning = false;
+	//The sum of path costs may be at most this many times the optimum, 1 is optimal but only solves small levels
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		float ConflictSuboptimality = 1.2f;
+	//Milliseconds conflict-based search may take per level before falling back
+	UPROPERTY(EditAnywhere, Category = "Planning")
+		float ConflictBudget = 1000.f;
+
+	//With a CellMesh the terrain is drawn as one instanced mesh per terrain type instead of an actor per cell, without
+	//one the Deep, Shallow and Land blueprints are spawned like before
+	UPROPERTY(EditAnywhere, Category = "Rendering")
+		UStaticMesh* CellMesh = nullptr;
+	UPROPERTY(EditAnywhere, Category = "Rendering")
+		UMaterialInterface* DeepMaterial = nullptr;
+	UPROPERTY(EditAnywhere, Category = "Rendering")
+		UMaterialInterface* ShallowMaterial = nullptr;
+	UPROPERTY(EditAnywhere, Category = "Rendering")
+		UMaterialInterface* LandMaterial = nullptr;
+	UPROPERTY(EditAnywhere, Category = "Rendering")
+		FVector CellScale = FVector(1, 1, 1);
+	//Same for the path markers, their instances are moved in place when the paths change instead of respawned
+	UPROPERTY(EditAnywhere, Category = "Rendering")
+		UStaticMesh* PathMarkerMesh = nullptr;
+	UPROPERTY(EditAnywhere, Category = "Rendering")
+		UMaterialInterface* PathMarkerMaterial = nullptr;
+	UPROPERTY(EditAnywhere, Category = "Rendering")
+		FVector PathMarkerScale = FVector(1, 1, 1);
 
 	bool CameraRotated = false;
 
-	GridNode* WorldArray[MAX_MAP_SIZE][MAX_MAP_SIZE];
+	//Terrain and the cells the ships hold, the planners below only read them
+	Pathfinding::GridMap Grid;
+	Pathfinding::OccupancyGrid Occupancy;
+	Pathfinding::BatchPlanner Planner;
+	//Result of the last search, RenderPath turns it into the ship's path
+	std::vector<int32_t> PlannedPath;
+	//Scratch result of SearchPath and RepairPath, its path is swapped into PlannedPath
+	Pathfinding::PathResult RepairedPath;
+	Pathfinding::GoalFieldCache GoalFields;
+	Pathfinding::CooperativePlanner Cooperative;
+	Pathfinding::ConflictSearch ConflictSolver;
+	//Lockstep mode, set when the level was planned by one of the two above: where each ship stands on the step clock,
+	//the plans and how far into the next step they are
+	bool bLockstep = false;
+	bool bConflictSolved = false;
+	std::vector<int32_t> LockstepPositions;
+	std::vector<int32_t> LockstepNext;
+	std::vector<std::vector<int32_t>> CooperativePaths;
+	int32 LockstepTime = 0;
+	float StepProgress = 0;
+	//Where each ship is and where it heads, indexed by ShipId. Tick moves them all and pushes the transforms of the
+	//ships that moved or turned, the ships on their goal are counted as they get there
+	Pathfinding::ShipFleet Fleet;
+	std::vector<int32_t> MovedShips;
+	std::vector<int32_t> TurnedShips;
+	std::vector<Pathfinding::PathQuery> ShipQueries;
+	std::vector<Pathfinding::PathResult> ShipResults;
 	TArray<AActor*> PathDisplayActors;
 	TArray<AActor*> Terrain;
+	UPROPERTY()
+		TArray<UHierarchicalInstancedStaticMeshComponent*> TerrainInstances;
+	UPROPERTY()
+		UHierarchicalInstancedStaticMeshComponent* PathMarkerInstances = nullptr;
+	//Cells of the path markers of the current plans, FlushPathMarkers writes them into the instances once per frame
+	Pathfinding::PathMarkerBuffer PathMarkers;
+	TArray<FTransform> PathMarkerScratch;
+	//Wall time spent spawning, moving and destroying path markers, in seconds
+	double MarkerTime = 0;
 	TArray<FVector2d> ShipSpawns;
 	TArray<FVector2d> GoldSpawns;
 	TArray<AShip*> Ships;
 
 	TArray<int> PathCostTaken;
 	int SearchCount = 0;
+	//Wall time spent inside the search loops of CalculatePath and Replan, in seconds
+	double SearchTime = 0;
 	int CrashPenalty = 0;
+	//One scenario for the map, then one per level, only filled while CollectStats is on
+	Pathfinding::StatsCollector Metrics;
 
 	int ScenarioIndex = 0;
 	int TotalIndex = 200;
@@ -80,29 +216,53 @@ public:
 	
 	
 
-	void SpawnWorldActors(TArray<TArray<char>> Grid);
-	void GenerateNodeGrid(TArray<TArray<char>> Grid);
+	void SpawnWorldActors();
+	void ConfigurePlanner(Pathfinding::BatchPlanner& Target) const;
+	void GenerateNodeGrid(Pathfinding::ConnectedComponents* CookedComponents = nullptr, Pathfinding::LandmarkTable* CookedLandmarks = nullptr);
 	void ResetAllNodes();
-	float CalculateDistanceBetween(GridNode* First, GridNode* Second);
-	void GenerateWorldFromFile(TArray<FString> WorldArrayStrings);
-	void GenerateScenarioFromFile(TArray<FString> ScenarioArrayStrings);
+	float CalculateDistanceBetween(int First, int Second);
+	void GenerateWorldFromFile(const TArray<uint8>& MapFileBytes);
+	void GenerateWorldFromCookedMap(const TArray<uint8>& CookedMapBytes);
+	void GenerateScenarioFromFile(const TArray<uint8>& ScenarioFileBytes);
 	void InitialisePaths();
 	void RenderPath(AShip* Ship);
 	void ResetPath();
+	UHierarchicalInstancedStaticMeshComponent* CreateInstances(UStaticMesh* Mesh, UMaterialInterface* Material);
+	void FlushPathMarkers();
 	void DetailPlan();
 	void DetailActual();
+	void ReplayScenarios();
 	void NextLevel();
+	void SpawnShips();
+	void ExportStats();
 	void DestroyAllActors();
 	
 	void CalculatePath();
 	void Replan(AShip* Ship);
+	void CalculateCooperativePaths();
+	bool CalculateConflictFreePaths();
+	void BeginLockstep();
+	void RenderLockstepPaths();
+	void PlanCooperativeWindows();
+	void StartLockstepMoves();
+	void AdvanceLockstep();
+	void SimulateShips(float DeltaTime);
+	void SetOffShip(AShip* Ship);
+	void ArriveShip(AShip* Ship);
+	void GlideLockstepShips();
+	void PushShipTransforms();
+	void MarkShipAtGoal(AShip* Ship);
 
 	//Addational Function
-	void GetNeighbours(GridNode* CurrNode, GridNode* TargetLocation);
-	float GetDistance(GridNode* CurrNode, GridNode* GoalLocation);
-	TArray<GridNode*> OpenList;
-	TArray<GridNode*> CloseList;
-	GridNode* FindMinNode();
+	bool SearchPath(AShip* Ship, const Pathfinding::SearchOptions& Options = Pathfinding::SearchOptions());
+	bool RepairPath(AShip* Ship, const Pathfinding::SearchOptions& Options);
+	bool FollowGoalField(AShip* Ship, const Pathfinding::SearchOptions& Options = Pathfinding::SearchOptions());
+	int GetShipCell(const AShip* Ship) const;
+	//Every occupancy change goes through these so the planner's free water components stay up to date
+	void BeginShipMove(AShip* Ship, int32 To, float LeaveTime);
+	void EndShipMove(AShip* Ship);
+	void PlaceShip(AShip* Ship, int32 Cell);
+	void RemoveShip(AShip* Ship);
 	
 	
 
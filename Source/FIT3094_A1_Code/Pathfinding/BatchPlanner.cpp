@@ -0,0 +1,436 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BatchPlanner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <thread>
+
+namespace Pathfinding
+{
+	void BatchPlanner::SetGrid(const GridMap* InGrid)
+	{
+		Grid = InGrid;
+		for(std::unique_ptr<PathPlanner>& Context : Contexts)
+		{
+			Context->SetGrid(Grid);
+		}
+		Paths.SetGrid(Grid);
+		UpdateSearchData();
+		UpdateComponents();
+		UpdateLandmarks();
+	}
+
+	void BatchPlanner::SetGrid(const GridMap* InGrid, ConnectedComponents&& CookedComponents, LandmarkTable&& CookedLandmarks)
+	{
+		Grid = InGrid;
+		for(std::unique_ptr<PathPlanner>& Context : Contexts)
+		{
+			Context->SetGrid(Grid);
+		}
+		Paths.SetGrid(Grid);
+		UpdateSearchData();
+
+		//Every context already points at these, so moving the data in is enough
+		if(Grid && CookedComponents.GetGrid() == Grid)
+		{
+			Components = std::move(CookedComponents);
+			OnOccupancyCleared();
+			ResetReplanSlots();
+		}
+		else
+		{
+			UpdateComponents();
+		}
+		if(Grid && CookedLandmarks.GetGrid() == Grid)
+		{
+			Landmarks = std::move(CookedLandmarks);
+		}
+		else
+		{
+			UpdateLandmarks();
+		}
+	}
+
+	void BatchPlanner::SetWorkerCount(int Count)
+	{
+		Count = Count < 1 ? 1 : Count;
+		while(static_cast<int>(Contexts.size()) > Count)
+		{
+			Contexts.pop_back();
+		}
+		while(static_cast<int>(Contexts.size()) < Count)
+		{
+			Contexts.push_back(std::make_unique<PathPlanner>());
+			Contexts.back()->SetGrid(Grid);
+			Contexts.back()->SetHeuristicWeight(HeuristicWeight);
+			Contexts.back()->SetSearchMode(Mode);
+			Contexts.back()->SetJumpTable(&Jumps);
+			Contexts.back()->SetSectorGraph(&Sectors);
+			Contexts.back()->SetLandmarks(&Landmarks);
+			Contexts.back()->SetComponents(&Components, &FreeWater);
+			Contexts.back()->SetOccupancy(Occupancy);
+		}
+	}
+
+	void BatchPlanner::SetHeuristicWeight(int Weight)
+	{
+		HeuristicWeight = Weight;
+		for(std::unique_ptr<PathPlanner>& Context : Contexts)
+		{
+			Context->SetHeuristicWeight(Weight);
+		}
+		UpdatePathCache();
+	}
+
+	void BatchPlanner::SetSearchMode(SearchMode NewMode)
+	{
+		const bool bChanged = Mode != NewMode;
+		Mode = NewMode;
+		for(std::unique_ptr<PathPlanner>& Context : Contexts)
+		{
+			Context->SetSearchMode(NewMode);
+		}
+		if(bChanged)
+		{
+			UpdateSearchData();
+		}
+		UpdatePathCache();
+	}
+
+	void BatchPlanner::SetPathCache(size_t Bytes)
+	{
+		std::lock_guard<std::mutex> Lock(PathsMutex);
+		Paths.SetMemoryLimit(Bytes);
+	}
+
+	void BatchPlanner::SetSectorSize(int Size)
+	{
+		const bool bChanged = SectorSize != Size;
+		SectorSize = Size;
+		if(bChanged && Mode == SearchMode::Hierarchical)
+		{
+			UpdateSearchData();
+		}
+	}
+
+	void BatchPlanner::SetLandmarks(int Count, LandmarkSelection NewSelection)
+	{
+		const bool bChanged = LandmarkCount != Count || Selection != NewSelection;
+		LandmarkCount = Count;
+		Selection = NewSelection;
+		if(bChanged)
+		{
+			UpdateLandmarks();
+		}
+	}
+
+	void BatchPlanner::OnTerrainChanged(int X, int Y)
+	{
+		if(!Grid)
+		{
+			return;
+		}
+		//Opening or closing a cell relabels the components around it
+		Components.OnCellChanged(Grid->ToIndex(X, Y));
+		FreeWater.OnCellChanged(Grid->ToIndex(X, Y));
+		//The kept replanning searches costed the old terrain
+		ResetReplanSlots();
+		//Any cost change can break the stored distances, so the landmarks are always rebuilt
+		UpdateLandmarks();
+		if(Mode == SearchMode::JumpPoint)
+		{
+			//One pass over the map, cheap enough to redo
+			Jumps.Build(*Grid);
+		}
+		else if(Mode == SearchMode::Hierarchical)
+		{
+			Sectors.MarkTerrainChanged(X, Y);
+			Sectors.Update();
+		}
+	}
+
+	void BatchPlanner::SetOccupancy(const OccupancyGrid* InOccupancy)
+	{
+		Occupancy = InOccupancy;
+		for(std::unique_ptr<PathPlanner>& Context : Contexts)
+		{
+			Context->SetOccupancy(Occupancy);
+		}
+		OnOccupancyCleared();
+	}
+
+	void BatchPlanner::OnOccupancyChanged(int32_t Cell)
+	{
+		//Opening or closing a cell that already is is a no-op, so the caller does not need to know which it was
+		if(Grid && Cell != NoCell && FreeWater.GetGrid() == Grid)
+		{
+			FreeWater.OnCellChanged(Cell);
+		}
+	}
+
+	void BatchPlanner::OnOccupancyCleared()
+	{
+		//Without an occupancy FreeWater is the same as the terrain labels
+		if(Grid)
+		{
+			FreeWater.Build(*Grid, Occupancy);
+		}
+	}
+
+	void BatchPlanner::UpdateSearchData()
+	{
+		//SetGrid is called again whenever the terrain was regenerated, so the data is rebuilt there as well
+		if(!Grid)
+		{
+			return;
+		}
+		if(Mode == SearchMode::JumpPoint)
+		{
+			Jumps.Build(*Grid);
+		}
+		else if(Mode == SearchMode::Hierarchical)
+		{
+			Sectors.Build(*Grid, SectorSize);
+		}
+	}
+
+	void BatchPlanner::UpdateComponents()
+	{
+		if(Grid)
+		{
+			Components.Build(*Grid);
+			OnOccupancyCleared();
+		}
+		ResetReplanSlots();
+	}
+
+	void BatchPlanner::ResetReplanSlots()
+	{
+		for(ReplanSlot& Slot : ReplanSlots)
+		{
+			Slot.Agent = NoShip;
+			Slot.Planner->SetGrid(Grid);
+		}
+	}
+
+	void BatchPlanner::UpdatePathCache()
+	{
+		//The tail of a weighted or hierarchical path is not what a search from its start would find
+		Paths.SetSuffixReuse(HeuristicWeight <= 1 && Mode != SearchMode::Hierarchical);
+	}
+
+	void BatchPlanner::UpdateLandmarks()
+	{
+		//Built with a count of 0 the table is just emptied
+		if(Grid)
+		{
+			Landmarks.Build(*Grid, LandmarkCount, Selection);
+		}
+	}
+
+	void BatchPlanner::RunQuery(int Worker, const PathQuery& Query, PathResult& OutResult)
+	{
+		const bool bCacheable = IsCacheable(Query);
+		if(bCacheable)
+		{
+			std::lock_guard<std::mutex> Lock(PathsMutex);
+			if(Paths.Find(Query.Start, Query.Goal, OutResult.Path, OutResult.PathCost))
+			{
+				OutResult.bFound = true;
+				OutResult.Expansions = 0;
+				return;
+			}
+		}
+
+		SearchQuery(Worker, Query, OutResult);
+		if(bCacheable && OutResult.bFound)
+		{
+			std::lock_guard<std::mutex> Lock(PathsMutex);
+			Paths.Store(Query.Start, Query.Goal, OutResult.Path, OutResult.PathCost, OutResult.Expansions);
+		}
+	}
+
+	void BatchPlanner::BeginBatch(const std::vector<PathQuery>& Queries, std::vector<PathResult>& OutResults)
+	{
+		OutResults.resize(Queries.size());
+		PendingQueries.clear();
+		std::lock_guard<std::mutex> Lock(PathsMutex);
+		for(size_t i = 0; i < Queries.size(); i++)
+		{
+			PathResult& Result = OutResults[i];
+			if(IsCacheable(Queries[i]) && Paths.Find(Queries[i].Start, Queries[i].Goal, Result.Path, Result.PathCost))
+			{
+				Result.bFound = true;
+				Result.Expansions = 0;
+			}
+			else
+			{
+				PendingQueries.push_back(static_cast<int32_t>(i));
+			}
+		}
+	}
+
+	void BatchPlanner::SearchQuery(int Worker, const PathQuery& Query, PathResult& OutResult)
+	{
+		PathPlanner& Context = *Contexts[Worker];
+		OutResult.bFound = Context.FindPath(Query.Start, Query.Goal, OutResult.Path, Query.Options);
+		OutResult.PathCost = Context.GetLastPathCost();
+		OutResult.Expansions = Context.GetLastExpansions();
+	}
+
+	void BatchPlanner::EndBatch(const std::vector<PathQuery>& Queries, const std::vector<PathResult>& Results)
+	{
+		std::lock_guard<std::mutex> Lock(PathsMutex);
+		for(const int32_t i : PendingQueries)
+		{
+			if(IsCacheable(Queries[i]) && Results[i].bFound)
+			{
+				Paths.Store(Queries[i].Start, Queries[i].Goal, Results[i].Path, Results[i].PathCost, Results[i].Expansions);
+			}
+		}
+		PendingQueries.clear();
+	}
+
+	bool BatchPlanner::Replan(int32_t Agent, const PathQuery& Query, PathResult& OutResult)
+	{
+		OutResult.bFound = false;
+		OutResult.PathCost = 0;
+		OutResult.Expansions = 0;
+		OutResult.Path.clear();
+		if(!Grid || Query.Start == NoCell || Query.Goal == NoCell)
+		{
+			return false;
+		}
+
+		//Same O(1) component check as PathPlanner, an unreachable goal would drain the whole region of the goal
+		const ConnectedComponents& Labels = Query.Options.bAvoidOccupied ? FreeWater : Components;
+		if(Labels.GetGrid() == Grid && !Labels.CanReach(Query.Start, Query.Goal))
+		{
+			ReplanStats.Unreachable++;
+			return false;
+		}
+
+		ReplanSlot* Slot = nullptr;
+		for(ReplanSlot& Candidate : ReplanSlots)
+		{
+			if(Candidate.Agent == Agent)
+			{
+				Slot = &Candidate;
+				break;
+			}
+		}
+		if(!Slot && static_cast<int>(ReplanSlots.size()) < ReplanSlotCount)
+		{
+			ReplanSlots.emplace_back();
+			Slot = &ReplanSlots.back();
+			Slot->Planner = std::make_unique<IncrementalPlanner>();
+			Slot->Planner->SetGrid(Grid);
+		}
+		if(!Slot)
+		{
+			Slot = &*std::min_element(ReplanSlots.begin(), ReplanSlots.end(), [](const ReplanSlot& A, const ReplanSlot& B) { return A.LastUse < B.LastUse; });
+			//A different agent may share the goal by chance, its search must not be reused
+			Slot->Planner->Reset();
+		}
+		Slot->Agent = Agent;
+		Slot->LastUse = ++ReplanClock;
+		Slot->Planner->SetLandmarks(&Landmarks);
+
+		ReplanBlocked.clear();
+		if(Query.Options.AvoidCell != NoCell)
+		{
+			ReplanBlocked.push_back(Query.Options.AvoidCell);
+		}
+		if(Query.Options.bAvoidOccupied && Occupancy)
+		{
+			//At most two cells per ship, read in one pass over the ships instead of the grid
+			Occupancy->GetHeldCells(HeldCells);
+			ReplanBlocked.insert(ReplanBlocked.end(), HeldCells.begin(), HeldCells.end());
+		}
+
+		OutResult.bFound = Slot->Planner->FindPath(Query.Start, Query.Goal, ReplanBlocked, OutResult.Path);
+		OutResult.PathCost = Slot->Planner->GetLastPathCost();
+		OutResult.Expansions = Slot->Planner->GetLastExpansions();
+		ReplanStats.Searches++;
+		ReplanStats.Expansions += OutResult.Expansions;
+		return OutResult.bFound;
+	}
+
+	void BatchPlanner::SetReplanSlots(int Count)
+	{
+		ReplanSlotCount = Count < 1 ? 1 : Count;
+		if(static_cast<int>(ReplanSlots.size()) > ReplanSlotCount)
+		{
+			ReplanSlots.resize(ReplanSlotCount);
+		}
+	}
+
+	void BatchPlanner::PlanAll(const std::vector<PathQuery>& Queries, std::vector<PathResult>& OutResults)
+	{
+		if(Contexts.empty())
+		{
+			SetWorkerCount(1);
+		}
+
+		BeginBatch(Queries, OutResults);
+		std::atomic<size_t> NextQuery(0);
+		auto Work = [&](int Worker)
+		{
+			for(size_t i = NextQuery++; i < PendingQueries.size(); i = NextQuery++)
+			{
+				SearchQuery(Worker, Queries[PendingQueries[i]], OutResults[PendingQueries[i]]);
+			}
+		};
+
+		//The calling thread works as worker 0, so a single context never starts a thread
+		std::vector<std::thread> Threads;
+		for(int Worker = 1; Worker < GetWorkerCount(); Worker++)
+		{
+			Threads.emplace_back(Work, Worker);
+		}
+		Work(0);
+		for(std::thread& Thread : Threads)
+		{
+			Thread.join();
+		}
+		EndBatch(Queries, OutResults);
+	}
+
+	PlannerStats BatchPlanner::GetStats() const
+	{
+		PlannerStats Total;
+		for(const std::unique_ptr<PathPlanner>& Context : Contexts)
+		{
+			Total.Searches += Context->GetStats().Searches;
+			Total.Expansions += Context->GetStats().Expansions;
+			Total.NodesTouched += Context->GetStats().NodesTouched;
+			Total.Unreachable += Context->GetStats().Unreachable;
+			Total.OpenPeak = std::max(Total.OpenPeak, Context->GetStats().OpenPeak);
+			Total.DecreaseKeys += Context->GetStats().DecreaseKeys;
+			Total.HeuristicEvaluations += Context->GetStats().HeuristicEvaluations;
+		}
+		return Total;
+	}
+
+	int64_t BatchPlanner::GetNodeResetsSkipped() const
+	{
+		int64_t Total = 0;
+		for(const std::unique_ptr<PathPlanner>& Context : Contexts)
+		{
+			Total += Context->GetNodeResetsSkipped();
+		}
+		return Total;
+	}
+
+	void BatchPlanner::ResetStats()
+	{
+		for(std::unique_ptr<PathPlanner>& Context : Contexts)
+		{
+			Context->ResetStats();
+		}
+		ReplanStats = PlannerStats();
+	}
+}
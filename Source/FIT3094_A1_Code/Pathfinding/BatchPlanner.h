@@ -0,0 +1,163 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ConnectedComponents.h"
+#include "GridMap.h"
+#include "IncrementalPlanner.h"
+#include "JumpTable.h"
+#include "LandmarkTable.h"
+#include "OccupancyGrid.h"
+#include "PathCache.h"
+#include "PathPlanner.h"
+#include "SectorGraph.h"
+
+namespace Pathfinding
+{
+	struct PathQuery
+	{
+		int32_t Start = NoCell;
+		int32_t Goal = NoCell;
+		SearchOptions Options;
+	};
+
+	struct PathResult
+	{
+		bool bFound = false;
+		int32_t PathCost = 0;
+		int64_t Expansions = 0;
+		std::vector<int32_t> Path;
+	};
+
+	/**
+	 * A set of independent search contexts over one read-only GridMap.
+	 * Each worker owns a PathPlanner (its own scratch arrays and open list), so queries can be planned concurrently.
+	 * Every search only depends on its query, so the results are identical to planning them one after another.
+	 * With the path cache on, queries without avoid options are looked up before searching and stored after; a
+	 * suffix hit may then return a different path of the same cost. A batch only reads the cache before its searches
+	 * and writes it after them, in query order, so its hits, paths and expansions never depend on thread timing.
+	 */
+	class BatchPlanner
+	{
+
+	public:
+
+		void SetGrid(const GridMap* InGrid);
+		/*
+		 * Same as SetGrid, but uses the components and landmark table read from a cooked map instead of building them.
+		 * The landmarks must match the SetLandmarks settings, a table that was not read for InGrid is built as usual.
+		 */
+		void SetGrid(const GridMap* InGrid, ConnectedComponents&& CookedComponents, LandmarkTable&& CookedLandmarks);
+		void SetWorkerCount(int Count);
+		void SetHeuristicWeight(int Weight);
+		void SetSearchMode(SearchMode NewMode);
+		void SetSectorSize(int Size);
+		//0 turns the landmark heuristic off, the table is rebuilt for every new grid
+		void SetLandmarks(int Count, LandmarkSelection Selection = LandmarkSelection::Farthest);
+		const LandmarkTable& GetLandmarkTable() const { return Landmarks; }
+
+		//Call after GridMap::SetTerrain, never while queries are running. Updates the data the search mode precomputed
+		void OnTerrainChanged(int X, int Y);
+		const SectorGraph& GetSectorGraph() const { return Sectors; }
+
+		//The cells searches with bAvoidOccupied keep out of, shared with every context and read, never written
+		void SetOccupancy(const OccupancyGrid* InOccupancy);
+		const OccupancyGrid* GetOccupancy() const { return Occupancy; }
+		//Call with each cell a ship took or released, or once after the occupancy was cleared, never while queries are running
+		void OnOccupancyChanged(int32_t Cell);
+		void OnOccupancyCleared();
+		const ConnectedComponents& GetComponents() const { return Components; }
+		const ConnectedComponents& GetFreeWater() const { return FreeWater; }
+
+		int GetWorkerCount() const { return static_cast<int>(Contexts.size()); }
+		PathPlanner& GetContext(int Worker) { return *Contexts[Worker]; }
+
+		//Memory for cached paths, 0 turns the cache off. Suffix reuse is on while the searches are optimal
+		void SetPathCache(size_t Bytes);
+		const PathCache& GetPathCache() const { return Paths; }
+
+		//Plan one query with the context of Worker. It looks up and stores the path cache, so only call it serially,
+		//parallel callers go through BeginBatch, SearchQuery and EndBatch
+		void RunQuery(int Worker, const PathQuery& Query, PathResult& OutResult);
+
+		/*
+		 * PlanAll in three steps for callers that fan out on their own threads, like the game with ParallelFor.
+		 * BeginBatch answers what the path cache already holds and lists the other queries in GetPendingQueries, each
+		 * of those goes to SearchQuery on any worker, then EndBatch stores the new paths in query order.
+		 */
+		void BeginBatch(const std::vector<PathQuery>& Queries, std::vector<PathResult>& OutResults);
+		const std::vector<int32_t>& GetPendingQueries() const { return PendingQueries; }
+		//Search only, the path cache is neither read nor written
+		void SearchQuery(int Worker, const PathQuery& Query, PathResult& OutResult);
+		void EndBatch(const std::vector<PathQuery>& Queries, const std::vector<PathResult>& Results);
+
+		/*
+		 * Replan for Agent (e.g. a ship id) with an IncrementalPlanner that is kept for that agent, so a replan towards
+		 * the same goal only repairs what the cells blocked or freed since its last replan changed. The options become
+		 * the blocked cells: AvoidCell and, with bAvoidOccupied, every occupied cell. The least recently used planner is
+		 * handed to a new agent once all slots are taken. Not thread safe, meant for the game thread.
+		 */
+		bool Replan(int32_t Agent, const PathQuery& Query, PathResult& OutResult);
+		void SetReplanSlots(int Count);
+		const PlannerStats& GetReplanStats() const { return ReplanStats; }
+
+		/*
+		 * Plan every query with a pool of std::thread workers, one per context, pulling queries from a shared counter.
+		 * Used by headless builds, the game module fans out with ParallelFor over BeginBatch, SearchQuery and EndBatch.
+		 */
+		void PlanAll(const std::vector<PathQuery>& Queries, std::vector<PathResult>& OutResults);
+
+		PlannerStats GetStats() const;
+		int64_t GetNodeResetsSkipped() const;
+		void ResetStats();
+
+	private:
+
+		const GridMap* Grid = nullptr;
+		int HeuristicWeight = 2;
+		SearchMode Mode = SearchMode::AStar;
+		//Built once per grid and read by every context in JumpPoint and Hierarchical mode
+		JumpTable Jumps;
+		SectorGraph Sectors;
+		int SectorSize = 16;
+		LandmarkTable Landmarks;
+		int LandmarkCount = 0;
+		LandmarkSelection Selection = LandmarkSelection::Farthest;
+		//Water bodies of the terrain, and the same with occupied cells closed for searches that avoid them
+		ConnectedComponents Components;
+		ConnectedComponents FreeWater;
+		const OccupancyGrid* Occupancy = nullptr;
+
+		struct ReplanSlot
+		{
+			int32_t Agent = NoShip;
+			uint64_t LastUse = 0;
+			std::unique_ptr<IncrementalPlanner> Planner;
+		};
+		std::vector<ReplanSlot> ReplanSlots;
+		int ReplanSlotCount = 16;
+		uint64_t ReplanClock = 0;
+		std::vector<int32_t> ReplanBlocked;
+		std::vector<int32_t> HeldCells;
+		PlannerStats ReplanStats;
+		std::vector<std::unique_ptr<PathPlanner>> Contexts;
+		//Shared by every worker, so every access holds PathsMutex
+		PathCache Paths;
+		std::mutex PathsMutex;
+		//Queries of the running batch that the cache did not answer
+		std::vector<int32_t> PendingQueries;
+
+		void UpdateSearchData();
+		void UpdateComponents();
+		void ResetReplanSlots();
+		void UpdateLandmarks();
+		void UpdatePathCache();
+		//Avoid options depend on where the ships are right now, only plain queries are worth keeping
+		bool IsCacheable(const PathQuery& Query) const { return Paths.IsEnabled() && Query.Options.AvoidCell == NoCell && !Query.Options.bAvoidOccupied; }
+	};
+}
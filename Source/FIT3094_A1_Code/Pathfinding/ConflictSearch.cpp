@@ -0,0 +1,500 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ConflictSearch.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace Pathfinding
+{
+	void ConflictSearch::SetGrid(const GridMap* InGrid)
+	{
+		Grid = InGrid;
+		OwnFields.SetGrid(Grid);
+		if(Grid)
+		{
+			OtherPaths.Init(Grid->Num());
+			Owner.assign(Grid->Num(), NoShip);
+			PreviousOwner.assign(Grid->Num(), NoShip);
+		}
+	}
+
+	void ConflictSearch::SetSuboptimality(double InSuboptimality)
+	{
+		Suboptimality = std::max(1.0, InSuboptimality);
+	}
+
+	void ConflictSearch::SetBudget(double InMilliseconds, int InMaxNodes)
+	{
+		BudgetMilliseconds = InMilliseconds;
+		MaxNodes = std::max(1, InMaxNodes);
+	}
+
+	bool ConflictSearch::Solve(const std::vector<int32_t>& Starts, const std::vector<int32_t>& InGoals, std::vector<std::vector<int32_t>>& OutPaths)
+	{
+		StartTime = std::chrono::steady_clock::now();
+		Stats = ConflictSearchStats();
+		SumOfCosts = 0;
+		LowerBound = 0;
+		OutPaths.clear();
+		if(!Grid || Starts.size() != InGoals.size())
+		{
+			return false;
+		}
+
+		const int ShipCount = static_cast<int>(Starts.size());
+		Goals = InGoals;
+		GoalFieldCache& Fields = SharedFields ? *SharedFields : OwnFields;
+		GoalCost.resize(ShipCount);
+		for(int Ship = 0; Ship < ShipCount; Ship++)
+		{
+			GoalCost[Ship] = Fields.GetField(Goals[Ship]);
+		}
+
+		//Every path of the last solve goes at once, the blocks stay for this one
+		NodePaths.Reset();
+		NodePaths.ResetStats();
+
+		//The root plans the ships one after another, each avoiding the paths of the ones before it where it can
+		Nodes.clear();
+		Nodes.emplace_back();
+		HighLevelNode& Root = Nodes.back();
+		Root.Paths.resize(ShipCount);
+		Root.Costs.resize(ShipCount);
+		Root.LowerBounds.resize(ShipCount);
+		OtherPaths.Clear();
+		VertexConstraints.clear();
+		EdgeConstraints.clear();
+		for(int Ship = 0; Ship < ShipCount; Ship++)
+		{
+			PathSpan& Path = Root.Paths[Ship];
+			if(!PlanShip(Ship, Starts[Ship], -1, Path, Root.Costs[Ship], Root.LowerBounds[Ship]))
+			{
+				Stats.bTimedOut = IsOutOfTime();
+				Stats.Milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+				return false;
+			}
+			for(int32_t Time = 0; Time < Path.size(); Time++)
+			{
+				OtherPaths.Reserve(Path[Time], Time, Ship);
+			}
+			OtherPaths.Park(Path.back(), Path.size() - 1, Ship);
+			Root.Cost += Root.Costs[Ship];
+			Root.LowerBound += Root.LowerBounds[Ship];
+		}
+		Constraint First;
+		Constraint Second;
+		Root.Conflicts = CountConflicts(Root.Paths, First, Second);
+		Stats.InitialConflicts = Root.Conflicts;
+
+		std::vector<int> Open = {0};
+		bool bSolved = false;
+		while(!Open.empty())
+		{
+			if(IsOutOfTime() || static_cast<int>(Nodes.size()) >= MaxNodes)
+			{
+				Stats.bTimedOut = true;
+				break;
+			}
+
+			const int Position = SelectNode(Open, LowerBound);
+			const int NodeIndex = Open[Position];
+			Open[Position] = Open.back();
+			Open.pop_back();
+			Stats.HighLevelNodes++;
+
+			if(Nodes[NodeIndex].Conflicts == 0)
+			{
+				const HighLevelNode& Solution = Nodes[NodeIndex];
+				OutPaths.resize(ShipCount);
+				for(int Ship = 0; Ship < ShipCount; Ship++)
+				{
+					//The paths start with the start cell, the callers only want the steps
+					OutPaths[Ship].assign(Solution.Paths[Ship].begin() + 1, Solution.Paths[Ship].end());
+				}
+				SumOfCosts = Solution.Cost;
+				LowerBound = std::min(LowerBound, Solution.LowerBound);
+				bSolved = true;
+				break;
+			}
+
+			CountConflicts(Nodes[NodeIndex].Paths, First, Second);
+			if(First.Time == 0)
+			{
+				//Two ships starting on the same cell can never be separated
+				break;
+			}
+
+			for(const Constraint& Added : {First, Second})
+			{
+				Nodes.emplace_back();
+				const int ChildIndex = static_cast<int>(Nodes.size()) - 1;
+				HighLevelNode& Child = Nodes.back();
+				const HighLevelNode& Parent = Nodes[NodeIndex];
+				Child.Parent = NodeIndex;
+				Child.Added = Added;
+				Child.Paths = Parent.Paths;
+				Child.Costs = Parent.Costs;
+				Child.LowerBounds = Parent.LowerBounds;
+
+				int32_t LastGoalTime = -1;
+				CollectConstraints(ChildIndex, Added.Ship, LastGoalTime);
+				FillOtherPaths(Child, Added.Ship);
+				if(!PlanShip(Added.Ship, Starts[Added.Ship], LastGoalTime, Child.Paths[Added.Ship], Child.Costs[Added.Ship], Child.LowerBounds[Added.Ship]))
+				{
+					Nodes.pop_back();
+					continue;
+				}
+				for(int Ship = 0; Ship < ShipCount; Ship++)
+				{
+					Child.Cost += Child.Costs[Ship];
+					Child.LowerBound += Child.LowerBounds[Ship];
+				}
+				Constraint Unused;
+				Constraint UnusedOther;
+				Child.Conflicts = CountConflicts(Child.Paths, Unused, UnusedOther);
+				Open.push_back(ChildIndex);
+			}
+		}
+
+		Stats.Milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+		//The node paths stay in the arena until the next solve resets it
+		Nodes.clear();
+		return bSolved;
+	}
+
+	uint64_t ConflictSearch::EdgeKey(int32_t From, int32_t To, int32_t Time) const
+	{
+		const int32_t Delta = To - From;
+		const int Direction = Delta == 1 ? 0 : Delta == -1 ? 1 : Delta > 0 ? 2 : 3;
+		return static_cast<uint64_t>(static_cast<uint32_t>(Time)) << 32 | static_cast<uint32_t>(From * 4 + Direction);
+	}
+
+	void ConflictSearch::CollectConstraints(int NodeIndex, int Ship, int32_t& OutLastGoalTime)
+	{
+		VertexConstraints.clear();
+		EdgeConstraints.clear();
+		OutLastGoalTime = -1;
+		for(int Index = NodeIndex; Index >= 0; Index = Nodes[Index].Parent)
+		{
+			const Constraint& Added = Nodes[Index].Added;
+			if(Added.Ship != Ship)
+			{
+				continue;
+			}
+			if(Added.To == NoCell)
+			{
+				VertexConstraints.insert(StateKey(Added.Cell, Added.Time));
+				//The ship may only stop on its goal after the last step it is kept off it
+				if(Added.Cell == Goals[Ship])
+				{
+					OutLastGoalTime = std::max(OutLastGoalTime, Added.Time);
+				}
+			}
+			else
+			{
+				EdgeConstraints.insert(EdgeKey(Added.Cell, Added.To, Added.Time));
+			}
+		}
+	}
+
+	void ConflictSearch::FillOtherPaths(const HighLevelNode& Node, int Ship)
+	{
+		OtherPaths.Clear();
+		for(int Other = 0; Other < static_cast<int>(Node.Paths.size()); Other++)
+		{
+			if(Other == Ship)
+			{
+				continue;
+			}
+			const PathSpan& Path = Node.Paths[Other];
+			for(int32_t Time = 0; Time < Path.size(); Time++)
+			{
+				OtherPaths.Reserve(Path[Time], Time, Other);
+			}
+			OtherPaths.Park(Path.back(), Path.size() - 1, Other);
+		}
+	}
+
+	bool ConflictSearch::PlanShip(int Ship, int32_t Start, int32_t LastGoalTime, PathSpan& OutPath, int32_t& OutCost, int32_t& OutLowerBound)
+	{
+		const std::vector<int32_t>& Cost = *GoalCost[Ship];
+		if(Cost[Start] == UnreachableCost)
+		{
+			return false;
+		}
+		Stats.LowLevelSearches++;
+
+		//Three heaps with lazy deletion: every open state by f for the lower bound, focal with the states within the
+		//bound by conflicts, then f, then deepest first, and the states above the bound waiting for it to rise
+		ClearStates();
+		OpenByF.clear();
+		Focal.clear();
+		Pending.clear();
+		auto ByF = [](const HeapEntry& A, const HeapEntry& B) { return A.F != B.F ? A.F > B.F : A.G < B.G; };
+		auto ByConflicts = [](const HeapEntry& A, const HeapEntry& B) { return std::tie(A.Conflicts, A.F, B.G) > std::tie(B.Conflicts, B.F, A.G); };
+		auto IsStale = [this](const HeapEntry& Entry)
+		{
+			const LowLevelNode& State = States[Entry.Index];
+			return State.bClosed || State.G != Entry.G || State.Conflicts != Entry.Conflicts;
+		};
+		int32_t FMin = Cost[Start];
+		int32_t Bound = static_cast<int32_t>(Suboptimality * FMin);
+		auto PushState = [&](int32_t Index)
+		{
+			const LowLevelNode& State = States[Index];
+			const HeapEntry Entry = {State.F, State.G, State.Conflicts, Index};
+			OpenByF.push_back(Entry);
+			std::push_heap(OpenByF.begin(), OpenByF.end(), ByF);
+			std::vector<HeapEntry>& Target = State.F <= Bound ? Focal : Pending;
+			Target.push_back(Entry);
+			std::push_heap(Target.begin(), Target.end(), State.F <= Bound ? ByConflicts : ByF);
+		};
+
+		bool bInserted = false;
+		FindOrAddState(StateKey(Start, 0), 0, bInserted);
+		States.push_back({Start, 0, 0, Cost[Start], 0, -1, false});
+		PushState(0);
+
+		const int Pitch = Grid->GetPitch();
+		while(true)
+		{
+			while(!OpenByF.empty() && IsStale(OpenByF.front()))
+			{
+				std::pop_heap(OpenByF.begin(), OpenByF.end(), ByF);
+				OpenByF.pop_back();
+			}
+			if(OpenByF.empty())
+			{
+				return false;
+			}
+			if((++Stats.LowLevelExpansions & 1023) == 0 && IsOutOfTime())
+			{
+				return false;
+			}
+
+			//The lower bound rose, every waiting state that now fits under the new bound joins focal
+			if(OpenByF.front().F > FMin)
+			{
+				FMin = OpenByF.front().F;
+				Bound = static_cast<int32_t>(Suboptimality * FMin);
+				while(!Pending.empty() && Pending.front().F <= Bound)
+				{
+					if(!IsStale(Pending.front()))
+					{
+						Focal.push_back(Pending.front());
+						std::push_heap(Focal.begin(), Focal.end(), ByConflicts);
+					}
+					std::pop_heap(Pending.begin(), Pending.end(), ByF);
+					Pending.pop_back();
+				}
+			}
+			while(!Focal.empty() && IsStale(Focal.front()))
+			{
+				std::pop_heap(Focal.begin(), Focal.end(), ByConflicts);
+				Focal.pop_back();
+			}
+			//The state with the lowest f is always within the bound, so focal only runs dry on stale entries
+			const int32_t Index = Focal.empty() ? OpenByF.front().Index : Focal.front().Index;
+			if(!Focal.empty())
+			{
+				std::pop_heap(Focal.begin(), Focal.end(), ByConflicts);
+				Focal.pop_back();
+			}
+			States[Index].bClosed = true;
+			const LowLevelNode Current = States[Index];
+
+			if(Current.Cell == Goals[Ship] && Current.Time > LastGoalTime)
+			{
+				//The length is known from the time of the goal state, so the path is written back to front straight into the arena
+				OutPath = NodePaths.Allocate(Current.Time + 1);
+				for(int32_t State = Index; State >= 0; State = States[State].Parent)
+				{
+					OutPath[States[State].Time] = States[State].Cell;
+				}
+				OutCost = Current.G;
+				OutLowerBound = FMin;
+				return true;
+			}
+
+			const int32_t Moves[5] = {Current.Cell, Current.Cell + 1, Current.Cell - 1, Current.Cell + Pitch, Current.Cell - Pitch};
+			for(const int32_t Next : Moves)
+			{
+				const int32_t NextTime = Current.Time + 1;
+				if(!Grid->IsPassable(Next) || Cost[Next] == UnreachableCost || (!VertexConstraints.empty() && VertexConstraints.count(StateKey(Next, NextTime)) > 0))
+				{
+					continue;
+				}
+				if(Next != Current.Cell && !EdgeConstraints.empty() && EdgeConstraints.count(EdgeKey(Current.Cell, Next, Current.Time)) > 0)
+				{
+					continue;
+				}
+
+				const int32_t NewG = Current.G + (Next == Current.Cell ? WaitStepCost : Grid->GetTravelCost(Next));
+				const int32_t NewConflicts = Current.Conflicts + (OtherPaths.CanMove(Current.Cell, Next, Current.Time, Ship) ? 0 : 1);
+				const int32_t NextIndex = FindOrAddState(StateKey(Next, NextTime), static_cast<int32_t>(States.size()), bInserted);
+				if(bInserted)
+				{
+					States.push_back({Next, NextTime, NewG, NewG + Cost[Next], NewConflicts, Index, false});
+					PushState(NextIndex);
+					continue;
+				}
+
+				LowLevelNode& State = States[NextIndex];
+				if(State.bClosed || NewG > State.G || (NewG == State.G && NewConflicts >= State.Conflicts))
+				{
+					continue;
+				}
+				//The old heap entries go stale, the state is pushed again with its new key
+				State.G = NewG;
+				State.F = NewG + Cost[Next];
+				State.Conflicts = NewConflicts;
+				State.Parent = Index;
+				PushState(NextIndex);
+			}
+		}
+	}
+
+	int32_t ConflictSearch::FindOrAddState(uint64_t Key, int32_t NewIndex, bool& bOutInserted)
+	{
+		if((NewIndex + 1) * 2 > static_cast<int32_t>(StateKeys.size()))
+		{
+			//Grow and put every state back, the keys can be rebuilt from States
+			StateShift = StateKeys.empty() ? 52 : StateShift - 1;
+			StateKeys.assign(size_t(1) << (64 - StateShift), UINT64_MAX);
+			StateSlots.resize(StateKeys.size());
+			for(int32_t Index = 0; Index < static_cast<int32_t>(States.size()); Index++)
+			{
+				bool bUnused = false;
+				FindOrAddState(StateKey(States[Index].Cell, States[Index].Time), Index, bUnused);
+			}
+		}
+
+		const size_t Mask = StateKeys.size() - 1;
+		size_t Slot = static_cast<size_t>((Key * 0x9E3779B97F4A7C15ull) >> StateShift);
+		for(; StateKeys[Slot] != UINT64_MAX; Slot = (Slot + 1) & Mask)
+		{
+			if(StateKeys[Slot] == Key)
+			{
+				bOutInserted = false;
+				return StateSlots[Slot];
+			}
+		}
+		StateKeys[Slot] = Key;
+		StateSlots[Slot] = NewIndex;
+		bOutInserted = true;
+		return NewIndex;
+	}
+
+	void ConflictSearch::ClearStates()
+	{
+		if(!States.empty())
+		{
+			std::fill(StateKeys.begin(), StateKeys.end(), UINT64_MAX);
+		}
+		States.clear();
+	}
+
+	int ConflictSearch::CountConflicts(const std::vector<PathSpan>& Paths, Constraint& OutFirst, Constraint& OutSecond)
+	{
+		int32_t Steps = 0;
+		for(const PathSpan& Path : Paths)
+		{
+			Steps = std::max(Steps, Path.size());
+		}
+
+		int Conflicts = 0;
+		OutFirst.Time = -1;
+		const int ShipCount = static_cast<int>(Paths.size());
+		for(int32_t Time = 0; Time < Steps; Time++)
+		{
+			for(int Ship = 0; Ship < ShipCount; Ship++)
+			{
+				const int32_t Cell = CellAt(Paths[Ship], Time);
+				if(Owner[Cell] == NoShip)
+				{
+					Owner[Cell] = Ship;
+					continue;
+				}
+				Conflicts++;
+				if(OutFirst.Time < 0)
+				{
+					OutFirst = {Owner[Cell], Cell, NoCell, Time};
+					OutSecond = {Ship, Cell, NoCell, Time};
+				}
+			}
+
+			if(Time > 0)
+			{
+				for(int Ship = 0; Ship < ShipCount; Ship++)
+				{
+					const int32_t From = CellAt(Paths[Ship], Time - 1);
+					const int32_t To = CellAt(Paths[Ship], Time);
+					const int Other = From != To ? PreviousOwner[To] : NoShip;
+					if(Other > Ship && CellAt(Paths[Other], Time) == From)
+					{
+						Conflicts++;
+						if(OutFirst.Time < 0)
+						{
+							OutFirst = {Ship, From, To, Time - 1};
+							OutSecond = {Other, To, From, Time - 1};
+						}
+					}
+				}
+				for(int Ship = 0; Ship < ShipCount; Ship++)
+				{
+					PreviousOwner[CellAt(Paths[Ship], Time - 1)] = NoShip;
+				}
+			}
+			for(int Ship = 0; Ship < ShipCount; Ship++)
+			{
+				const int32_t Cell = CellAt(Paths[Ship], Time);
+				if(Owner[Cell] != NoShip)
+				{
+					PreviousOwner[Cell] = Owner[Cell];
+					Owner[Cell] = NoShip;
+				}
+			}
+		}
+		for(int Ship = 0; Ship < ShipCount && Steps > 0; Ship++)
+		{
+			PreviousOwner[CellAt(Paths[Ship], Steps - 1)] = NoShip;
+		}
+		return Conflicts;
+	}
+
+	int ConflictSearch::SelectNode(const std::vector<int>& Open, int64_t& OutLowerBound) const
+	{
+		OutLowerBound = INT64_MAX;
+		for(const int Index : Open)
+		{
+			OutLowerBound = std::min(OutLowerBound, Nodes[Index].LowerBound);
+		}
+
+		//Focal: every node within the bound, the one with the fewest conflicts goes first
+		const double Bound = Suboptimality * OutLowerBound;
+		int Best = 0;
+		for(int Position = 1; Position < static_cast<int>(Open.size()); Position++)
+		{
+			const HighLevelNode& Node = Nodes[Open[Position]];
+			const HighLevelNode& BestNode = Nodes[Open[Best]];
+			const bool bInFocal = Node.Cost <= Bound;
+			const bool bBestInFocal = BestNode.Cost <= Bound;
+			if(bInFocal != bBestInFocal)
+			{
+				Best = bInFocal ? Position : Best;
+			}
+			else if(bInFocal ? std::tie(Node.Conflicts, Node.Cost) < std::tie(BestNode.Conflicts, BestNode.Cost) : Node.LowerBound < BestNode.LowerBound)
+			{
+				Best = Position;
+			}
+		}
+		return Best;
+	}
+
+	bool ConflictSearch::IsOutOfTime() const
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count() > BudgetMilliseconds;
+	}
+}
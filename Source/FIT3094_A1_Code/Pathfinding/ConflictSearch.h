@@ -0,0 +1,155 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+#include "GoalFieldCache.h"
+#include "GridMap.h"
+#include "PathArena.h"
+#include "ReservationTable.h"
+
+namespace Pathfinding
+{
+	struct ConflictSearchStats
+	{
+		int64_t HighLevelNodes = 0;
+		int64_t LowLevelSearches = 0;
+		int64_t LowLevelExpansions = 0;
+		//Conflicts between the first paths, before any were resolved
+		int InitialConflicts = 0;
+		double Milliseconds = 0;
+		bool bTimedOut = false;
+	};
+
+	/**
+	 * Conflict-based search for all ships of a level at once, in the bounded suboptimal ECBS form.
+	 * Ships move one cell or wait per step like in CooperativePlanner, a move costs the travel cost of the cell entered
+	 * and waiting costs 1; a ship stays on its goal once it is there. The high level picks a conflict between two
+	 * ships (the same cell at the same step, or swapping cells) and tries both ways of forbidding it, replanning one
+	 * ship each time. Both levels use focal search: among the candidates within Suboptimality times the lower bound
+	 * they prefer the one with the fewest conflicts, so the sum of costs is at most Suboptimality times the optimum.
+	 * With a Suboptimality of 1 this is plain CBS. Solve gives up once the time or node budget runs out.
+	 */
+	class ConflictSearch
+	{
+
+	public:
+
+		void SetGrid(const GridMap* InGrid);
+		//Optional, shared with the other planners of the grid. Without one the search keeps its own fields
+		void SetGoalFields(GoalFieldCache* InFields) { SharedFields = InFields; }
+		void SetSuboptimality(double InSuboptimality);
+		//Wall time and high level nodes Solve may use before it gives up
+		void SetBudget(double InMilliseconds, int InMaxNodes);
+
+		/*
+		 * True when conflict free paths for every ship were found within the budget. OutPaths[i] is the cell of
+		 * ship i for each step after the start up to its goal, a repeated cell means waiting.
+		 */
+		bool Solve(const std::vector<int32_t>& Starts, const std::vector<int32_t>& Goals, std::vector<std::vector<int32_t>>& OutPaths);
+
+		//Of the last solution: sum of the path costs including waits, and the lower bound on the optimum it was checked against
+		int64_t GetSumOfCosts() const { return SumOfCosts; }
+		int64_t GetLowerBound() const { return LowerBound; }
+		const ConflictSearchStats& GetStats() const { return Stats; }
+		//Where the paths of the high level nodes live, reset at the start of every solve
+		const PathArena& GetPathArena() const { return NodePaths; }
+
+	private:
+
+		struct Constraint
+		{
+			int Ship = -1;
+			int32_t Cell = NoCell;
+			//NoCell for a vertex constraint, else the ship may not move from Cell to To between Time and Time + 1
+			int32_t To = NoCell;
+			int32_t Time = 0;
+		};
+
+		struct HighLevelNode
+		{
+			int Parent = -1;
+			Constraint Added;
+			//Positions from step 0 in NodePaths, shared with the parent for every ship that was not replanned
+			std::vector<PathSpan> Paths;
+			std::vector<int32_t> Costs;
+			std::vector<int32_t> LowerBounds;
+			int64_t Cost = 0;
+			int64_t LowerBound = 0;
+			int Conflicts = 0;
+		};
+
+		struct LowLevelNode
+		{
+			int32_t Cell;
+			int32_t Time;
+			int32_t G;
+			int32_t F;
+			int32_t Conflicts;
+			int32_t Parent;
+			bool bClosed;
+		};
+
+		const GridMap* Grid = nullptr;
+		double Suboptimality = 1.2;
+		double BudgetMilliseconds = 1000;
+		int MaxNodes = 20000;
+
+		std::vector<int32_t> Goals;
+		GoalFieldCache* SharedFields = nullptr;
+		GoalFieldCache OwnFields;
+		std::vector<GoalField> GoalCost;
+		std::vector<HighLevelNode> Nodes;
+		PathArena NodePaths;
+
+		struct HeapEntry
+		{
+			int32_t F;
+			int32_t G;
+			int32_t Conflicts;
+			int32_t Index;
+		};
+
+		//Low level scratch, reused between searches
+		std::vector<LowLevelNode> States;
+		std::vector<HeapEntry> OpenByF;
+		std::vector<HeapEntry> Focal;
+		std::vector<HeapEntry> Pending;
+		//Open addressing map from (time, cell) to the index in States, kept at most half full
+		std::vector<uint64_t> StateKeys;
+		std::vector<int32_t> StateSlots;
+		int StateShift = 64;
+		std::unordered_set<uint64_t> VertexConstraints;
+		std::unordered_set<uint64_t> EdgeConstraints;
+		//The other ships' paths, a move that breaks one of their reservations counts as a conflict
+		ReservationTable OtherPaths;
+		//Conflict counting scratch, the ship in every cell at the current and previous step
+		std::vector<int32_t> Owner;
+		std::vector<int32_t> PreviousOwner;
+
+		int64_t SumOfCosts = 0;
+		int64_t LowerBound = 0;
+		ConflictSearchStats Stats;
+		std::chrono::steady_clock::time_point StartTime;
+
+		static uint64_t StateKey(int32_t Cell, int32_t Time) { return static_cast<uint64_t>(static_cast<uint32_t>(Time)) << 32 | static_cast<uint32_t>(Cell); }
+		uint64_t EdgeKey(int32_t From, int32_t To, int32_t Time) const;
+		static int32_t CellAt(const PathSpan& Path, int32_t Time) { return Path[Time < Path.size() ? Time : Path.size() - 1]; }
+
+		//Index of the state in States, or adds NewIndex for it and sets bOutInserted
+		int32_t FindOrAddState(uint64_t Key, int32_t NewIndex, bool& bOutInserted);
+		void ClearStates();
+		void CollectConstraints(int NodeIndex, int Ship, int32_t& OutLastGoalTime);
+		void FillOtherPaths(const HighLevelNode& Node, int Ship);
+		bool PlanShip(int Ship, int32_t Start, int32_t LastGoalTime, PathSpan& OutPath, int32_t& OutCost, int32_t& OutLowerBound);
+		//Number of conflicting pairs over all steps, and the earliest one
+		int CountConflicts(const std::vector<PathSpan>& Paths, Constraint& OutFirst, Constraint& OutSecond);
+		//Position in Open of the node to expand next, and the lower bound of all open nodes
+		int SelectNode(const std::vector<int>& Open, int64_t& OutLowerBound) const;
+		bool IsOutOfTime() const;
+	};
+}
@@ -0,0 +1,294 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ConnectedComponents.h"
+
+#include <algorithm>
+
+namespace Pathfinding
+{
+	void ConnectedComponents::Build(const GridMap& InGrid, const OccupancyGrid* InOccupancy)
+	{
+		Grid = &InGrid;
+		Occupancy = InOccupancy;
+		Component.assign(Grid->Num(), NoComponent);
+		Size.clear();
+		FreeIds.clear();
+		LiveCount = 0;
+
+		for(int32_t Seed = 0; Seed < Grid->Num(); Seed++)
+		{
+			if(IsOpen(Seed) && Component[Seed] == NoComponent)
+			{
+				Relabel(Seed, NewId());
+			}
+		}
+	}
+
+	void ConnectedComponents::Assign(const GridMap& InGrid, const int32_t* Ids, int InComponentCount)
+	{
+		Grid = &InGrid;
+		Occupancy = nullptr;
+		Component.assign(Ids, Ids + Grid->Num());
+		Size.assign(InComponentCount, 0);
+		FreeIds.clear();
+		LiveCount = InComponentCount;
+		for(const int32_t Id : Component)
+		{
+			if(Id != NoComponent)
+			{
+				Size[Id]++;
+			}
+		}
+	}
+
+	void ConnectedComponents::OnCellChanged(int32_t Cell)
+	{
+		const bool bOpen = IsOpen(Cell);
+		const bool bLabelled = Component[Cell] != NoComponent;
+		if(bOpen && !bLabelled)
+		{
+			Open(Cell);
+		}
+		else if(!bOpen && bLabelled)
+		{
+			Close(Cell);
+		}
+	}
+
+	bool ConnectedComponents::CanReach(int32_t Start, int32_t Goal) const
+	{
+		if(Start == Goal)
+		{
+			return true;
+		}
+		const int32_t Target = Component[Goal];
+		if(Target == NoComponent)
+		{
+			return false;
+		}
+		if(Component[Start] == Target)
+		{
+			return true;
+		}
+		const int Pitch = Grid->GetPitch();
+		return Component[Start + 1] == Target || Component[Start - 1] == Target || Component[Start + Pitch] == Target || Component[Start - Pitch] == Target;
+	}
+
+	size_t ConnectedComponents::GetMemoryBytes() const
+	{
+		return (Component.capacity() + Size.capacity() + FreeIds.capacity()) * sizeof(int32_t) + VisitStamp.capacity() * sizeof(uint32_t) + VisitFront.capacity();
+	}
+
+	int32_t ConnectedComponents::NewId()
+	{
+		LiveCount++;
+		if(!FreeIds.empty())
+		{
+			const int32_t Id = FreeIds.back();
+			FreeIds.pop_back();
+			return Id;
+		}
+		Size.push_back(0);
+		return static_cast<int32_t>(Size.size()) - 1;
+	}
+
+	void ConnectedComponents::ReleaseId(int32_t Id)
+	{
+		LiveCount--;
+		Size[Id] = 0;
+		FreeIds.push_back(Id);
+	}
+
+	void ConnectedComponents::Relabel(int32_t Seed, int32_t To)
+	{
+		//Flood over open cells that do not carry To yet, the land border keeps every neighbour inside the array
+		const int Pitch = Grid->GetPitch();
+		Component[Seed] = To;
+		Size[To]++;
+		Stack.push_back(Seed);
+		while(!Stack.empty())
+		{
+			const int32_t Current = Stack.back();
+			Stack.pop_back();
+			const int32_t Neighbours[4] = {Current + 1, Current - 1, Current + Pitch, Current - Pitch};
+			for(const int32_t Neighbour : Neighbours)
+			{
+				if(Component[Neighbour] != To && IsOpen(Neighbour))
+				{
+					Component[Neighbour] = To;
+					Size[To]++;
+					Stack.push_back(Neighbour);
+				}
+			}
+		}
+	}
+
+	void ConnectedComponents::Open(int32_t Cell)
+	{
+		const int Pitch = Grid->GetPitch();
+		const int32_t Neighbours[4] = {Cell + 1, Cell - 1, Cell + Pitch, Cell - Pitch};
+
+		//The largest neighbouring component keeps its id, the others are relabelled into it
+		int32_t Target = NoComponent;
+		for(const int32_t Neighbour : Neighbours)
+		{
+			const int32_t Id = Component[Neighbour];
+			if(Id != NoComponent && (Target == NoComponent || Size[Id] > Size[Target]))
+			{
+				Target = Id;
+			}
+		}
+		if(Target == NoComponent)
+		{
+			Target = NewId();
+		}
+		Component[Cell] = Target;
+		Size[Target]++;
+
+		for(const int32_t Neighbour : Neighbours)
+		{
+			const int32_t Id = Component[Neighbour];
+			if(Id != NoComponent && Id != Target)
+			{
+				ReleaseId(Id);
+				Relabel(Neighbour, Target);
+			}
+		}
+	}
+
+	void ConnectedComponents::Close(int32_t Cell)
+	{
+		const int32_t OldId = Component[Cell];
+		Component[Cell] = NoComponent;
+		if(--Size[OldId] == 0)
+		{
+			ReleaseId(OldId);
+			return;
+		}
+
+		const int Pitch = Grid->GetPitch();
+		const int32_t Neighbours[4] = {Cell + 1, Cell - 1, Cell + Pitch, Cell - Pitch};
+
+		if(VisitStamp.size() != Component.size())
+		{
+			VisitStamp.assign(Component.size(), 0);
+			VisitFront.assign(Component.size(), 0);
+			CurrentStamp = 0;
+		}
+		if(++CurrentStamp == 0)
+		{
+			std::fill(VisitStamp.begin(), VisitStamp.end(), 0);
+			CurrentStamp = 1;
+		}
+
+		//One breadth first front per open neighbour, fronts that touch are joined in a tiny union find
+		int FrontCount = 0;
+		int Group[4];
+		size_t Head[4];
+		bool bResolved[4];
+		for(const int32_t Neighbour : Neighbours)
+		{
+			if(Component[Neighbour] == OldId)
+			{
+				FrontCells[FrontCount].assign(1, Neighbour);
+				Head[FrontCount] = 0;
+				Group[FrontCount] = FrontCount;
+				bResolved[FrontCount] = false;
+				VisitStamp[Neighbour] = CurrentStamp;
+				VisitFront[Neighbour] = static_cast<uint8_t>(FrontCount);
+				FrontCount++;
+			}
+		}
+
+		auto FindGroup = [&Group](int Front)
+		{
+			while(Group[Front] != Front)
+			{
+				Front = Group[Front];
+			}
+			return Front;
+		};
+
+		auto CountGroups = [&]()
+		{
+			int Groups = 0;
+			for(int Front = 0; Front < FrontCount; Front++)
+			{
+				Groups += !bResolved[Front] && FindGroup(Front) == Front ? 1 : 0;
+			}
+			return Groups;
+		};
+
+		while(CountGroups() > 1)
+		{
+			//Grow every front by one cell
+			for(int Front = 0; Front < FrontCount; Front++)
+			{
+				if(bResolved[Front] || Head[Front] == FrontCells[Front].size())
+				{
+					continue;
+				}
+				const int32_t Current = FrontCells[Front][Head[Front]++];
+				const int32_t Next[4] = {Current + 1, Current - 1, Current + Pitch, Current - Pitch};
+				for(const int32_t Neighbour : Next)
+				{
+					if(Component[Neighbour] != OldId)
+					{
+						continue;
+					}
+					if(VisitStamp[Neighbour] == CurrentStamp)
+					{
+						const int Mine = FindGroup(Front);
+						const int Theirs = FindGroup(VisitFront[Neighbour]);
+						if(Mine != Theirs)
+						{
+							Group[std::max(Mine, Theirs)] = std::min(Mine, Theirs);
+						}
+						continue;
+					}
+					VisitStamp[Neighbour] = CurrentStamp;
+					VisitFront[Neighbour] = static_cast<uint8_t>(Front);
+					FrontCells[Front].push_back(Neighbour);
+				}
+			}
+
+			//A group whose fronts have all run dry is a piece of its own and gets a new id
+			for(int Root = 0; Root < FrontCount; Root++)
+			{
+				if(bResolved[Root] || FindGroup(Root) != Root)
+				{
+					continue;
+				}
+				bool bExhausted = true;
+				for(int Front = 0; Front < FrontCount; Front++)
+				{
+					if(FindGroup(Front) == Root && Head[Front] != FrontCells[Front].size())
+					{
+						bExhausted = false;
+					}
+				}
+				if(!bExhausted || CountGroups() == 1)
+				{
+					continue;
+				}
+
+				const int32_t Id = NewId();
+				for(int Front = 0; Front < FrontCount; Front++)
+				{
+					if(FindGroup(Front) != Root)
+					{
+						continue;
+					}
+					bResolved[Front] = true;
+					for(const int32_t Piece : FrontCells[Front])
+					{
+						Component[Piece] = Id;
+					}
+					Size[Id] += static_cast<int32_t>(FrontCells[Front].size());
+					Size[OldId] -= static_cast<int32_t>(FrontCells[Front].size());
+				}
+			}
+		}
+	}
+}
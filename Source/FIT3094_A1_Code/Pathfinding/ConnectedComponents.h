@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "GridMap.h"
+#include "OccupancyGrid.h"
+
+namespace Pathfinding
+{
+	/**
+	 * Labels every open cell with the id of the body of water it belongs to.
+	 * Cells are connected through their four neighbours, so two cells with different ids can never reach each other.
+	 * Ids are indexed like the GridMap, land and the padding border have NoComponent.
+	 *
+	 * Built with an OccupancyGrid, cells a ship holds count as closed as well. OnCellChanged keeps the ids up to
+	 * date when a single cell opens or closes: opening merges the components around it, closing runs one search from
+	 * each open neighbour at the same time and stops as soon as they have all met, so only a real split walks a whole piece.
+	 * Ids stay stable otherwise, but they are not contiguous after updates.
+	 */
+	class ConnectedComponents
+	{
+
+	public:
+
+		static constexpr int32_t NoComponent = -1;
+
+		void Build(const GridMap& InGrid, const OccupancyGrid* InOccupancy = nullptr);
+		//Takes ids that were built for InGrid without an occupancy earlier, Ids holds InGrid.Num() values
+		void Assign(const GridMap& InGrid, const int32_t* Ids, int InComponentCount);
+
+		//Call after the terrain of Cell changed or a ship took or released it
+		void OnCellChanged(int32_t Cell);
+
+		const GridMap* GetGrid() const { return Grid; }
+		bool BlocksOccupied() const { return Occupancy != nullptr; }
+		//Components that currently exist
+		int GetComponentCount() const { return LiveCount; }
+		int32_t GetComponent(int32_t Cell) const { return Component[Cell]; }
+		bool AreConnected(int32_t A, int32_t B) const { return Component[A] != NoComponent && Component[A] == Component[B]; }
+		const std::vector<int32_t>& GetIds() const { return Component; }
+
+		/*
+		 * False when no path from Start to Goal exists, in O(1). The start cell is never entered by a search,
+		 * so it may be closed (e.g. occupied by the ship that searches), then its open neighbours decide.
+		 */
+		bool CanReach(int32_t Start, int32_t Goal) const;
+
+		size_t GetMemoryBytes() const;
+
+	private:
+
+		const GridMap* Grid = nullptr;
+		const OccupancyGrid* Occupancy = nullptr;
+		int LiveCount = 0;
+		std::vector<int32_t> Component;
+		//Cells per id, 0 for ids that are free to reuse
+		std::vector<int32_t> Size;
+		std::vector<int32_t> FreeIds;
+
+		//Scratch of the searches that OnCellChanged runs, stamped so they never need clearing
+		std::vector<uint32_t> VisitStamp;
+		std::vector<uint8_t> VisitFront;
+		uint32_t CurrentStamp = 0;
+		std::vector<int32_t> FrontCells[4];
+		std::vector<int32_t> Stack;
+
+		bool IsOpen(int32_t Cell) const { return Grid->IsPassable(Cell) && !(Occupancy && Occupancy->IsHeld(Cell)); }
+		int32_t NewId();
+		void ReleaseId(int32_t Id);
+		//Gives every cell of the component containing Seed the id To
+		void Relabel(int32_t Seed, int32_t To);
+		void Open(int32_t Cell);
+		void Close(int32_t Cell);
+	};
+}
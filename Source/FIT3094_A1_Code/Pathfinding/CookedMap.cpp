@@ -0,0 +1,223 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CookedMap.h"
+
+#include <cstring>
+
+#include "MapLoader.h"
+
+namespace Pathfinding
+{
+	namespace
+	{
+		const char CookedMagic[8] = {'P', 'F', 'C', 'O', 'O', 'K', 'E', 'D'};
+		constexpr uint32_t ByteOrderMark = 0x01020304;
+
+		struct CookedHeader
+		{
+			char Magic[8];
+			uint32_t Version;
+			uint32_t ByteOrder;
+			int32_t Width;
+			int32_t Height;
+			uint64_t SourceHash;
+			uint64_t SourceSize;
+			uint64_t PayloadHash;
+			uint64_t PayloadSize;
+			int32_t ComponentCount;
+			int32_t LandmarkCount;
+			uint32_t Selection;
+			uint32_t LandmarkSeed;
+		};
+		static_assert(sizeof(CookedHeader) % 8 == 0, "Sections after the header must stay 8 byte aligned");
+
+		size_t Align8(size_t Bytes)
+		{
+			return (Bytes + 7) & ~static_cast<size_t>(7);
+		}
+
+		//Byte size of every section, derived from the header alone
+		struct SectionSizes
+		{
+			size_t Terrain = 0;
+			size_t Components = 0;
+			size_t Landmarks = 0;
+			size_t Table = 0;
+
+			size_t Total() const { return Align8(Terrain) + Align8(Components) + Align8(Landmarks) + 2 * Align8(Table); }
+		};
+
+		SectionSizes SizesOf(int Width, int Height, int LandmarkCount)
+		{
+			const size_t CellCount = static_cast<size_t>(Width + 2) * (Height + 2);
+			SectionSizes Sizes;
+			Sizes.Terrain = (static_cast<size_t>(Width) * Height + 3) / 4;
+			Sizes.Components = CellCount * sizeof(int32_t);
+			Sizes.Landmarks = static_cast<size_t>(LandmarkCount) * sizeof(int32_t);
+			Sizes.Table = CellCount * LandmarkCount * sizeof(uint16_t);
+			return Sizes;
+		}
+
+		void AppendSection(std::vector<uint8_t>& Out, const void* Data, size_t Size)
+		{
+			const uint8_t* Bytes = static_cast<const uint8_t*>(Data);
+			Out.insert(Out.end(), Bytes, Bytes + Size);
+			Out.resize(Align8(Out.size()), 0);
+		}
+
+		bool ReadHeader(const uint8_t* Data, size_t Size, CookedHeader& OutHeader)
+		{
+			if(!Data || Size < sizeof(CookedHeader))
+			{
+				return false;
+			}
+			std::memcpy(&OutHeader, Data, sizeof(CookedHeader));
+			if(std::memcmp(OutHeader.Magic, CookedMagic, sizeof(CookedMagic)) != 0 || OutHeader.Version != CookedMapVersion || OutHeader.ByteOrder != ByteOrderMark)
+			{
+				return false;
+			}
+			if(OutHeader.Width <= 0 || OutHeader.Height <= 0 || OutHeader.LandmarkCount < 0 || OutHeader.ComponentCount < 0)
+			{
+				return false;
+			}
+			return OutHeader.PayloadSize == Size - sizeof(CookedHeader)
+				&& OutHeader.PayloadSize == SizesOf(OutHeader.Width, OutHeader.Height, OutHeader.LandmarkCount).Total();
+		}
+	}
+
+	uint64_t HashBytes(const void* Data, size_t Size)
+	{
+		const uint8_t* Bytes = static_cast<const uint8_t*>(Data);
+		uint64_t Hash = 14695981039346656037ull;
+		for(size_t i = 0; i < Size; i++)
+		{
+			Hash = (Hash ^ Bytes[i]) * 1099511628211ull;
+		}
+		return Hash;
+	}
+
+	bool CookMap(const char* SourceText, size_t SourceLength, const CookOptions& Options, std::vector<uint8_t>& OutBytes)
+	{
+		GridMap Grid;
+		if(!ParseMap(SourceText, SourceLength, Grid))
+		{
+			return false;
+		}
+		ConnectedComponents Components;
+		Components.Build(Grid);
+		LandmarkTable Landmarks;
+		Landmarks.Build(Grid, Options.LandmarkCount, Options.Selection, Options.LandmarkSeed);
+
+		CookedHeader Header = {};
+		std::memcpy(Header.Magic, CookedMagic, sizeof(CookedMagic));
+		Header.Version = CookedMapVersion;
+		Header.ByteOrder = ByteOrderMark;
+		Header.Width = Grid.GetWidth();
+		Header.Height = Grid.GetHeight();
+		Header.SourceHash = HashBytes(SourceText, SourceLength);
+		Header.SourceSize = SourceLength;
+		Header.ComponentCount = Components.GetComponentCount();
+		//Build clamps the count to the number of open cells
+		Header.LandmarkCount = Landmarks.GetCount();
+		Header.Selection = static_cast<uint32_t>(Options.Selection);
+		Header.LandmarkSeed = Options.LandmarkSeed;
+
+		OutBytes.assign(sizeof(CookedHeader), 0);
+
+		std::vector<uint8_t> Terrain(SizesOf(Header.Width, Header.Height, 0).Terrain, 0);
+		size_t Bit = 0;
+		for(int Y = 0; Y < Header.Height; Y++)
+		{
+			for(int X = 0; X < Header.Width; X++, Bit += 2)
+			{
+				const uint8_t Type = static_cast<uint8_t>(Grid.GetTerrain(Grid.ToIndex(X, Y)));
+				Terrain[Bit / 8] |= static_cast<uint8_t>(Type << (Bit % 8));
+			}
+		}
+		AppendSection(OutBytes, Terrain.data(), Terrain.size());
+		AppendSection(OutBytes, Components.GetIds().data(), Components.GetIds().size() * sizeof(int32_t));
+		if(Header.LandmarkCount > 0)
+		{
+			AppendSection(OutBytes, Landmarks.GetLandmarks().data(), Landmarks.GetLandmarks().size() * sizeof(int32_t));
+			AppendSection(OutBytes, Landmarks.GetForward().data(), Landmarks.GetForward().size() * sizeof(uint16_t));
+			AppendSection(OutBytes, Landmarks.GetBackward().data(), Landmarks.GetBackward().size() * sizeof(uint16_t));
+		}
+
+		Header.PayloadSize = OutBytes.size() - sizeof(CookedHeader);
+		Header.PayloadHash = HashBytes(OutBytes.data() + sizeof(CookedHeader), Header.PayloadSize);
+		std::memcpy(OutBytes.data(), &Header, sizeof(CookedHeader));
+		return true;
+	}
+
+	bool ReadCookedMapInfo(const uint8_t* Data, size_t Size, CookedMapInfo& OutInfo)
+	{
+		CookedHeader Header;
+		if(!ReadHeader(Data, Size, Header))
+		{
+			return false;
+		}
+		OutInfo.Version = Header.Version;
+		OutInfo.Width = Header.Width;
+		OutInfo.Height = Header.Height;
+		OutInfo.SourceHash = Header.SourceHash;
+		OutInfo.SourceSize = Header.SourceSize;
+		OutInfo.ComponentCount = Header.ComponentCount;
+		OutInfo.LandmarkCount = Header.LandmarkCount;
+		OutInfo.Selection = static_cast<LandmarkSelection>(Header.Selection);
+		OutInfo.LandmarkSeed = Header.LandmarkSeed;
+		return true;
+	}
+
+	bool IsCookedMapCurrent(const CookedMapInfo& Info, const void* SourceData, size_t SourceSize)
+	{
+		return Info.SourceSize == SourceSize && Info.SourceHash == HashBytes(SourceData, SourceSize);
+	}
+
+	bool ReadCookedMap(const uint8_t* Data, size_t Size, GridMap& OutGrid, ConnectedComponents* OutComponents, LandmarkTable* OutLandmarks)
+	{
+		CookedHeader Header;
+		if(!ReadHeader(Data, Size, Header) || HashBytes(Data + sizeof(CookedHeader), Header.PayloadSize) != Header.PayloadHash)
+		{
+			return false;
+		}
+
+		const SectionSizes Sizes = SizesOf(Header.Width, Header.Height, Header.LandmarkCount);
+		const uint8_t* Section = Data + sizeof(CookedHeader);
+
+		OutGrid.Init(Header.Width, Header.Height);
+		size_t Bit = 0;
+		for(int Y = 0; Y < Header.Height; Y++)
+		{
+			for(int X = 0; X < Header.Width; X++, Bit += 2)
+			{
+				const uint8_t Type = (Section[Bit / 8] >> (Bit % 8)) & 3;
+				OutGrid.SetTerrain(X, Y, static_cast<TerrainType>(Type));
+			}
+		}
+		Section += Align8(Sizes.Terrain);
+
+		//The sections are 8 byte aligned and the caller's buffer is at least that aligned when it comes from a file or mapping
+		if(OutComponents)
+		{
+			OutComponents->Assign(OutGrid, reinterpret_cast<const int32_t*>(Section), Header.ComponentCount);
+		}
+		Section += Align8(Sizes.Components);
+
+		if(OutLandmarks)
+		{
+			if(Header.LandmarkCount > 0)
+			{
+				const int32_t* Cells = reinterpret_cast<const int32_t*>(Section);
+				const uint16_t* Forward = reinterpret_cast<const uint16_t*>(Section + Align8(Sizes.Landmarks));
+				const uint16_t* Backward = reinterpret_cast<const uint16_t*>(Section + Align8(Sizes.Landmarks) + Align8(Sizes.Table));
+				OutLandmarks->Assign(OutGrid, Header.LandmarkCount, Cells, Forward, Backward);
+			}
+			else
+			{
+				OutLandmarks->Build(OutGrid, 0);
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ConnectedComponents.h"
+#include "GridMap.h"
+#include "LandmarkTable.h"
+
+namespace Pathfinding
+{
+	/*
+	 * Cooked maps are a binary copy of a MovingAI .map plus the data that would otherwise be rebuilt on every load.
+	 * Layout (native byte order, checked on load), every section starts on an 8 byte boundary so a mapped file
+	 * can be read in place:
+	 *   CookedHeader
+	 *   terrain, 2 bits per map cell (the TerrainType value), row by row without the padding border
+	 *   component ids, one int32 per GridMap cell
+	 *   if LandmarkCount > 0: the landmark cells (int32), then the forward and backward distance tables (uint16),
+	 *   laid out like LandmarkTable
+	 * The header keeps a hash of the source .map so a stale cooked file is never used.
+	 */
+	constexpr uint32_t CookedMapVersion = 1;
+
+	struct CookOptions
+	{
+		int LandmarkCount = 0;
+		LandmarkSelection Selection = LandmarkSelection::Farthest;
+		uint32_t LandmarkSeed = 3094;
+	};
+
+	//The header fields, readable without decoding the rest of the file
+	struct CookedMapInfo
+	{
+		uint32_t Version = 0;
+		int Width = 0;
+		int Height = 0;
+		uint64_t SourceHash = 0;
+		uint64_t SourceSize = 0;
+		int ComponentCount = 0;
+		int LandmarkCount = 0;
+		LandmarkSelection Selection = LandmarkSelection::Farthest;
+		uint32_t LandmarkSeed = 0;
+	};
+
+	//64 bit FNV-1a, used for the source and payload checksums
+	uint64_t HashBytes(const void* Data, size_t Size);
+
+	//Parses SourceText as a .map, computes the components and landmarks and writes the cooked file to OutBytes
+	bool CookMap(const char* SourceText, size_t SourceLength, const CookOptions& Options, std::vector<uint8_t>& OutBytes);
+
+	//Checks the magic, version, byte order and section sizes. The payload checksum is only checked by ReadCookedMap
+	bool ReadCookedMapInfo(const uint8_t* Data, size_t Size, CookedMapInfo& OutInfo);
+	//True when the cooked map was made from exactly these .map bytes
+	bool IsCookedMapCurrent(const CookedMapInfo& Info, const void* SourceData, size_t SourceSize);
+
+	/*
+	 * Decodes the terrain into OutGrid, and the stored components and landmarks into the optional outputs.
+	 * OutLandmarks is built empty when the map was cooked without landmarks. Returns false on any mismatch or a bad checksum.
+	 */
+	bool ReadCookedMap(const uint8_t* Data, size_t Size, GridMap& OutGrid, ConnectedComponents* OutComponents = nullptr, LandmarkTable* OutLandmarks = nullptr);
+}
@@ -0,0 +1,225 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CooperativePlanner.h"
+
+#include <algorithm>
+
+namespace Pathfinding
+{
+	void CooperativePlanner::SetGrid(const GridMap* InGrid)
+	{
+		Grid = InGrid;
+		Reservations.Init(Grid ? Grid->Num() : 0);
+		OwnFields.SetGrid(Grid);
+		Goals.clear();
+		GoalCost.clear();
+		G.clear();
+	}
+
+	void CooperativePlanner::SetWindow(int Steps)
+	{
+		Window = std::max(1, Steps);
+		//The search state is sized for the window, it is allocated again on the next plan
+		G.clear();
+	}
+
+	void CooperativePlanner::Begin(const std::vector<int32_t>& InGoals)
+	{
+		Goals = InGoals;
+		GoalFieldCache& Fields = SharedFields ? *SharedFields : OwnFields;
+		GoalCost.resize(Goals.size());
+		for(size_t Ship = 0; Ship < Goals.size(); Ship++)
+		{
+			GoalCost[Ship] = Fields.GetField(Goals[Ship]);
+		}
+		Reservations.Clear();
+	}
+
+	void CooperativePlanner::PlanWindows(int32_t Time, const std::vector<int32_t>& Positions, std::vector<std::vector<int32_t>>& OutPaths)
+	{
+		const int ShipCount = static_cast<int>(Goals.size());
+		OutPaths.resize(ShipCount);
+		if(!Grid || static_cast<int>(Positions.size()) != ShipCount)
+		{
+			return;
+		}
+
+		const size_t StateCount = static_cast<size_t>(Window + 1) * Grid->Num();
+		if(G.size() != StateCount)
+		{
+			G.assign(StateCount, 0);
+			Parent.assign(StateCount, NoCell);
+			Generation.assign(StateCount, 0);
+			OpenList.Resize(static_cast<int>(StateCount));
+			SearchGeneration = 0;
+		}
+
+		//Every window is planned from scratch, the steps already taken no longer matter
+		Reservations.Clear();
+		//Each ship holds its cell for this step and the next, so a ship planned late can always wait for one step
+		for(int Ship = 0; Ship < ShipCount; Ship++)
+		{
+			if(Positions[Ship] == Goals[Ship])
+			{
+				Reservations.Park(Positions[Ship], Time, Ship);
+			}
+			else
+			{
+				Reservations.Reserve(Positions[Ship], Time, Ship);
+				Reservations.Reserve(Positions[Ship], Time + 1, Ship);
+			}
+		}
+
+		for(int i = 0; i < ShipCount; i++)
+		{
+			const int Ship = static_cast<int>((i + Stats.Rounds) % ShipCount);
+			std::vector<int32_t>& Path = OutPaths[Ship];
+			Path.clear();
+			if(Positions[Ship] == Goals[Ship])
+			{
+				continue;
+			}
+
+			const int32_t LastState = SearchWindow(Ship, Positions[Ship], Time);
+			Stats.Searches++;
+			if(LastState == NoCell)
+			{
+				//Boxed in for now, wait where it is and try again with the next window
+				Stats.Failed++;
+				for(int Step = 1; Step <= Window; Step++)
+				{
+					Reservations.Reserve(Positions[Ship], Time + Step, Ship);
+					Path.push_back(Positions[Ship]);
+				}
+				continue;
+			}
+			ReservePlan(Ship, Positions[Ship], Time, LastState, Path);
+			AppendRoute(Ship, Path);
+		}
+
+		Stats.Rounds++;
+		Stats.PeakReservations = std::max(Stats.PeakReservations, Reservations.GetCount());
+	}
+
+	size_t CooperativePlanner::GetMemoryBytes() const
+	{
+		size_t Bytes = Reservations.GetMemoryBytes() + OpenList.GetMemoryBytes();
+		Bytes += G.capacity() * sizeof(int32_t) + Parent.capacity() * sizeof(int32_t) + Generation.capacity() * sizeof(uint32_t);
+		//Fields held from a shared cache are counted there
+		if(!SharedFields)
+		{
+			Bytes += OwnFields.GetMemoryBytes();
+		}
+		return Bytes;
+	}
+
+	int32_t CooperativePlanner::SearchWindow(int Ship, int32_t Start, int32_t Time)
+	{
+		const std::vector<int32_t>& Cost = *GoalCost[Ship];
+		if(Cost[Start] == UnreachableCost)
+		{
+			return NoCell;
+		}
+
+		if(++SearchGeneration == 0)
+		{
+			std::fill(Generation.begin(), Generation.end(), 0);
+			SearchGeneration = 1;
+		}
+		OpenList.Clear();
+
+		const int Num = Grid->Num();
+		const int Pitch = Grid->GetPitch();
+		const int32_t Goal = Goals[Ship];
+		G[Start] = 0;
+		Parent[Start] = NoCell;
+		Generation[Start] = SearchGeneration;
+		OpenList.Push(Start, Cost[Start], Cost[Start]);
+
+		while(!OpenList.IsEmpty())
+		{
+			const int32_t State = OpenList.Pop();
+			const int Step = State / Num;
+			const int32_t Cell = State - Step * Num;
+			Stats.Expansions++;
+
+			//The exact cost to the goal is the heuristic, so the first end of the window popped is the best one
+			if(Step == Window || (Cell == Goal && Reservations.CanPark(Goal, Time + Step, Ship)))
+			{
+				return State;
+			}
+
+			const int32_t Moves[5] = {Cell, Cell + 1, Cell - 1, Cell + Pitch, Cell - Pitch};
+			for(const int32_t Next : Moves)
+			{
+				if(!Grid->IsPassable(Next) || Cost[Next] == UnreachableCost || !Reservations.CanMove(Cell, Next, Time + Step, Ship))
+				{
+					continue;
+				}
+
+				const int32_t NewG = G[State] + (Next == Cell ? WaitStepCost : Grid->GetTravelCost(Next));
+				const int32_t NextState = (Step + 1) * Num + Next;
+				if(Generation[NextState] != SearchGeneration)
+				{
+					Generation[NextState] = SearchGeneration;
+					G[NextState] = NewG;
+					Parent[NextState] = State;
+					OpenList.Push(NextState, NewG + Cost[Next], Cost[Next]);
+				}
+				else if(NewG < G[NextState] && OpenList.Contains(NextState))
+				{
+					G[NextState] = NewG;
+					Parent[NextState] = State;
+					OpenList.DecreaseKey(NextState, NewG + Cost[Next]);
+				}
+			}
+		}
+		return NoCell;
+	}
+
+	void CooperativePlanner::ReservePlan(int Ship, int32_t Start, int32_t Time, int32_t LastState, std::vector<int32_t>& OutPath)
+	{
+		const int Num = Grid->Num();
+		const int Steps = LastState / Num;
+		OutPath.resize(Steps);
+		for(int32_t State = LastState; Parent[State] != NoCell; State = Parent[State])
+		{
+			const int Step = State / Num;
+			OutPath[Step - 1] = State - Step * Num;
+			Reservations.Reserve(OutPath[Step - 1], Time + Step, Ship);
+		}
+
+		const int32_t Last = Steps > 0 ? OutPath.back() : Start;
+		if(Last == Goals[Ship] && Reservations.CanPark(Last, Time + Steps, Ship))
+		{
+			Reservations.Park(Last, Time + Steps, Ship);
+		}
+	}
+
+	void CooperativePlanner::AppendRoute(int Ship, std::vector<int32_t>& OutPath) const
+	{
+		if(OutPath.empty())
+		{
+			return;
+		}
+
+		//Walk down the exact cost to the goal, each step goes to the neighbour the cost was counted through
+		const std::vector<int32_t>& Cost = *GoalCost[Ship];
+		const int Pitch = Grid->GetPitch();
+		int32_t Cell = OutPath.back();
+		while(Cell != Goals[Ship] && Cost[Cell] != UnreachableCost)
+		{
+			const int32_t Neighbours[4] = {Cell + 1, Cell - 1, Cell + Pitch, Cell - Pitch};
+			for(const int32_t Neighbour : Neighbours)
+			{
+				if(Grid->IsPassable(Neighbour) && Cost[Neighbour] != UnreachableCost && Cost[Neighbour] + Grid->GetTravelCost(Neighbour) == Cost[Cell])
+				{
+					Cell = Neighbour;
+					break;
+				}
+			}
+			OutPath.push_back(Cell);
+		}
+	}
+}
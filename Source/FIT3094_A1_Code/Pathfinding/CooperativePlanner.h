@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "GoalFieldCache.h"
+#include "GridMap.h"
+#include "NodePriorityQueue.h"
+#include "ReservationTable.h"
+
+namespace Pathfinding
+{
+	struct CooperativeStats
+	{
+		int64_t Rounds = 0;
+		int64_t Searches = 0;
+		int64_t Expansions = 0;
+		//Ships that found no window around the others and were left waiting where they are
+		int64_t Failed = 0;
+		//Largest number of reservations held at once
+		int PeakReservations = 0;
+	};
+
+	/**
+	 * Windowed cooperative A* (WHCA*) for all ships of a level. Every ship plans in space and time for the next
+	 * Window steps around the cells the ships before it reserved, then reserves its own steps, so ships that follow
+	 * their plans never meet in a cell or swap places. Past the window a ship follows its exact cost to the goal
+	 * (a reverse Dijkstra from the goal), and the windows are planned again every Window / 2 steps, each time with
+	 * the priorities rotated so the same ships do not always give way.
+	 * Ships move one cell or wait per step. A move costs the travel cost of the cell entered, waiting costs 1.
+	 */
+	class CooperativePlanner
+	{
+
+	public:
+
+		void SetGrid(const GridMap* InGrid);
+		//Optional, shared with the other planners of the grid. Without one the planner keeps its own fields
+		void SetGoalFields(GoalFieldCache* InFields) { SharedFields = InFields; }
+		void SetWindow(int Steps);
+		int GetWindow() const { return Window; }
+		//Steps the ships follow a plan before the windows are planned again
+		int GetReplanInterval() const { return Window / 2 > 0 ? Window / 2 : 1; }
+
+		//Starts a level, ship i heads for Goals[i]. Takes the cost from every cell to each goal from the goal fields
+		void Begin(const std::vector<int32_t>& InGoals);
+		/*
+		 * Plans the window from step Time for every ship, Positions[i] is where ship i stands at that step.
+		 * OutPaths[i] is the cell of ship i for each step after Time, repeats mean waiting, up to its goal.
+		 * Only the first Window steps are reserved, the rest follows the cheapest route and is replaced by the next call.
+		 */
+		void PlanWindows(int32_t Time, const std::vector<int32_t>& Positions, std::vector<std::vector<int32_t>>& OutPaths);
+
+		int32_t GetGoalCost(int Ship, int32_t Cell) const { return (*GoalCost[Ship])[Cell]; }
+		const ReservationTable& GetReservations() const { return Reservations; }
+		const CooperativeStats& GetStats() const { return Stats; }
+		void ResetStats() { Stats = CooperativeStats(); }
+		size_t GetMemoryBytes() const;
+
+	private:
+
+		const GridMap* Grid = nullptr;
+		int Window = 32;
+		ReservationTable Reservations;
+
+		std::vector<int32_t> Goals;
+		GoalFieldCache* SharedFields = nullptr;
+		GoalFieldCache OwnFields;
+		//Exact cost from every cell to each ship's goal, see BuildGoalCost
+		std::vector<GoalField> GoalCost;
+
+		//Search state per (step in the window, cell), a state is Step * Grid->Num() + Cell
+		std::vector<int32_t> G;
+		std::vector<int32_t> Parent;
+		std::vector<uint32_t> Generation;
+		uint32_t SearchGeneration = 0;
+		NodePriorityQueue OpenList;
+		std::vector<int32_t> Order;
+		CooperativeStats Stats;
+
+		//Space-time A* for one ship from Start at step Time, returns the last state of the window plan or NoCell
+		int32_t SearchWindow(int Ship, int32_t Start, int32_t Time);
+		void ReservePlan(int Ship, int32_t Start, int32_t Time, int32_t LastState, std::vector<int32_t>& OutPath);
+		void AppendRoute(int Ship, std::vector<int32_t>& OutPath) const;
+	};
+}
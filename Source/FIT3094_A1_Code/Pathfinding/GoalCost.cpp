@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GoalCost.h"
+
+#include "NodePriorityQueue.h"
+
+namespace Pathfinding
+{
+	void BuildGoalCost(const GridMap& Grid, int32_t Goal, std::vector<int32_t>& OutCost)
+	{
+		OutCost.assign(Grid.Num(), UnreachableCost);
+		if(Goal == NoCell || !Grid.IsPassable(Goal))
+		{
+			return;
+		}
+
+		//A move from a neighbour into Current pays the cost of Current
+		NodePriorityQueue Queue;
+		Queue.Resize(Grid.Num());
+		const int Pitch = Grid.GetPitch();
+		OutCost[Goal] = 0;
+		Queue.Push(Goal, 0, 0);
+		while(!Queue.IsEmpty())
+		{
+			const int32_t Current = Queue.Pop();
+			const int32_t NewCost = OutCost[Current] + Grid.GetTravelCost(Current);
+			const int32_t Neighbours[4] = {Current + 1, Current - 1, Current + Pitch, Current - Pitch};
+			for(const int32_t Neighbour : Neighbours)
+			{
+				if(!Grid.IsPassable(Neighbour) || NewCost >= OutCost[Neighbour])
+				{
+					continue;
+				}
+				if(OutCost[Neighbour] == UnreachableCost)
+				{
+					Queue.Push(Neighbour, NewCost, 0);
+				}
+				else
+				{
+					Queue.DecreaseKey(Neighbour, NewCost);
+				}
+				OutCost[Neighbour] = NewCost;
+			}
+		}
+	}
+}
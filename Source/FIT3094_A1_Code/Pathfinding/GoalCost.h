@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "GridMap.h"
+
+namespace Pathfinding
+{
+	//Cost to a goal from a cell that cannot reach it
+	constexpr int32_t UnreachableCost = INT32_MAX;
+	//What the multi ship planners charge a ship for waiting a step in place, a move costs the cell entered
+	constexpr int32_t WaitStepCost = 1;
+
+	/*
+	 * Reverse Dijkstra from Goal: OutCost[Cell] is the exact cost of the cheapest path from Cell to Goal, paying the
+	 * travel cost of every cell entered like the planners do, or UnreachableCost. Used as a perfect heuristic by the
+	 * multi ship planners, and a path follows it downhill.
+	 */
+	void BuildGoalCost(const GridMap& Grid, int32_t Goal, std::vector<int32_t>& OutCost);
+}
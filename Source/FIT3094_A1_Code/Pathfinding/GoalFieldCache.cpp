@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GoalFieldCache.h"
+
+#include <algorithm>
+
+namespace Pathfinding
+{
+	void GoalFieldCache::SetGrid(const GridMap* InGrid)
+	{
+		Grid = InGrid;
+		Entries.clear();
+		TerrainVersion = Grid ? Grid->GetTerrainVersion() : 0;
+		const int Num = Grid ? Grid->Num() : 0;
+		G.assign(Num, 0);
+		Parent.assign(Num, NoCell);
+		Generation.assign(Num, 0);
+		OpenList.Resize(Num);
+		SearchGeneration = 0;
+	}
+
+	void GoalFieldCache::SetCapacity(int Fields)
+	{
+		Capacity = std::max(1, Fields);
+		while(static_cast<int>(Entries.size()) > Capacity)
+		{
+			const auto Oldest = std::min_element(Entries.begin(), Entries.end(), [](const Entry& First, const Entry& Second)
+			{
+				return First.LastUse < Second.LastUse;
+			});
+			Entries.erase(Oldest);
+			Stats.Evictions++;
+		}
+	}
+
+	GoalField GoalFieldCache::GetField(int32_t Goal)
+	{
+		if(TerrainVersion != Grid->GetTerrainVersion())
+		{
+			Entries.clear();
+			TerrainVersion = Grid->GetTerrainVersion();
+		}
+		//Capacity is a few dozen fields at most, a scan is cheaper than keeping a map in step with the LRU order
+		for(Entry& Cached : Entries)
+		{
+			if(Cached.Goal == Goal)
+			{
+				Cached.LastUse = ++Clock;
+				Stats.Hits++;
+				return Cached.Field;
+			}
+		}
+
+		Stats.Misses++;
+		std::shared_ptr<std::vector<int32_t>> Field = std::make_shared<std::vector<int32_t>>();
+		BuildGoalCost(*Grid, Goal, *Field);
+
+		Entry* Slot = nullptr;
+		if(static_cast<int>(Entries.size()) < Capacity)
+		{
+			Entries.emplace_back();
+			Slot = &Entries.back();
+		}
+		else
+		{
+			Slot = &*std::min_element(Entries.begin(), Entries.end(), [](const Entry& First, const Entry& Second)
+			{
+				return First.LastUse < Second.LastUse;
+			});
+			Stats.Evictions++;
+		}
+		Slot->Goal = Goal;
+		Slot->LastUse = ++Clock;
+		Slot->Field = std::move(Field);
+		return Slot->Field;
+	}
+
+	bool GoalFieldCache::Contains(int32_t Goal) const
+	{
+		return std::any_of(Entries.begin(), Entries.end(), [Goal](const Entry& Cached) { return Cached.Goal == Goal; });
+	}
+
+	bool GoalFieldCache::FindPath(int32_t Start, int32_t Goal, std::vector<int32_t>& OutPath, const SearchOptions& Options)
+	{
+		OutPath.clear();
+		LastExpansions = 0;
+		LastPathCost = 0;
+		if(!Grid || Start == NoCell || Goal == NoCell)
+		{
+			return false;
+		}
+		if(Start == Goal)
+		{
+			return true;
+		}
+
+		//Hold on to the field, the search below must not lose it to an eviction
+		const GoalField Field = GetField(Goal);
+		const std::vector<int32_t>& Cost = *Field;
+		if(Cost[Start] == UnreachableCost
+			|| (Options.bAvoidOccupied && FreeWater && FreeWater->GetGrid() == Grid && FreeWater->BlocksOccupied() && !FreeWater->CanReach(Start, Goal)))
+		{
+			Stats.Unreachable++;
+			return false;
+		}
+
+		if(Descend(Start, Goal, Cost, Options, OutPath))
+		{
+			Stats.Descents++;
+			LastPathCost = Cost[Start];
+			return true;
+		}
+		Stats.LocalSearches++;
+		return SearchAround(Start, Goal, Cost, Options, OutPath);
+	}
+
+	size_t GoalFieldCache::GetMemoryBytes() const
+	{
+		size_t Bytes = Entries.capacity() * sizeof(Entry) + OpenList.GetMemoryBytes();
+		Bytes += (G.capacity() + Parent.capacity()) * sizeof(int32_t) + Generation.capacity() * sizeof(uint32_t);
+		for(const Entry& Cached : Entries)
+		{
+			Bytes += Cached.Field->capacity() * sizeof(int32_t);
+		}
+		return Bytes;
+	}
+
+	bool GoalFieldCache::Descend(int32_t Start, int32_t Goal, const std::vector<int32_t>& Cost, const SearchOptions& Options, std::vector<int32_t>& OutPath) const
+	{
+		//Each step goes to the neighbour the cost was counted through
+		const int Pitch = Grid->GetPitch();
+		int32_t Cell = Start;
+		while(Cell != Goal)
+		{
+			const int32_t Neighbours[4] = {Cell + 1, Cell - 1, Cell + Pitch, Cell - Pitch};
+			int32_t Next = NoCell;
+			for(const int32_t Neighbour : Neighbours)
+			{
+				if(Grid->IsPassable(Neighbour) && Cost[Neighbour] != UnreachableCost && Cost[Neighbour] + Grid->GetTravelCost(Neighbour) == Cost[Cell])
+				{
+					Next = Neighbour;
+					break;
+				}
+			}
+			if(Next == NoCell || !CanEnter(Next, Options))
+			{
+				OutPath.clear();
+				return false;
+			}
+			OutPath.push_back(Next);
+			Cell = Next;
+		}
+		return true;
+	}
+
+	bool GoalFieldCache::SearchAround(int32_t Start, int32_t Goal, const std::vector<int32_t>& Cost, const SearchOptions& Options, std::vector<int32_t>& OutPath)
+	{
+		if(++SearchGeneration == 0)
+		{
+			std::fill(Generation.begin(), Generation.end(), 0);
+			SearchGeneration = 1;
+		}
+		OpenList.Clear();
+
+		//Blocking cells only removes moves, so the field stays a consistent heuristic and a popped cell is final
+		const int Pitch = Grid->GetPitch();
+		G[Start] = 0;
+		Parent[Start] = NoCell;
+		Generation[Start] = SearchGeneration;
+		OpenList.Push(Start, Cost[Start], Cost[Start]);
+		while(!OpenList.IsEmpty())
+		{
+			const int32_t Current = OpenList.Pop();
+			LastExpansions++;
+			if(Current == Goal)
+			{
+				break;
+			}
+
+			const int32_t Neighbours[4] = {Current + 1, Current - 1, Current + Pitch, Current - Pitch};
+			for(const int32_t Neighbour : Neighbours)
+			{
+				if(!CanEnter(Neighbour, Options) || Cost[Neighbour] == UnreachableCost)
+				{
+					continue;
+				}
+				const int32_t NewG = G[Current] + Grid->GetTravelCost(Neighbour);
+				if(Generation[Neighbour] != SearchGeneration)
+				{
+					Generation[Neighbour] = SearchGeneration;
+					G[Neighbour] = NewG;
+					Parent[Neighbour] = Current;
+					OpenList.Push(Neighbour, NewG + Cost[Neighbour], Cost[Neighbour]);
+				}
+				else if(NewG < G[Neighbour] && OpenList.Contains(Neighbour))
+				{
+					G[Neighbour] = NewG;
+					Parent[Neighbour] = Current;
+					OpenList.DecreaseKey(Neighbour, NewG + Cost[Neighbour]);
+				}
+			}
+		}
+		Stats.LocalExpansions += LastExpansions;
+
+		if(Generation[Goal] != SearchGeneration || OpenList.Contains(Goal))
+		{
+			return false;
+		}
+		LastPathCost = G[Goal];
+		//Count the steps first so the path can be written back to front without reversing
+		int Length = 0;
+		for(int32_t Cell = Goal; Cell != Start; Cell = Parent[Cell])
+		{
+			Length++;
+		}
+		OutPath.resize(Length);
+		for(int32_t Cell = Goal; Cell != Start; Cell = Parent[Cell])
+		{
+			OutPath[--Length] = Cell;
+		}
+		return true;
+	}
+}
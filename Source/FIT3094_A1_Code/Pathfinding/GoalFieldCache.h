@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ConnectedComponents.h"
+#include "GoalCost.h"
+#include "GridMap.h"
+#include "NodePriorityQueue.h"
+#include "OccupancyGrid.h"
+#include "PathPlanner.h"
+
+namespace Pathfinding
+{
+	//The cost from every cell to one goal (see BuildGoalCost), shared by everyone planning towards that goal
+	using GoalField = std::shared_ptr<const std::vector<int32_t>>;
+
+	struct GoalFieldStats
+	{
+		int64_t Hits = 0;
+		int64_t Misses = 0;
+		int64_t Evictions = 0;
+		//Paths that followed a field downhill without any search
+		int64_t Descents = 0;
+		//Paths that ran into a blocked cell on the way down and were searched around it
+		int64_t LocalSearches = 0;
+		int64_t LocalExpansions = 0;
+		int64_t Unreachable = 0;
+	};
+
+	/**
+	 * Reverse Dijkstra fields keyed by goal cell, built on the first request and kept for the next one, so ships that
+	 * share a goal or replan towards the same goal again only pay for one Dijkstra. At most Capacity fields are kept,
+	 * the least recently used one is dropped to make room. A field handed out stays valid for its holder after that.
+	 * Every field is dropped when the terrain of the grid changes.
+	 *
+	 * A path follows the field downhill from the start, which is an optimal path as long as none of its cells is
+	 * blocked. When one is, an A* with the field as its heuristic runs instead; the heuristic is exact away from the
+	 * blocked cells, so that search only spreads around them. Not thread safe, meant for the game thread.
+	 */
+	class GoalFieldCache
+	{
+
+	public:
+
+		//Drops every field, they belong to the old grid
+		void SetGrid(const GridMap* InGrid);
+		const GridMap* GetGrid() const { return Grid; }
+		void SetCapacity(int Fields);
+		int GetCapacity() const { return Capacity; }
+		//Optional, must block occupied cells. Rejects goals the other ships wall off before a search with bAvoidOccupied
+		void SetComponents(const ConnectedComponents* InFreeWater) { FreeWater = InFreeWater; }
+		//Optional, the cells bAvoidOccupied keeps out of
+		void SetOccupancy(const OccupancyGrid* InOccupancy) { Occupancy = InOccupancy; }
+
+		GoalField GetField(int32_t Goal);
+		bool Contains(int32_t Goal) const;
+
+		/*
+		 * Same contract as PathPlanner::FindPath: on success OutPath holds the cells to walk through, starting with
+		 * the first move and ending with Goal. AvoidCell and bAvoidOccupied are the cells that must not be entered.
+		 */
+		bool FindPath(int32_t Start, int32_t Goal, std::vector<int32_t>& OutPath, const SearchOptions& Options = SearchOptions());
+
+		int64_t GetLastExpansions() const { return LastExpansions; }
+		int32_t GetLastPathCost() const { return LastPathCost; }
+		int GetFieldCount() const { return static_cast<int>(Entries.size()); }
+		const GoalFieldStats& GetStats() const { return Stats; }
+		void ResetStats() { Stats = GoalFieldStats(); }
+		size_t GetMemoryBytes() const;
+
+	private:
+
+		struct Entry
+		{
+			int32_t Goal = NoCell;
+			uint64_t LastUse = 0;
+			GoalField Field;
+		};
+
+		const GridMap* Grid = nullptr;
+		const ConnectedComponents* FreeWater = nullptr;
+		const OccupancyGrid* Occupancy = nullptr;
+		int Capacity = 64;
+		std::vector<Entry> Entries;
+		uint64_t Clock = 0;
+		//Terrain version the fields were built for, they are all dropped once the grid's version moves on
+		uint32_t TerrainVersion = 0;
+
+		//Local search scratch, only valid for cells whose Generation matches the running search
+		std::vector<int32_t> G;
+		std::vector<int32_t> Parent;
+		std::vector<uint32_t> Generation;
+		NodePriorityQueue OpenList;
+		uint32_t SearchGeneration = 0;
+
+		int64_t LastExpansions = 0;
+		int32_t LastPathCost = 0;
+		GoalFieldStats Stats;
+
+		bool CanEnter(int32_t Cell, const SearchOptions& Options) const
+		{
+			return Grid->IsPassable(Cell) && Cell != Options.AvoidCell && !(Options.bAvoidOccupied && Occupancy && Occupancy->IsHeld(Cell));
+		}
+		//Walks downhill from Start, false as soon as the next cell cannot be entered
+		bool Descend(int32_t Start, int32_t Goal, const std::vector<int32_t>& Cost, const SearchOptions& Options, std::vector<int32_t>& OutPath) const;
+		bool SearchAround(int32_t Start, int32_t Goal, const std::vector<int32_t>& Cost, const SearchOptions& Options, std::vector<int32_t>& OutPath);
+	};
+}
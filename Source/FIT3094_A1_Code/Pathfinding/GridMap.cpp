@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridMap.h"
+
+namespace Pathfinding
+{
+	void GridMap::Init(int InWidth, int InHeight)
+	{
+		Width = InWidth;
+		Height = InHeight;
+		Pitch = Width + 2;
+
+		const int CellCount = Pitch * (Height + 2);
+
+		//Everything starts as land so the padding border is never entered
+		TerrainCost.assign(CellCount, BlockedCost);
+		TerrainVersion++;
+	}
+
+	void GridMap::SetTerrain(int X, int Y, TerrainType Type)
+	{
+		TerrainCost[ToIndex(X, Y)] = static_cast<uint8_t>(TravelCostOf(Type));
+		TerrainVersion++;
+	}
+
+	void GridMap::SetTerrainRow(int Y, const char* Tiles, int Count)
+	{
+		const uint8_t DeepCost = static_cast<uint8_t>(TravelCostOf(TerrainType::DeepWater));
+		const uint8_t ShallowCost = static_cast<uint8_t>(TravelCostOf(TerrainType::ShallowWater));
+		uint8_t* Row = TerrainCost.data() + ToIndex(0, Y);
+		TerrainVersion++;
+		for(int X = 0; X < Count; X++)
+		{
+			//Same mapping as TerrainFromChar, without the switch per cell
+			const char Tile = Tiles[X];
+			Row[X] = Tile == '.' ? DeepCost : (Tile == 'T' ? ShallowCost : static_cast<uint8_t>(BlockedCost));
+		}
+	}
+
+	TerrainType GridMap::TerrainFromChar(char Tile)
+	{
+		switch(Tile)
+		{
+		case '.':
+			return TerrainType::DeepWater;
+		case 'T':
+			return TerrainType::ShallowWater;
+		default:
+			return TerrainType::Land;
+		}
+	}
+
+	int GridMap::TravelCostOf(TerrainType Type)
+	{
+		switch(Type)
+		{
+		case TerrainType::Land:
+			return BlockedCost;
+		case TerrainType::DeepWater:
+			return 3;
+		default:
+			return 1;
+		}
+	}
+
+	TerrainType GridMap::TerrainFromCost(int Cost)
+	{
+		if(Cost >= BlockedCost)
+		{
+			return TerrainType::Land;
+		}
+		return Cost == TravelCostOf(TerrainType::DeepWater) ? TerrainType::DeepWater : TerrainType::ShallowWater;
+	}
+}
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pathfinding
+{
+	//Returned in place of a cell index or a ship id when there is none
+	constexpr int32_t NoCell = -1;
+	constexpr int32_t NoShip = -1;
+
+	enum class TerrainType : uint8_t
+	{
+		DeepWater,
+		Land,
+		ShallowWater
+	};
+
+	/**
+	 * Terrain of a map, one contiguous array of travel costs. Which ship holds which cell is kept in an OccupancyGrid.
+	 * A cell is addressed by a single index. Rows are padded with a one cell border of land,
+	 * so the four neighbours of any map cell are Index +/- 1 and Index +/- Pitch without bounds checks.
+	 * Plain C++ so it can be used both by the game module and by the headless tools.
+	 */
+	class GridMap
+	{
+
+	public:
+
+		//Cells with this travel cost or more are never entered by a ship
+		static constexpr int BlockedCost = 100;
+
+		void Init(int InWidth, int InHeight);
+		void SetTerrain(int X, int Y, TerrainType Type);
+		//Decodes Count map characters into row Y in one pass, the loaders call this instead of SetTerrain per cell
+		void SetTerrainRow(int Y, const char* Tiles, int Count);
+
+		static TerrainType TerrainFromChar(char Tile);
+		static int TravelCostOf(TerrainType Type);
+		static TerrainType TerrainFromCost(int Cost);
+
+		int GetWidth() const { return Width; }
+		int GetHeight() const { return Height; }
+		int GetPitch() const { return Pitch; }
+		int Num() const { return static_cast<int>(TerrainCost.size()); }
+		size_t GetMemoryBytes() const { return TerrainCost.capacity() * sizeof(uint8_t); }
+
+		int32_t ToIndex(int X, int Y) const { return (Y + 1) * Pitch + X + 1; }
+		int GetX(int32_t Index) const { return Index % Pitch - 1; }
+		int GetY(int32_t Index) const { return Index / Pitch - 1; }
+		bool IsInside(int X, int Y) const { return X >= 0 && X < Width && Y >= 0 && Y < Height; }
+
+		int GetTravelCost(int32_t Index) const { return TerrainCost[Index]; }
+		bool IsPassable(int32_t Index) const { return TerrainCost[Index] < BlockedCost; }
+		TerrainType GetTerrain(int32_t Index) const { return TerrainFromCost(TerrainCost[Index]); }
+		//Changes whenever Init or a SetTerrain call rewrites the terrain, so results computed from it can be checked for staleness
+		uint32_t GetTerrainVersion() const { return TerrainVersion; }
+
+	private:
+
+		int Width = 0;
+		int Height = 0;
+		int Pitch = 0;
+		uint32_t TerrainVersion = 0;
+
+		//Travel cost of every cell, written once when the map is loaded
+		std::vector<uint8_t> TerrainCost;
+	};
+}
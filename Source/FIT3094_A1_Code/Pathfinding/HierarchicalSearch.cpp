@@ -0,0 +1,238 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HierarchicalSearch.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace Pathfinding
+{
+	void HierarchicalSearch::SetGraph(const SectorGraph* InGraph)
+	{
+		Graph = InGraph;
+		Stride = 0;
+	}
+
+	bool HierarchicalSearch::FindPath(int32_t Start, int32_t Goal, std::vector<int32_t>& OutPath)
+	{
+		OutPath.clear();
+		LastExpansions = 0;
+		LastPathCost = 0;
+		LastNodesTouched = 0;
+		LastOpenPeak = 0;
+		LastDecreaseKeys = 0;
+		LastHeuristicEvaluations = 0;
+		if(!Graph || Start == NoCell || Goal == NoCell)
+		{
+			return false;
+		}
+		if(Start == Goal)
+		{
+			return true;
+		}
+
+		//The graph may have been rebuilt with another sector size or map since the last query
+		const GridMap* Grid = Graph->GetGrid();
+		if(Stride != Graph->GetNodeStride() || static_cast<int>(G.size()) != Graph->GetSectorCount() * Graph->GetNodeStride() + 2)
+		{
+			Stride = Graph->GetNodeStride();
+			StartId = Graph->GetSectorCount() * Stride;
+			GoalId = StartId + 1;
+			G.assign(StartId + 2, 0);
+			Parent.assign(StartId + 2, -1);
+			Generation.assign(StartId + 2, 0);
+			Closed.assign(StartId + 2, 0);
+			OpenList.Resize(StartId + 2);
+			StartFlood.Init(Grid, Graph->GetSectorSize());
+			GoalFlood.Init(Grid, Graph->GetSectorSize());
+			SearchGeneration = 0;
+		}
+
+		OpenList.Clear();
+		SearchGeneration++;
+		if(SearchGeneration == 0)
+		{
+			Generation.assign(Generation.size(), 0);
+			SearchGeneration = 1;
+		}
+		StartFlood.ResetCounters();
+		GoalFlood.ResetCounters();
+
+		//Connect the start and goal to the entrances of their own sectors
+		const int StartSector = Graph->SectorOf(Start);
+		const int GoalSector = Graph->SectorOf(Goal);
+		const std::vector<int32_t>& StartNodes = Graph->GetNodes(StartSector);
+		const std::vector<int32_t>& GoalNodes = Graph->GetNodes(GoalSector);
+
+		StartFlood.Flood(Start, false);
+		StartCost.resize(StartNodes.size());
+		for(size_t i = 0; i < StartNodes.size(); i++)
+		{
+			StartCost[i] = StartFlood.GetCost(StartNodes[i]);
+		}
+		GoalFlood.Flood(Goal, true);
+		GoalCost.resize(GoalNodes.size());
+		for(size_t i = 0; i < GoalNodes.size(); i++)
+		{
+			GoalCost[i] = GoalFlood.GetCost(GoalNodes[i]);
+		}
+		//Both in one sector: the path may not need to leave it at all
+		const int32_t DirectCost = StartSector == GoalSector ? StartFlood.GetCost(Goal) : SectorGraph::Unreachable;
+
+		Generation[StartId] = SearchGeneration;
+		Closed[StartId] = 0;
+		G[StartId] = 0;
+		Parent[StartId] = -1;
+		OpenList.Push(StartId, 0, 0);
+		LastNodesTouched++;
+
+		bool bFound = false;
+		while(!OpenList.IsEmpty())
+		{
+			LastOpenPeak = std::max<int64_t>(LastOpenPeak, OpenList.Num());
+			const int32_t Current = OpenList.Pop();
+			Closed[Current] = 1;
+			if(Current == GoalId)
+			{
+				bFound = true;
+				break;
+			}
+			LastExpansions++;
+
+			if(Current == StartId)
+			{
+				for(size_t i = 0; i < StartNodes.size(); i++)
+				{
+					if(StartCost[i] != SectorGraph::Unreachable)
+					{
+						Relax(StartSector * Stride + static_cast<int32_t>(i), Current, StartCost[i], StartNodes[i], Goal);
+					}
+				}
+				if(DirectCost != SectorGraph::Unreachable)
+				{
+					Relax(GoalId, Current, DirectCost, Goal, Goal);
+				}
+				continue;
+			}
+
+			const int Sector = Current / Stride;
+			const int Node = Current % Stride;
+			const std::vector<int32_t>& Nodes = Graph->GetNodes(Sector);
+
+			//Across the sector
+			for(size_t i = 0; i < Nodes.size(); i++)
+			{
+				const int32_t Cost = Graph->GetIntraCost(Sector, Node, static_cast<int>(i));
+				if(Cost != SectorGraph::Unreachable && static_cast<int>(i) != Node)
+				{
+					Relax(Sector * Stride + static_cast<int32_t>(i), Current, G[Current] + Cost, Nodes[i], Goal);
+				}
+			}
+			if(Sector == GoalSector && GoalCost[Node] != SectorGraph::Unreachable)
+			{
+				Relax(GoalId, Current, G[Current] + GoalCost[Node], Goal, Goal);
+			}
+
+			//Over the border into the neighbouring sector
+			for(const int32_t* Link = Graph->LinksBegin(Sector, Node); Link != Graph->LinksEnd(Sector, Node); Link++)
+			{
+				const int NextSector = Graph->SectorOf(*Link);
+				const int NextNode = Graph->FindNode(NextSector, *Link);
+				if(NextNode >= 0)
+				{
+					Relax(NextSector * Stride + NextNode, Current, G[Current] + Grid->GetTravelCost(*Link), *Link, Goal);
+				}
+			}
+		}
+
+		if(bFound)
+		{
+			AbstractPath.clear();
+			for(int32_t Id = GoalId; Id != -1; Id = Parent[Id])
+			{
+				AbstractPath.push_back(Id);
+			}
+			std::reverse(AbstractPath.begin(), AbstractPath.end());
+
+			//Border crossings are single moves, the rest comes from the stored routes and the two floods
+			for(size_t i = 1; i < AbstractPath.size(); i++)
+			{
+				const int32_t From = AbstractPath[i - 1];
+				const int32_t To = AbstractPath[i];
+				if(From == StartId)
+				{
+					StartFlood.AppendPath(CellOf(To, Start, Goal), OutPath);
+				}
+				else if(To == GoalId)
+				{
+					GoalFlood.AppendPath(CellOf(From, Start, Goal), OutPath);
+				}
+				else if(From / Stride != To / Stride)
+				{
+					OutPath.push_back(CellOf(To, Start, Goal));
+				}
+				else
+				{
+					Graph->AppendRoute(From / Stride, From % Stride, To % Stride, OutPath);
+				}
+			}
+			LastPathCost = G[GoalId];
+		}
+
+		LastExpansions += StartFlood.GetExpansions() + GoalFlood.GetExpansions();
+		LastNodesTouched += StartFlood.GetNodesTouched() + GoalFlood.GetNodesTouched();
+		LastDecreaseKeys += StartFlood.GetDecreaseKeys() + GoalFlood.GetDecreaseKeys();
+		LastOpenPeak = std::max({LastOpenPeak, StartFlood.GetOpenPeak(), GoalFlood.GetOpenPeak()});
+		return bFound;
+	}
+
+	size_t HierarchicalSearch::GetMemoryBytes() const
+	{
+		return G.capacity() * sizeof(int32_t) + Parent.capacity() * sizeof(int32_t) + Generation.capacity() * sizeof(uint32_t)
+			+ Closed.capacity() * sizeof(uint8_t) + OpenList.GetMemoryBytes() + StartFlood.GetMemoryBytes() + GoalFlood.GetMemoryBytes()
+			+ (StartCost.capacity() + GoalCost.capacity() + AbstractPath.capacity()) * sizeof(int32_t);
+	}
+
+	int32_t HierarchicalSearch::CellOf(int32_t Id, int32_t Start, int32_t Goal) const
+	{
+		if(Id == StartId)
+		{
+			return Start;
+		}
+		if(Id == GoalId)
+		{
+			return Goal;
+		}
+		return Graph->GetNodes(Id / Stride)[Id % Stride];
+	}
+
+	void HierarchicalSearch::Relax(int32_t Id, int32_t From, int32_t NewG, int32_t Cell, int32_t Goal)
+	{
+		const bool bSeen = Generation[Id] == SearchGeneration;
+		if(bSeen && (Closed[Id] || NewG >= G[Id]))
+		{
+			return;
+		}
+
+		G[Id] = NewG;
+		Parent[Id] = From;
+		if(!bSeen)
+		{
+			//Manhattan distance never overestimates because the cheapest cell costs 1
+			const GridMap* Grid = Graph->GetGrid();
+			const int H = std::abs(Grid->GetX(Goal) - Grid->GetX(Cell)) + std::abs(Grid->GetY(Goal) - Grid->GetY(Cell));
+			Generation[Id] = SearchGeneration;
+			Closed[Id] = 0;
+			OpenList.Push(Id, NewG + H, H);
+			LastNodesTouched++;
+			LastHeuristicEvaluations++;
+		}
+		else
+		{
+			//H does not change for the same goal, the one the node was pushed with is reused
+			OpenList.DecreaseKey(Id, NewG + OpenList.GetH(Id));
+			LastDecreaseKeys++;
+		}
+	}
+}
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "NodePriorityQueue.h"
+#include "SectorGraph.h"
+#include "SectorSearch.h"
+
+namespace Pathfinding
+{
+	/**
+	 * HPA* query over a shared SectorGraph, one per planner so queries can run on several threads.
+	 * The start and goal are connected to the entrances of their sectors, the abstract graph is searched with A*
+	 * and the abstract path is refined into cells from the routes stored in the graph and the two floods.
+	 * Paths are optimal within each sector but can be slightly longer than the flat optimum.
+	 */
+	class HierarchicalSearch
+	{
+
+	public:
+
+		void SetGraph(const SectorGraph* InGraph);
+		const SectorGraph* GetGraph() const { return Graph; }
+
+		//Same contract as PathPlanner::FindPath
+		bool FindPath(int32_t Start, int32_t Goal, std::vector<int32_t>& OutPath);
+
+		//Abstract nodes expanded plus cells expanded by the sector searches
+		int64_t GetLastExpansions() const { return LastExpansions; }
+		int32_t GetLastPathCost() const { return LastPathCost; }
+		//Abstract nodes plus flood cells, same meaning as the PlannerStats fields of a flat search
+		int64_t GetLastNodesTouched() const { return LastNodesTouched; }
+		int64_t GetLastOpenPeak() const { return LastOpenPeak; }
+		int64_t GetLastDecreaseKeys() const { return LastDecreaseKeys; }
+		//Only the abstract search has a heuristic, the floods are Dijkstra
+		int64_t GetLastHeuristicEvaluations() const { return LastHeuristicEvaluations; }
+		//Per query scratch, the shared SectorGraph is not included
+		size_t GetMemoryBytes() const;
+
+	private:
+
+		const SectorGraph* Graph = nullptr;
+		//Costs and routes from the start and to the goal inside their sectors
+		SectorSearch StartFlood;
+		SectorSearch GoalFlood;
+
+		//Abstract node ids are Sector * Stride + Local, the start and goal come after the last sector
+		int Stride = 0;
+		int32_t StartId = 0;
+		int32_t GoalId = 0;
+
+		std::vector<int32_t> G;
+		std::vector<int32_t> Parent;
+		std::vector<uint32_t> Generation;
+		std::vector<uint8_t> Closed;
+		NodePriorityQueue OpenList;
+		uint32_t SearchGeneration = 0;
+
+		//Cost from the start to every entrance of its sector, and from every entrance of the goal's sector to the goal
+		std::vector<int32_t> StartCost;
+		std::vector<int32_t> GoalCost;
+		std::vector<int32_t> AbstractPath;
+
+		int64_t LastExpansions = 0;
+		int32_t LastPathCost = 0;
+		int64_t LastNodesTouched = 0;
+		int64_t LastOpenPeak = 0;
+		int64_t LastDecreaseKeys = 0;
+		int64_t LastHeuristicEvaluations = 0;
+
+		int32_t CellOf(int32_t Id, int32_t Start, int32_t Goal) const;
+		void Relax(int32_t Id, int32_t From, int32_t NewG, int32_t Cell, int32_t Goal);
+	};
+}
@@ -0,0 +1,296 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "IncrementalPlanner.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace Pathfinding
+{
+	void IncrementalPlanner::SetGrid(const GridMap* InGrid)
+	{
+		Grid = InGrid;
+		Reset();
+	}
+
+	void IncrementalPlanner::Reset()
+	{
+		const int CellCount = Grid ? Grid->Num() : 0;
+		G.assign(CellCount, Infinite);
+		Rhs.assign(CellCount, Infinite);
+		OpenList.Resize(CellCount);
+		BlockedState.assign(CellCount, 0);
+		Blocked.clear();
+		Goal = NoCell;
+		LastStart = NoCell;
+		KeyModifier = 0;
+	}
+
+	size_t IncrementalPlanner::GetMemoryBytes() const
+	{
+		return (G.capacity() + Rhs.capacity() + Blocked.capacity() + Changed.capacity()) * sizeof(int32_t) + BlockedState.capacity() + OpenList.GetMemoryBytes();
+	}
+
+	int32_t IncrementalPlanner::Heuristic(int32_t From, int32_t To) const
+	{
+		//Every cell costs at least 1, and the landmark bound is consistent as well, so the larger one keeps D* Lite exact
+		const int32_t Manhattan = std::abs(Grid->GetX(To) - Grid->GetX(From)) + std::abs(Grid->GetY(To) - Grid->GetY(From));
+		if(Landmarks && Landmarks->GetCount() > 0 && Landmarks->GetGrid() == Grid)
+		{
+			return std::max(Manhattan, static_cast<int32_t>(Landmarks->GetLowerBound(From, To)));
+		}
+		return Manhattan;
+	}
+
+	bool IncrementalPlanner::FindPath(int32_t Start, int32_t InGoal, const std::vector<int32_t>& BlockedCells, std::vector<int32_t>& OutPath)
+	{
+		OutPath.clear();
+		LastExpansions = 0;
+		LastPathCost = 0;
+		LastChangedCells = 0;
+
+		if(!Grid || Start == NoCell || InGoal == NoCell)
+		{
+			return false;
+		}
+		if(static_cast<int>(G.size()) != Grid->Num())
+		{
+			Reset();
+		}
+
+		if(InGoal != Goal)
+		{
+			//A new goal invalidates every cost, start over
+			ApplyBlocked(BlockedCells);
+			Initialise(Start, InGoal);
+		}
+		else
+		{
+			//The queued keys were made for LastStart, raise the bar instead of re-keying the queue
+			KeyModifier = Add(KeyModifier, Heuristic(LastStart, Start));
+			LastStart = Start;
+			ApplyBlocked(BlockedCells);
+			LastChangedCells = static_cast<int>(Changed.size());
+			for(const int32_t Cell : Changed)
+			{
+				//Entering Cell got cheaper or dearer, which only changes the successor costs of its neighbours
+				const int32_t Neighbours[4] = {Cell + 1, Cell - 1, Cell + Grid->GetPitch(), Cell - Grid->GetPitch()};
+				for(const int32_t Neighbour : Neighbours)
+				{
+					if(Neighbour != Goal)
+					{
+						Rhs[Neighbour] = LowestSuccessorCost(Neighbour);
+					}
+					UpdateCell(Neighbour, Start);
+				}
+			}
+		}
+
+		ComputeShortestPath(Start);
+		return BuildPath(Start, OutPath);
+	}
+
+	void IncrementalPlanner::Initialise(int32_t Start, int32_t InGoal)
+	{
+		std::fill(G.begin(), G.end(), Infinite);
+		std::fill(Rhs.begin(), Rhs.end(), Infinite);
+		OpenList.Clear();
+		Goal = InGoal;
+		LastStart = Start;
+		KeyModifier = 0;
+		Rhs[Goal] = 0;
+		OpenList.Push(Goal, Heuristic(Start, Goal), 0);
+	}
+
+	void IncrementalPlanner::ApplyBlocked(const std::vector<int32_t>& BlockedCells)
+	{
+		//2 marks the cells blocked now, so cells in both lists never count as changed
+		Changed.clear();
+		for(const int32_t Cell : BlockedCells)
+		{
+			if(!(BlockedState[Cell] & 2))
+			{
+				if(!(BlockedState[Cell] & 1))
+				{
+					Changed.push_back(Cell);
+				}
+				BlockedState[Cell] |= 2;
+			}
+		}
+		for(const int32_t Cell : Blocked)
+		{
+			if(BlockedState[Cell] == 1)
+			{
+				Changed.push_back(Cell);
+			}
+		}
+		for(const int32_t Cell : Blocked)
+		{
+			BlockedState[Cell] = 0;
+		}
+
+		Blocked.clear();
+		for(const int32_t Cell : BlockedCells)
+		{
+			if(BlockedState[Cell] != 1)
+			{
+				BlockedState[Cell] = 1;
+				Blocked.push_back(Cell);
+			}
+		}
+	}
+
+	int32_t IncrementalPlanner::LowestSuccessorCost(int32_t Cell) const
+	{
+		if(!Grid->IsPassable(Cell))
+		{
+			//Land keeps no cost, so it never feeds a path
+			return Infinite;
+		}
+		const int Pitch = Grid->GetPitch();
+		const int32_t Neighbours[4] = {Cell + 1, Cell - 1, Cell + Pitch, Cell - Pitch};
+		int32_t Lowest = Infinite;
+		for(const int32_t Neighbour : Neighbours)
+		{
+			Lowest = std::min(Lowest, Add(EnterCost(Neighbour), G[Neighbour]));
+		}
+		return Lowest;
+	}
+
+	void IncrementalPlanner::UpdateCell(int32_t Cell, int32_t Start)
+	{
+		const bool bQueued = OpenList.Contains(Cell);
+		if(G[Cell] != Rhs[Cell])
+		{
+			const int32_t Best = std::min(G[Cell], Rhs[Cell]);
+			const int32_t Key = Add(Add(Best, Heuristic(Start, Cell)), KeyModifier);
+			if(bQueued)
+			{
+				OpenList.Update(Cell, Key, Best);
+			}
+			else
+			{
+				OpenList.Push(Cell, Key, Best);
+			}
+		}
+		else if(bQueued)
+		{
+			OpenList.Remove(Cell);
+		}
+	}
+
+	void IncrementalPlanner::ComputeShortestPath(int32_t Start)
+	{
+		const int Pitch = Grid->GetPitch();
+		auto KeyOf = [this, Start](int32_t Cell, int32_t& OutSecond)
+		{
+			OutSecond = std::min(G[Cell], Rhs[Cell]);
+			return Add(Add(OutSecond, Heuristic(Start, Cell)), KeyModifier);
+		};
+		auto IsLess = [](int32_t FirstA, int32_t SecondA, int32_t FirstB, int32_t SecondB)
+		{
+			return FirstA < FirstB || (FirstA == FirstB && SecondA < SecondB);
+		};
+
+		while(!OpenList.IsEmpty())
+		{
+			int32_t StartSecond;
+			const int32_t StartFirst = KeyOf(Start, StartSecond);
+			if(!IsLess(OpenList.TopF(), OpenList.TopH(), StartFirst, StartSecond) && Rhs[Start] <= G[Start])
+			{
+				break;
+			}
+
+			const int32_t Current = OpenList.Top();
+			const int32_t OldFirst = OpenList.TopF();
+			const int32_t OldSecond = OpenList.TopH();
+			int32_t NewSecond;
+			const int32_t NewFirst = KeyOf(Current, NewSecond);
+			const int32_t Neighbours[4] = {Current + 1, Current - 1, Current + Pitch, Current - Pitch};
+
+			if(IsLess(OldFirst, OldSecond, NewFirst, NewSecond))
+			{
+				//Queued before the start moved, put it back with its current key
+				OpenList.Update(Current, NewFirst, NewSecond);
+				continue;
+			}
+
+			LastExpansions++;
+			if(G[Current] > Rhs[Current])
+			{
+				//Got cheaper, pass it on to the cells that can move into Current
+				G[Current] = Rhs[Current];
+				OpenList.Remove(Current);
+				const int32_t ThroughCurrent = Add(EnterCost(Current), G[Current]);
+				for(const int32_t Neighbour : Neighbours)
+				{
+					if(Neighbour != Goal && Grid->IsPassable(Neighbour) && ThroughCurrent < Rhs[Neighbour])
+					{
+						Rhs[Neighbour] = ThroughCurrent;
+						UpdateCell(Neighbour, Start);
+					}
+				}
+			}
+			else
+			{
+				//Got dearer, everything that relied on the old cost has to look again
+				const int32_t OldThroughCurrent = Add(EnterCost(Current), G[Current]);
+				G[Current] = Infinite;
+				if(Current != Goal)
+				{
+					Rhs[Current] = LowestSuccessorCost(Current);
+				}
+				UpdateCell(Current, Start);
+				for(const int32_t Neighbour : Neighbours)
+				{
+					if(Neighbour != Goal && Rhs[Neighbour] == OldThroughCurrent && OldThroughCurrent != Infinite)
+					{
+						Rhs[Neighbour] = LowestSuccessorCost(Neighbour);
+						UpdateCell(Neighbour, Start);
+					}
+				}
+			}
+		}
+	}
+
+	bool IncrementalPlanner::BuildPath(int32_t Start, std::vector<int32_t>& OutPath)
+	{
+		if(Start == Goal)
+		{
+			return true;
+		}
+		if(Rhs[Start] == Infinite)
+		{
+			return false;
+		}
+
+		//Follow the cheapest successor, every step lowers the remaining cost so the walk ends at the goal
+		const int Pitch = Grid->GetPitch();
+		int32_t Current = Start;
+		while(Current != Goal && static_cast<int>(OutPath.size()) < Grid->Num())
+		{
+			const int32_t Neighbours[4] = {Current + 1, Current - 1, Current + Pitch, Current - Pitch};
+			int32_t Next = NoCell;
+			int32_t NextCost = Infinite;
+			for(const int32_t Neighbour : Neighbours)
+			{
+				const int32_t Cost = Add(EnterCost(Neighbour), G[Neighbour]);
+				if(Cost < NextCost)
+				{
+					Next = Neighbour;
+					NextCost = Cost;
+				}
+			}
+			if(Next == NoCell)
+			{
+				OutPath.clear();
+				return false;
+			}
+			LastPathCost += EnterCost(Next);
+			OutPath.push_back(Next);
+			Current = Next;
+		}
+		return Current == Goal;
+	}
+}
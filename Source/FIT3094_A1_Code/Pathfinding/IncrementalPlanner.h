@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "GridMap.h"
+#include "LandmarkTable.h"
+#include "NodePriorityQueue.h"
+
+namespace Pathfinding
+{
+	/**
+	 * D* Lite for one ship. The search runs backwards from the goal and is kept between calls, so when the ship asks
+	 * again with the same goal only the cells whose cost to the goal changed are repaired: the ones around cells that
+	 * were blocked or freed since the last call, and what depends on them.
+	 * Moves cost the travel cost of the cell entered like PathPlanner, blocked cells are never entered.
+	 * Paths are optimal (the heuristic is not weighted). Only valid while the terrain stays the same, call Reset
+	 * after GridMap::SetTerrain.
+	 */
+	class IncrementalPlanner
+	{
+
+	public:
+
+		void SetGrid(const GridMap* InGrid);
+		//Optional and shared, tightens the heuristic like in PathPlanner
+		void SetLandmarks(const LandmarkTable* InLandmarks) { Landmarks = InLandmarks; }
+		void Reset();
+
+		/*
+		 * Plan from Start to Goal around BlockedCells (any order, repeats are fine). The first call for a goal is a full
+		 * search, later ones with the same goal reuse it. OutPath is like PathPlanner::FindPath, from the first move to Goal.
+		 */
+		bool FindPath(int32_t Start, int32_t Goal, const std::vector<int32_t>& BlockedCells, std::vector<int32_t>& OutPath);
+
+		int32_t GetGoal() const { return Goal; }
+		int64_t GetLastExpansions() const { return LastExpansions; }
+		int32_t GetLastPathCost() const { return LastPathCost; }
+		//Cells whose blocked state changed since the previous call and were repaired
+		int GetLastChangedCells() const { return LastChangedCells; }
+		size_t GetMemoryBytes() const;
+
+	private:
+
+		static constexpr int32_t Infinite = INT32_MAX;
+
+		const GridMap* Grid = nullptr;
+		const LandmarkTable* Landmarks = nullptr;
+
+		int32_t Goal = NoCell;
+		int32_t LastStart = NoCell;
+		//Grows by the heuristic distance the start moved, so the keys already queued stay lower bounds
+		int32_t KeyModifier = 0;
+
+		//Cost to the goal as last expanded, and as seen from the successors
+		std::vector<int32_t> G;
+		std::vector<int32_t> Rhs;
+		NodePriorityQueue OpenList;
+
+		//1 for the cells treated as blocked by the previous call, listed in Blocked
+		std::vector<uint8_t> BlockedState;
+		std::vector<int32_t> Blocked;
+		std::vector<int32_t> Changed;
+
+		int64_t LastExpansions = 0;
+		int32_t LastPathCost = 0;
+		int LastChangedCells = 0;
+
+		static int32_t Add(int32_t A, int32_t B) { return A == Infinite || B == Infinite ? Infinite : A + B; }
+		//Cost of moving into Cell
+		int32_t EnterCost(int32_t Cell) const { return Grid->IsPassable(Cell) && !(BlockedState[Cell] & 1) ? Grid->GetTravelCost(Cell) : Infinite; }
+		int32_t Heuristic(int32_t From, int32_t To) const;
+
+		void Initialise(int32_t Start, int32_t InGoal);
+		void ApplyBlocked(const std::vector<int32_t>& BlockedCells);
+		int32_t LowestSuccessorCost(int32_t Cell) const;
+		void UpdateCell(int32_t Cell, int32_t Start);
+		void ComputeShortestPath(int32_t Start);
+		bool BuildPath(int32_t Start, std::vector<int32_t>& OutPath);
+	};
+}
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "JumpTable.h"
+
+namespace Pathfinding
+{
+	void JumpTable::Build(const GridMap& InGrid)
+	{
+		Grid = &InGrid;
+		for(std::vector<int16_t>& Table : Distance)
+		{
+			Table.assign(Grid->Num(), 0);
+		}
+
+		//Horizontal jumps look at the vertical scans of every cell they pass, so those are built first
+		const int Pitch = Grid->GetPitch();
+		BuildVertical(Down, Pitch);
+		BuildVertical(Up, -Pitch);
+		BuildHorizontal(Right, 1);
+		BuildHorizontal(Left, -1);
+	}
+
+	void JumpTable::BuildVertical(Direction Dir, int Step)
+	{
+		std::vector<int16_t>& Table = Distance[Dir];
+		const int Count = Grid->Num();
+
+		//Walk against the jump direction so the cell ahead is always finished
+		for(int i = 0; i < Count; i++)
+		{
+			const int32_t Cell = Step > 0 ? Count - 1 - i : i;
+			const int32_t Next = Cell + Step;
+			if(!Grid->IsPassable(Cell) || !Grid->IsPassable(Next))
+			{
+				continue;
+			}
+
+			//Same rules as PathPlanner::Jump: stop where a side cell could not be reached along its own column
+			const int Cost = Grid->GetTravelCost(Next);
+			bool bForced = false;
+			for(const int Side : {1, -1})
+			{
+				const int32_t Behind = Next + Side - Step;
+				bForced = bForced || (Grid->IsPassable(Next + Side) && !(Grid->IsPassable(Behind) && Grid->GetTravelCost(Behind) == Cost));
+			}
+
+			if(bForced || (Grid->IsPassable(Next + Step) && Grid->GetTravelCost(Next + Step) != Cost))
+			{
+				Table[Cell] = 1;
+			}
+			else if(!Grid->IsPassable(Next + Step))
+			{
+				Table[Cell] = -1;
+			}
+			else
+			{
+				Table[Cell] = static_cast<int16_t>(Table[Next] > 0 ? Table[Next] + 1 : Table[Next] - 1);
+			}
+		}
+	}
+
+	void JumpTable::BuildHorizontal(Direction Dir, int Step)
+	{
+		std::vector<int16_t>& Table = Distance[Dir];
+		const int Count = Grid->Num();
+		const int Pitch = Grid->GetPitch();
+
+		for(int i = 0; i < Count; i++)
+		{
+			const int32_t Cell = Step > 0 ? Count - 1 - i : i;
+			const int32_t Next = Cell + Step;
+			if(!Grid->IsPassable(Cell) || !Grid->IsPassable(Next))
+			{
+				continue;
+			}
+
+			//The cell is a jump point if a vertical scan from it changes cost or finds a jump point
+			const int Cost = Grid->GetTravelCost(Next);
+			bool bTurn = false;
+			for(const int Side : {Pitch, -Pitch})
+			{
+				const int32_t SideCell = Next + Side;
+				const Direction SideDir = Side > 0 ? Down : Up;
+				bTurn = bTurn || (Grid->IsPassable(SideCell) && (Grid->GetTravelCost(SideCell) != Cost || Distance[SideDir][Next] > 0));
+			}
+
+			if(bTurn || (Grid->IsPassable(Next + Step) && Grid->GetTravelCost(Next + Step) != Cost))
+			{
+				Table[Cell] = 1;
+			}
+			else if(!Grid->IsPassable(Next + Step))
+			{
+				Table[Cell] = -1;
+			}
+			else
+			{
+				Table[Cell] = static_cast<int16_t>(Table[Next] > 0 ? Table[Next] + 1 : Table[Next] - 1);
+			}
+		}
+	}
+}
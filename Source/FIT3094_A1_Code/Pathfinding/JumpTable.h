@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "GridMap.h"
+
+namespace Pathfinding
+{
+	/**
+	 * Precomputed jump distances for PathPlanner's JumpPoint mode (JPS+).
+	 * For every cell and direction it stores how far the goal independent part of a jump goes:
+	 * a positive value is the distance to the jump point, zero or a negative value is minus the number of cells
+	 * that can be walked before a dead end. The goal check is done by the planner when the table is read.
+	 * Only valid for the terrain it was built from, rebuild it after the GridMap changes.
+	 */
+	class JumpTable
+	{
+
+	public:
+
+		//Same order as the moves +1, -1, +Pitch, -Pitch
+		enum Direction : uint8_t
+		{
+			Right,
+			Left,
+			Down,
+			Up,
+			DirectionCount
+		};
+
+		void Build(const GridMap& InGrid);
+		const GridMap* GetGrid() const { return Grid; }
+
+		int GetDistance(int32_t Cell, Direction Dir) const { return Distance[Dir][Cell]; }
+		size_t GetMemoryBytes() const { return DirectionCount * Distance[0].capacity() * sizeof(int16_t); }
+
+	private:
+
+		const GridMap* Grid = nullptr;
+		std::vector<int16_t> Distance[DirectionCount];
+
+		void BuildVertical(Direction Dir, int Step);
+		void BuildHorizontal(Direction Dir, int Step);
+	};
+}
@@ -0,0 +1,179 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LandmarkTable.h"
+
+#include <algorithm>
+#include <climits>
+#include <random>
+
+#include "NodePriorityQueue.h"
+
+namespace Pathfinding
+{
+	void LandmarkTable::Build(const GridMap& InGrid, int InCount, LandmarkSelection Selection, uint32_t Seed)
+	{
+		Grid = &InGrid;
+		Landmarks.clear();
+
+		std::vector<int32_t> OpenCells;
+		for(int32_t Cell = 0; Cell < Grid->Num(); Cell++)
+		{
+			if(Grid->IsPassable(Cell))
+			{
+				OpenCells.push_back(Cell);
+			}
+		}
+		Count = std::min(std::max(InCount, 0), static_cast<int>(OpenCells.size()));
+		Forward.assign(static_cast<size_t>(Grid->Num()) * Count, Unknown);
+		Backward.assign(static_cast<size_t>(Grid->Num()) * Count, Unknown);
+		if(Count == 0)
+		{
+			return;
+		}
+
+		std::mt19937 Random(Seed);
+		std::vector<int32_t> Cost;
+		//Cost from the nearest landmark so far, only used by Farthest
+		std::vector<int32_t> Nearest(Grid->Num(), INT_MAX);
+
+		for(int i = 0; i < Count; i++)
+		{
+			int32_t Landmark = OpenCells[Random() % OpenCells.size()];
+			if(Selection == LandmarkSelection::Farthest && i > 0)
+			{
+				//Cells no landmark reaches yet count as furthest, so every separate body of water gets one
+				Landmark = OpenCells[0];
+				for(const int32_t Cell : OpenCells)
+				{
+					if(Nearest[Cell] > Nearest[Landmark])
+					{
+						Landmark = Cell;
+					}
+				}
+			}
+			else
+			{
+				while(std::find(Landmarks.begin(), Landmarks.end(), Landmark) != Landmarks.end())
+				{
+					Landmark = OpenCells[Random() % OpenCells.size()];
+				}
+			}
+			Landmarks.push_back(Landmark);
+
+			Flood(Landmark, false, Cost);
+			Store(i, Cost, Forward);
+			for(const int32_t Cell : OpenCells)
+			{
+				Nearest[Cell] = std::min(Nearest[Cell], Cost[Cell]);
+			}
+			Flood(Landmark, true, Cost);
+			Store(i, Cost, Backward);
+		}
+
+		//The first Farthest landmark was random, move it to the far end of the map as well
+		if(Selection == LandmarkSelection::Farthest && Count > 1)
+		{
+			std::fill(Nearest.begin(), Nearest.end(), INT_MAX);
+			for(int i = 1; i < Count; i++)
+			{
+				for(const int32_t Cell : OpenCells)
+				{
+					const uint16_t Value = Forward[static_cast<size_t>(Cell) * Count + i];
+					Nearest[Cell] = std::min(Nearest[Cell], Value == Unknown ? INT_MAX : static_cast<int32_t>(Value));
+				}
+			}
+			int32_t Landmark = OpenCells[0];
+			for(const int32_t Cell : OpenCells)
+			{
+				if(Nearest[Cell] > Nearest[Landmark])
+				{
+					Landmark = Cell;
+				}
+			}
+			Landmarks[0] = Landmark;
+			Flood(Landmark, false, Cost);
+			Store(0, Cost, Forward);
+			Flood(Landmark, true, Cost);
+			Store(0, Cost, Backward);
+		}
+	}
+
+	void LandmarkTable::Assign(const GridMap& InGrid, int InCount, const int32_t* InLandmarks, const uint16_t* InForward, const uint16_t* InBackward)
+	{
+		Grid = &InGrid;
+		Count = InCount;
+		const size_t TableSize = static_cast<size_t>(Grid->Num()) * Count;
+		Landmarks.assign(InLandmarks, InLandmarks + Count);
+		Forward.assign(InForward, InForward + TableSize);
+		Backward.assign(InBackward, InBackward + TableSize);
+	}
+
+	int LandmarkTable::GetLowerBound(int32_t From, int32_t To) const
+	{
+		const uint16_t* ForwardFrom = &Forward[static_cast<size_t>(From) * Count];
+		const uint16_t* ForwardTo = &Forward[static_cast<size_t>(To) * Count];
+		const uint16_t* BackwardFrom = &Backward[static_cast<size_t>(From) * Count];
+		const uint16_t* BackwardTo = &Backward[static_cast<size_t>(To) * Count];
+
+		int Bound = 0;
+		for(int i = 0; i < Count; i++)
+		{
+			//cost(L, To) <= cost(L, From) + cost(From, To)
+			if(ForwardFrom[i] != Unknown && ForwardTo[i] != Unknown)
+			{
+				Bound = std::max(Bound, ForwardTo[i] - ForwardFrom[i]);
+			}
+			//cost(From, L) <= cost(From, To) + cost(To, L)
+			if(BackwardFrom[i] != Unknown && BackwardTo[i] != Unknown)
+			{
+				Bound = std::max(Bound, BackwardFrom[i] - BackwardTo[i]);
+			}
+		}
+		return Bound;
+	}
+
+	void LandmarkTable::Flood(int32_t Source, bool bReverse, std::vector<int32_t>& OutCost) const
+	{
+		OutCost.assign(Grid->Num(), INT_MAX);
+		NodePriorityQueue OpenList;
+		OpenList.Resize(Grid->Num());
+
+		const int Pitch = Grid->GetPitch();
+		OutCost[Source] = 0;
+		OpenList.Push(Source, 0, 0);
+		while(!OpenList.IsEmpty())
+		{
+			const int32_t Current = OpenList.Pop();
+			const int32_t Neighbours[4] = {Current + 1, Current - 1, Current + Pitch, Current - Pitch};
+			for(const int32_t Neighbour : Neighbours)
+			{
+				if(!Grid->IsPassable(Neighbour))
+				{
+					continue;
+				}
+				//Reversed, the move goes from the neighbour into the current cell
+				const int32_t NewCost = OutCost[Current] + Grid->GetTravelCost(bReverse ? Current : Neighbour);
+				if(OutCost[Neighbour] == INT_MAX)
+				{
+					OutCost[Neighbour] = NewCost;
+					OpenList.Push(Neighbour, NewCost, 0);
+				}
+				else if(NewCost < OutCost[Neighbour])
+				{
+					OutCost[Neighbour] = NewCost;
+					OpenList.DecreaseKey(Neighbour, NewCost);
+				}
+			}
+		}
+	}
+
+	void LandmarkTable::Store(int Landmark, const std::vector<int32_t>& Cost, std::vector<uint16_t>& OutTable) const
+	{
+		for(int32_t Cell = 0; Cell < Grid->Num(); Cell++)
+		{
+			//Unreachable cells and costs too large for 16 bits both become Unknown
+			OutTable[static_cast<size_t>(Cell) * Count + Landmark] = Cost[Cell] < Unknown ? static_cast<uint16_t>(Cost[Cell]) : Unknown;
+		}
+	}
+}
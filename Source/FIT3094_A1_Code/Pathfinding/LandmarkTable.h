@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "GridMap.h"
+
+namespace Pathfinding
+{
+	enum class LandmarkSelection : uint8_t
+	{
+		//Each landmark is the cell furthest from the ones picked so far
+		Farthest,
+		//Seeded random open cells
+		Random
+	};
+
+	/**
+	 * Differential heuristic (ALT) for PathPlanner.
+	 * Stores the exact travel cost from every landmark to every cell and from every cell back to it, computed with
+	 * Dijkstra when the map is loaded. Costs are directional (the cell entered is paid), so both directions are kept.
+	 * The triangle inequality then gives a lower bound on the cost between any two cells that never overestimates.
+	 * Distances are uint16, the values that do not fit are treated as unknown and give no bound.
+	 */
+	class LandmarkTable
+	{
+
+	public:
+
+		void Build(const GridMap& InGrid, int InCount, LandmarkSelection Selection = LandmarkSelection::Farthest, uint32_t Seed = 3094);
+		//Takes a table that was built for InGrid earlier, e.g. read back from a cooked map. Each table holds InGrid.Num() * InCount values
+		void Assign(const GridMap& InGrid, int InCount, const int32_t* InLandmarks, const uint16_t* InForward, const uint16_t* InBackward);
+
+		const GridMap* GetGrid() const { return Grid; }
+		int GetCount() const { return Count; }
+		const std::vector<int32_t>& GetLandmarks() const { return Landmarks; }
+		const std::vector<uint16_t>& GetForward() const { return Forward; }
+		const std::vector<uint16_t>& GetBackward() const { return Backward; }
+
+		//Lower bound on the cost of moving From -> To, 0 if no landmark knows both cells
+		int GetLowerBound(int32_t From, int32_t To) const;
+
+		size_t GetMemoryBytes() const { return (Forward.capacity() + Backward.capacity()) * sizeof(uint16_t) + Landmarks.capacity() * sizeof(int32_t); }
+
+	private:
+
+		static constexpr uint16_t Unknown = 0xFFFF;
+
+		const GridMap* Grid = nullptr;
+		int Count = 0;
+		std::vector<int32_t> Landmarks;
+		//Cell * Count + Landmark, so the bounds of one cell are next to each other
+		std::vector<uint16_t> Forward;
+		std::vector<uint16_t> Backward;
+
+		//Full grid Dijkstra from Source, with bReverse the cost from every cell to Source
+		void Flood(int32_t Source, bool bReverse, std::vector<int32_t>& OutCost) const;
+		void Store(int Landmark, const std::vector<int32_t>& Cost, std::vector<uint16_t>& OutTable) const;
+	};
+}
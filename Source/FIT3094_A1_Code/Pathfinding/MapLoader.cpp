@@ -0,0 +1,206 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MapLoader.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace Pathfinding
+{
+	namespace
+	{
+		//A forward only cursor over the loaded text, nothing is copied out of it
+		struct TextCursor
+		{
+			const char* Current;
+			const char* End;
+
+			bool AtEnd() const { return Current >= End; }
+
+			void SkipSpaces()
+			{
+				while(Current < End && (*Current == ' ' || *Current == '\t'))
+				{
+					Current++;
+				}
+			}
+
+			//Moves past the next line break and returns the line without its '\r' or '\n'
+			const char* NextLine(size_t& OutLength)
+			{
+				const char* Line = Current;
+				const char* Break = static_cast<const char*>(std::memchr(Current, '\n', End - Current));
+				const char* LineEnd = Break ? Break : End;
+				Current = Break ? Break + 1 : End;
+				while(LineEnd > Line && LineEnd[-1] == '\r')
+				{
+					LineEnd--;
+				}
+				OutLength = static_cast<size_t>(LineEnd - Line);
+				return Line;
+			}
+
+			//Returns the next run of non blank characters on the current line
+			const char* NextToken(size_t& OutLength)
+			{
+				SkipSpaces();
+				const char* Token = Current;
+				while(Current < End && *Current != ' ' && *Current != '\t' && *Current != '\r' && *Current != '\n')
+				{
+					Current++;
+				}
+				OutLength = static_cast<size_t>(Current - Token);
+				return Token;
+			}
+
+			bool NextInt(int& Out)
+			{
+				SkipSpaces();
+				bool bNegative = false;
+				if(Current < End && *Current == '-')
+				{
+					bNegative = true;
+					Current++;
+				}
+				if(Current >= End || *Current < '0' || *Current > '9')
+				{
+					return false;
+				}
+				int Value = 0;
+				while(Current < End && *Current >= '0' && *Current <= '9')
+				{
+					Value = Value * 10 + (*Current - '0');
+					Current++;
+				}
+				Out = bNegative ? -Value : Value;
+				return true;
+			}
+
+			bool NextDouble(double& Out)
+			{
+				SkipSpaces();
+				//The line ends with '\n' or the end of the buffer, strtod stops at the first character it cannot use
+				char Digits[64];
+				size_t Count = 0;
+				while(Current < End && Count + 1 < sizeof(Digits) && ((*Current >= '0' && *Current <= '9') || *Current == '.' || *Current == '-' || *Current == '+'
+					|| *Current == 'e' || *Current == 'E'))
+				{
+					Digits[Count++] = *Current++;
+				}
+				if(Count == 0)
+				{
+					return false;
+				}
+				Digits[Count] = '\0';
+				Out = std::strtod(Digits, nullptr);
+				return true;
+			}
+
+			void SkipLine()
+			{
+				size_t Unused;
+				NextLine(Unused);
+			}
+		};
+
+		bool TokenIs(const char* Token, size_t Length, const char* Word)
+		{
+			return Length == std::strlen(Word) && std::memcmp(Token, Word, Length) == 0;
+		}
+	}
+
+	bool LoadTextFile(const std::string& Path, std::string& OutText)
+	{
+		std::FILE* File = std::fopen(Path.c_str(), "rb");
+		if(!File)
+		{
+			return false;
+		}
+
+		bool bRead = false;
+		if(std::fseek(File, 0, SEEK_END) == 0)
+		{
+			const long Size = std::ftell(File);
+			if(Size >= 0 && std::fseek(File, 0, SEEK_SET) == 0)
+			{
+				OutText.resize(static_cast<size_t>(Size));
+				bRead = std::fread(&OutText[0], 1, OutText.size(), File) == OutText.size();
+			}
+		}
+		std::fclose(File);
+		return bRead;
+	}
+
+	bool ParseMap(const char* Text, size_t Length, GridMap& OutGrid)
+	{
+		TextCursor Cursor{Text, Text + Length};
+		int Width = 0;
+		int Height = 0;
+
+		while(!Cursor.AtEnd())
+		{
+			size_t KeyLength;
+			const char* Key = Cursor.NextToken(KeyLength);
+			if(TokenIs(Key, KeyLength, "height"))
+			{
+				Cursor.NextInt(Height);
+			}
+			else if(TokenIs(Key, KeyLength, "width"))
+			{
+				Cursor.NextInt(Width);
+			}
+			else if(TokenIs(Key, KeyLength, "map"))
+			{
+				Cursor.SkipLine();
+				break;
+			}
+			Cursor.SkipLine();
+		}
+
+		if(Width <= 0 || Height <= 0)
+		{
+			return false;
+		}
+
+		OutGrid.Init(Width, Height);
+
+		for(int Y = 0; Y < Height && !Cursor.AtEnd(); Y++)
+		{
+			size_t RowLength;
+			const char* Row = Cursor.NextLine(RowLength);
+			OutGrid.SetTerrainRow(Y, Row, RowLength < static_cast<size_t>(Width) ? static_cast<int>(RowLength) : Width);
+		}
+		return true;
+	}
+
+	bool ParseScenario(const char* Text, size_t Length, std::vector<ScenarioEntry>& OutEntries)
+	{
+		TextCursor Cursor{Text, Text + Length};
+		OutEntries.clear();
+
+		while(!Cursor.AtEnd())
+		{
+			ScenarioEntry Entry;
+			size_t NameLength;
+			if(!Cursor.NextInt(Entry.Bucket))
+			{
+				//The version line and blank lines
+				Cursor.SkipLine();
+				continue;
+			}
+
+			const char* Name = Cursor.NextToken(NameLength);
+			Entry.MapNameOffset = static_cast<uint32_t>(Name - Text);
+			Entry.MapNameLength = static_cast<uint32_t>(NameLength);
+			if(NameLength > 0 && Cursor.NextInt(Entry.MapWidth) && Cursor.NextInt(Entry.MapHeight) && Cursor.NextInt(Entry.StartX) && Cursor.NextInt(Entry.StartY)
+				&& Cursor.NextInt(Entry.GoalX) && Cursor.NextInt(Entry.GoalY) && Cursor.NextDouble(Entry.OptimalLength))
+			{
+				OutEntries.push_back(Entry);
+			}
+			Cursor.SkipLine();
+		}
+		return !OutEntries.empty();
+	}
+}
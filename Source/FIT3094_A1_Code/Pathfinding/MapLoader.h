@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "GridMap.h"
+
+namespace Pathfinding
+{
+	//One row of a MovingAI .scen file
+	struct ScenarioEntry
+	{
+		int Bucket = 0;
+		//The map name column as a range of the parsed text, so reading a row never allocates
+		uint32_t MapNameOffset = 0;
+		uint32_t MapNameLength = 0;
+		int MapWidth = 0;
+		int MapHeight = 0;
+		int StartX = 0;
+		int StartY = 0;
+		int GoalX = 0;
+		int GoalY = 0;
+		double OptimalLength = 0;
+	};
+
+	//Reads the whole file with one sized read. OutText keeps its capacity, so reusing it across files does not reallocate
+	bool LoadTextFile(const std::string& Path, std::string& OutText);
+
+	/*
+	 * Parse a MovingAI .map file (type/height/width/map header followed by the rows) into OutGrid.
+	 * The text is walked in place and each row is decoded straight into the grid's cost array.
+	 */
+	bool ParseMap(const char* Text, size_t Length, GridMap& OutGrid);
+	inline bool ParseMap(const std::string& Text, GridMap& OutGrid) { return ParseMap(Text.data(), Text.size(), OutGrid); }
+
+	//Parse a MovingAI .scen file in place, the version line is skipped. OutEntries is cleared but keeps its capacity
+	bool ParseScenario(const char* Text, size_t Length, std::vector<ScenarioEntry>& OutEntries);
+	inline bool ParseScenario(const std::string& Text, std::vector<ScenarioEntry>& OutEntries) { return ParseScenario(Text.data(), Text.size(), OutEntries); }
+}
@@ -0,0 +1,155 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NodePriorityQueue.h"
+
+#include "GridMap.h"
+
+namespace Pathfinding
+{
+	void NodePriorityQueue::Resize(int CellCount)
+	{
+		Heap.clear();
+		HeapIndex.assign(CellCount, NoCell);
+	}
+
+	void NodePriorityQueue::Push(int32_t Cell, int32_t F, int32_t H)
+	{
+		Heap.push_back({F, H, Cell});
+		HeapIndex[Cell] = static_cast<int32_t>(Heap.size()) - 1;
+		SiftUp(HeapIndex[Cell]);
+	}
+
+	int32_t NodePriorityQueue::Pop()
+	{
+		if(Heap.empty())
+		{
+			return NoCell;
+		}
+
+		const int32_t MinCell = Heap[0].Cell;
+		const Entry LastEntry = Heap.back();
+		Heap.pop_back();
+
+		if(!Heap.empty())
+		{
+			Place(LastEntry, 0);
+			SiftDown(0);
+		}
+
+		HeapIndex[MinCell] = NoCell;
+		return MinCell;
+	}
+
+	void NodePriorityQueue::DecreaseKey(int32_t Cell, int32_t F)
+	{
+		if(Contains(Cell))
+		{
+			Heap[HeapIndex[Cell]].F = F;
+			SiftUp(HeapIndex[Cell]);
+		}
+	}
+
+	void NodePriorityQueue::Update(int32_t Cell, int32_t F, int32_t H)
+	{
+		if(Contains(Cell))
+		{
+			const int Index = HeapIndex[Cell];
+			Heap[Index].F = F;
+			Heap[Index].H = H;
+			SiftUp(Index);
+			SiftDown(HeapIndex[Cell]);
+		}
+	}
+
+	void NodePriorityQueue::Remove(int32_t Cell)
+	{
+		if(!Contains(Cell))
+		{
+			return;
+		}
+		const int Index = HeapIndex[Cell];
+		const Entry LastEntry = Heap.back();
+		Heap.pop_back();
+		HeapIndex[Cell] = NoCell;
+		if(Index < static_cast<int>(Heap.size()))
+		{
+			//The last entry fills the hole and may have to move either way
+			Place(LastEntry, Index);
+			SiftUp(Index);
+			SiftDown(HeapIndex[LastEntry.Cell]);
+		}
+	}
+
+	bool NodePriorityQueue::Contains(int32_t Cell) const
+	{
+		const int32_t Index = HeapIndex[Cell];
+		return Index >= 0 && Index < static_cast<int32_t>(Heap.size()) && Heap[Index].Cell == Cell;
+	}
+
+	void NodePriorityQueue::Clear()
+	{
+		//The cells left in the heap keep a stale HeapIndex, Contains rejects it because the slot no longer holds them
+		Heap.clear();
+	}
+
+	bool NodePriorityQueue::IsBetter(const Entry& First, const Entry& Second)
+	{
+		if(First.F != Second.F)
+		{
+			return First.F < Second.F;
+		}
+		return First.H < Second.H;
+	}
+
+	void NodePriorityQueue::SiftUp(int Index)
+	{
+		const Entry Item = Heap[Index];
+
+		while(Index > 0)
+		{
+			const int ParentIndex = (Index - 1) / 2;
+			if(!IsBetter(Item, Heap[ParentIndex]))
+			{
+				break;
+			}
+			Place(Heap[ParentIndex], Index);
+			Index = ParentIndex;
+		}
+
+		Place(Item, Index);
+	}
+
+	void NodePriorityQueue::SiftDown(int Index)
+	{
+		const Entry Item = Heap[Index];
+		const int Count = static_cast<int>(Heap.size());
+
+		while(true)
+		{
+			int ChildIndex = Index * 2 + 1;
+			if(ChildIndex >= Count)
+			{
+				break;
+			}
+			if(ChildIndex + 1 < Count && IsBetter(Heap[ChildIndex + 1], Heap[ChildIndex]))
+			{
+				ChildIndex++;
+			}
+			if(!IsBetter(Heap[ChildIndex], Item))
+			{
+				break;
+			}
+			Place(Heap[ChildIndex], Index);
+			Index = ChildIndex;
+		}
+
+		Place(Item, Index);
+	}
+
+	void NodePriorityQueue::Place(const Entry& Item, int Index)
+	{
+		Heap[Index] = Item;
+		HeapIndex[Item.Cell] = Index;
+	}
+}
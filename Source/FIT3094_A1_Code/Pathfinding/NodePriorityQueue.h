@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pathfinding
+{
+	/**
+	 * Indexed binary min-heap of cell indices used as the open list of the search.
+	 * Every cell remembers its slot in HeapIndex, so membership tests are O(1)
+	 * and a cell whose F value dropped can be moved up in place (decrease-key).
+	 * Cells are ordered by F, ties are broken on the lower H.
+	 */
+	class NodePriorityQueue
+	{
+
+	public:
+
+		void Resize(int CellCount);
+
+		void Push(int32_t Cell, int32_t F, int32_t H);
+		int32_t Pop();
+		void DecreaseKey(int32_t Cell, int32_t F);
+		//Moves a queued cell to its new key in either direction, used by the incremental planner
+		void Update(int32_t Cell, int32_t F, int32_t H);
+		void Remove(int32_t Cell);
+		//Key of the cell Pop would return, the queue must not be empty
+		int32_t Top() const { return Heap[0].Cell; }
+		int32_t TopF() const { return Heap[0].F; }
+		int32_t TopH() const { return Heap[0].H; }
+		//H a queued cell was pushed with, the cell must be in the queue
+		int32_t GetH(int32_t Cell) const { return Heap[HeapIndex[Cell]].H; }
+		bool Contains(int32_t Cell) const;
+		void Clear();
+
+		bool IsEmpty() const { return Heap.empty(); }
+		int Num() const { return static_cast<int>(Heap.size()); }
+		size_t GetMemoryBytes() const { return Heap.capacity() * sizeof(Entry) + HeapIndex.capacity() * sizeof(int32_t); }
+
+	private:
+
+		struct Entry
+		{
+			int32_t F;
+			int32_t H;
+			int32_t Cell;
+		};
+
+		std::vector<Entry> Heap;
+		std::vector<int32_t> HeapIndex;
+
+		static bool IsBetter(const Entry& First, const Entry& Second);
+		void SiftUp(int Index);
+		void SiftDown(int Index);
+		void Place(const Entry& Item, int Index);
+	};
+}
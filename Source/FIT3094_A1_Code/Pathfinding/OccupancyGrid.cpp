@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "OccupancyGrid.h"
+
+namespace Pathfinding
+{
+	void OccupancyGrid::Init(int CellCount)
+	{
+		Holder.assign(CellCount, NoShip);
+		HeldUntil.assign(CellCount, Forever);
+		Ships.clear();
+		HeldCount = 0;
+	}
+
+	void OccupancyGrid::Clear()
+	{
+		//Only the cells the ships hold are touched, not the whole grid
+		for(int32_t Ship = 0; Ship < static_cast<int32_t>(Ships.size()); Ship++)
+		{
+			Remove(Ship);
+		}
+	}
+
+	void OccupancyGrid::Place(int32_t Ship, int32_t Cell)
+	{
+		if(Ship < 0)
+		{
+			return;
+		}
+		if(!IsTracked(Ship))
+		{
+			Ships.resize(Ship + 1);
+		}
+		Remove(Ship);
+		Ships[Ship].Cell = Cell;
+		Hold(Cell, Ship);
+	}
+
+	void OccupancyGrid::BeginMove(int32_t Ship, int32_t To, float LeaveTime)
+	{
+		if(!IsTracked(Ship) || Ships[Ship].Cell == NoCell)
+		{
+			return;
+		}
+		ShipCells& Cells = Ships[Ship];
+		if(Cells.Next != NoCell)
+		{
+			//Set off again before arriving, it is in the cell it was moving into by now
+			Arrive(Ship);
+		}
+		if(Holder[Cells.Cell] == Ship)
+		{
+			HeldUntil[Cells.Cell] = LeaveTime;
+		}
+		if(Holder[To] != NoShip && Holder[To] != Ship && HeldUntil[To] != Forever)
+		{
+			Stats.Followed++;
+		}
+		Cells.Next = To;
+		Hold(To, Ship);
+		Stats.Moves++;
+	}
+
+	void OccupancyGrid::Arrive(int32_t Ship)
+	{
+		if(!IsTracked(Ship) || Ships[Ship].Next == NoCell)
+		{
+			return;
+		}
+		ShipCells& Cells = Ships[Ship];
+		Release(Cells.Cell, Ship);
+		Cells.Cell = Cells.Next;
+		Cells.Next = NoCell;
+	}
+
+	void OccupancyGrid::Remove(int32_t Ship)
+	{
+		if(!IsTracked(Ship))
+		{
+			return;
+		}
+		ShipCells& Cells = Ships[Ship];
+		if(Cells.Cell != NoCell)
+		{
+			Release(Cells.Cell, Ship);
+		}
+		if(Cells.Next != NoCell)
+		{
+			Release(Cells.Next, Ship);
+		}
+		Cells = ShipCells();
+	}
+
+	int32_t OccupancyGrid::FindConflict(int32_t Ship, int32_t To, float CrossTime)
+	{
+		const int32_t From = GetCell(Ship);
+		const int32_t InTheWay = Holder[To];
+		if(InTheWay != NoShip && InTheWay != Ship)
+		{
+			//Straight behind a ship leaving To the gap never closes, so only one turning in behind it has to wait
+			const int32_t Ahead = Ships[InTheWay].Next;
+			const bool bStraightBehind = From != NoCell && Ships[InTheWay].Cell == To && Ahead != NoCell && Ahead - To == To - From;
+			if(!bStraightBehind && HeldUntil[To] > CrossTime)
+			{
+				Stats.Blocked++;
+				return InTheWay;
+			}
+		}
+		//Head on: the other ship took over the cell this one stands on and still stands in To, they meet halfway
+		const int32_t Coming = From != NoCell ? Holder[From] : NoShip;
+		if(Coming != NoShip && Coming != Ship && Ships[Coming].Next == From && Ships[Coming].Cell == To)
+		{
+			Stats.Oncoming++;
+			return Coming;
+		}
+		return NoShip;
+	}
+
+	void OccupancyGrid::GetHeldCells(std::vector<int32_t>& OutCells) const
+	{
+		OutCells.clear();
+		for(int32_t Ship = 0; Ship < static_cast<int32_t>(Ships.size()); Ship++)
+		{
+			const ShipCells& Cells = Ships[Ship];
+			if(Cells.Cell != NoCell && Holder[Cells.Cell] == Ship)
+			{
+				OutCells.push_back(Cells.Cell);
+			}
+			if(Cells.Next != NoCell && Holder[Cells.Next] == Ship)
+			{
+				OutCells.push_back(Cells.Next);
+			}
+		}
+	}
+
+	void OccupancyGrid::Hold(int32_t Cell, int32_t Ship)
+	{
+		HeldCount += Holder[Cell] == NoShip ? 1 : 0;
+		Holder[Cell] = Ship;
+		HeldUntil[Cell] = Forever;
+	}
+
+	void OccupancyGrid::Release(int32_t Cell, int32_t Ship)
+	{
+		if(Holder[Cell] == Ship)
+		{
+			Holder[Cell] = NoShip;
+			HeldUntil[Cell] = Forever;
+			HeldCount--;
+		}
+	}
+}
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "GridMap.h"
+
+namespace Pathfinding
+{
+	struct OccupancyStats
+	{
+		int64_t Moves = 0;
+		//FindConflict answers, split by what was in the way
+		int64_t Blocked = 0;
+		int64_t Oncoming = 0;
+		//Moves into a cell whose previous holder was still leaving it, fine because it is gone before the ship gets in
+		int64_t Followed = 0;
+	};
+
+	/**
+	 * Which ship holds each cell, kept apart from the terrain and from every search's scratch. A standing ship holds
+	 * its cell, a moving one holds the cell it leaves and the one it enters, so each ship holds at most two cells and
+	 * every move writes O(1) entries. A hold carries the time its ship will be clear of the cell: open while the ship
+	 * stands, set once it sets off. A ship may follow another straight through a cell, or turn in behind it once it
+	 * will be clear by the time the ship crosses over; a cell held past then, or a ship coming the other way, is a
+	 * conflict.
+	 *
+	 * Times are in whatever unit the owner moves the ships on, seconds in real time or steps on a step clock.
+	 * Holders are full ship ids, a narrower holder would wrap large fleets around onto other ships or onto NoShip.
+	 */
+	class OccupancyGrid
+	{
+
+	public:
+
+		//Time of a hold whose ship has not set off yet
+		static constexpr float Forever = 3.0e38f;
+
+		void Init(int CellCount);
+		//Releases every cell, keeps the ships' slots
+		void Clear();
+
+		//Ship stands on Cell, at its spawn or parked on its goal. A cell it held before is released
+		void Place(int32_t Ship, int32_t Cell);
+		/*
+		 * Ship sets off from the cell it stands on into To and is clear of the first one at LeaveTime, it holds both
+		 * until Arrive. Takes To over from any other holder, FindConflict says whether that is safe.
+		 */
+		void BeginMove(int32_t Ship, int32_t To, float LeaveTime);
+		//Ship is all the way in the cell it moved into, the one it came from is released
+		void Arrive(int32_t Ship);
+		void Remove(int32_t Ship);
+
+		/*
+		 * The ship that Ship would run into by setting off into To and crossing over at CrossTime: one that holds To
+		 * past then and is not leaving it straight ahead, or one on its way into the cell Ship stands on out of To.
+		 * NoShip when the move is safe.
+		 */
+		int32_t FindConflict(int32_t Ship, int32_t To, float CrossTime);
+
+		int32_t GetHolder(int32_t Cell) const { return Holder[Cell]; }
+		bool IsHeld(int32_t Cell) const { return Holder[Cell] != NoShip; }
+		//When the holder will be clear of the cell, Forever while it is standing there
+		float GetHeldUntil(int32_t Cell) const { return HeldUntil[Cell]; }
+		//The cell the ship stands on or is leaving, and the one it is moving into or NoCell
+		int32_t GetCell(int32_t Ship) const { return IsTracked(Ship) ? Ships[Ship].Cell : NoCell; }
+		int32_t GetNextCell(int32_t Ship) const { return IsTracked(Ship) ? Ships[Ship].Next : NoCell; }
+		bool IsMoving(int32_t Ship) const { return GetNextCell(Ship) != NoCell; }
+
+		//Every held cell in one pass over the ships, two at most per ship, in no particular order
+		void GetHeldCells(std::vector<int32_t>& OutCells) const;
+		int GetHeldCount() const { return HeldCount; }
+
+		const OccupancyStats& GetStats() const { return Stats; }
+		void ResetStats() { Stats = OccupancyStats(); }
+		size_t GetMemoryBytes() const { return Holder.capacity() * sizeof(int32_t) + HeldUntil.capacity() * sizeof(float) + Ships.capacity() * sizeof(ShipCells); }
+
+	private:
+
+		struct ShipCells
+		{
+			int32_t Cell = NoCell;
+			int32_t Next = NoCell;
+		};
+
+		std::vector<int32_t> Holder;
+		std::vector<float> HeldUntil;
+		std::vector<ShipCells> Ships;
+		int HeldCount = 0;
+		OccupancyStats Stats;
+
+		bool IsTracked(int32_t Ship) const { return Ship >= 0 && Ship < static_cast<int32_t>(Ships.size()); }
+		void Hold(int32_t Cell, int32_t Ship);
+		//Only frees the cell while Ship is still its holder, another ship may have taken it over since
+		void Release(int32_t Cell, int32_t Ship);
+	};
+}
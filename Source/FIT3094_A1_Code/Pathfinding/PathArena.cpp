@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathArena.h"
+
+#include <algorithm>
+
+namespace Pathfinding
+{
+	void PathArena::SetBlockCells(int32_t Cells)
+	{
+		BlockCells = std::max<int32_t>(1, Cells);
+	}
+
+	PathSpan PathArena::Allocate(int32_t Length)
+	{
+		PathSpan Span;
+		if(Length <= 0)
+		{
+			return Span;
+		}
+
+		//Blocks kept from before the last reset are used again in order, one too small for this span is skipped
+		while(Current < Blocks.size() && Blocks[Current].Size - Blocks[Current].Used < Length)
+		{
+			Current++;
+		}
+		if(Current == Blocks.size())
+		{
+			Block NewBlock;
+			NewBlock.Size = std::max(BlockCells, Length);
+			NewBlock.Cells.reset(new int32_t[NewBlock.Size]);
+			Blocks.push_back(std::move(NewBlock));
+			Stats.BlockAllocations++;
+		}
+
+		Block& Target = Blocks[Current];
+		Span.Cells = Target.Cells.get() + Target.Used;
+		Span.Length = Length;
+		Target.Used += Length;
+		UsedCells += Length;
+		Stats.Allocations++;
+		Stats.Cells += Length;
+		Stats.PeakBytes = std::max(Stats.PeakBytes, GetUsedBytes());
+		return Span;
+	}
+
+	void PathArena::Reset()
+	{
+		for(Block& Kept : Blocks)
+		{
+			Kept.Used = 0;
+		}
+		Current = 0;
+		UsedCells = 0;
+	}
+
+	void PathArena::Release()
+	{
+		Blocks.clear();
+		Current = 0;
+		UsedCells = 0;
+	}
+
+	size_t PathArena::GetReservedBytes() const
+	{
+		size_t Cells = 0;
+		for(const Block& Kept : Blocks)
+		{
+			Cells += Kept.Size;
+		}
+		return Cells * sizeof(int32_t);
+	}
+
+	void PathArena::ResetStats()
+	{
+		Stats = PathArenaStats();
+		Stats.PeakBytes = GetUsedBytes();
+	}
+}
@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Pathfinding
+{
+	//Cells of a path kept in a PathArena, only valid until the arena is reset
+	struct PathSpan
+	{
+		int32_t* Cells = nullptr;
+		int32_t Length = 0;
+
+		int32_t size() const { return Length; }
+		bool empty() const { return Length == 0; }
+		int32_t& operator[](int32_t Index) const { return Cells[Index]; }
+		int32_t back() const { return Cells[Length - 1]; }
+		int32_t* begin() const { return Cells; }
+		int32_t* end() const { return Cells + Length; }
+	};
+
+	struct PathArenaStats
+	{
+		//Spans handed out and the cells in them
+		int64_t Allocations = 0;
+		int64_t Cells = 0;
+		//Blocks taken from the heap, every other span came out of a block that was already there
+		int64_t BlockAllocations = 0;
+		size_t PeakBytes = 0;
+	};
+
+	/**
+	 * Bump allocator for path cells with the lifetime of a level or a search. A span is carved out of the current block
+	 * with the length the path is known to have, so it is written back to front once and never grows. Reset hands
+	 * every span back in one go and keeps the blocks for the next round, Release returns them to the heap.
+	 */
+	class PathArena
+	{
+
+	public:
+
+		//Cells per block, a longer span gets a block of its own size
+		void SetBlockCells(int32_t Cells);
+		PathSpan Allocate(int32_t Length);
+		void Reset();
+		void Release();
+
+		size_t GetUsedBytes() const { return UsedCells * sizeof(int32_t); }
+		size_t GetReservedBytes() const;
+		const PathArenaStats& GetStats() const { return Stats; }
+		//Peak starts again from what is in use right now
+		void ResetStats();
+
+	private:
+
+		struct Block
+		{
+			std::unique_ptr<int32_t[]> Cells;
+			int32_t Size = 0;
+			int32_t Used = 0;
+		};
+
+		std::vector<Block> Blocks;
+		size_t Current = 0;
+		int32_t BlockCells = 16384;
+		size_t UsedCells = 0;
+		PathArenaStats Stats;
+	};
+}
@@ -0,0 +1,222 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathCache.h"
+
+#include <iterator>
+
+namespace Pathfinding
+{
+	namespace
+	{
+		constexpr int MaxRun = 64;
+	}
+
+	void PathCache::SetGrid(const GridMap* InGrid)
+	{
+		Grid = InGrid;
+		Clear();
+		TerrainVersion = Grid ? Grid->GetTerrainVersion() : 0;
+	}
+
+	void PathCache::SetMemoryLimit(size_t Bytes)
+	{
+		MemoryLimit = Bytes;
+		while(UsedBytes > MemoryLimit && !Entries.empty())
+		{
+			Erase(std::prev(Entries.end()));
+			Stats.Evictions++;
+		}
+	}
+
+	bool PathCache::Find(int32_t Start, int32_t Goal, std::vector<int32_t>& OutPath, int32_t& OutCost)
+	{
+		if(!IsEnabled())
+		{
+			return false;
+		}
+		CheckTerrainVersion();
+		Stats.Lookups++;
+
+		const auto Found = ByQuery.find(QueryKey(Start, Goal));
+		if(Found != ByQuery.end())
+		{
+			//Move it to the front, splice keeps every iterator valid
+			Entries.splice(Entries.begin(), Entries, Found->second);
+			const Entry& Cached = *Found->second;
+			Decode(Cached, OutPath);
+			OutCost = Cached.Cost;
+			Stats.Hits++;
+			Stats.SavedExpansions += Cached.Expansions;
+			return true;
+		}
+		if(bSuffixReuse && FindSuffix(Start, Goal, OutPath, OutCost))
+		{
+			Stats.Hits++;
+			Stats.SuffixHits++;
+			return true;
+		}
+		return false;
+	}
+
+	void PathCache::Store(int32_t Start, int32_t Goal, const std::vector<int32_t>& Path, int32_t Cost, int64_t Expansions)
+	{
+		if(!IsEnabled() || Path.empty())
+		{
+			return;
+		}
+		CheckTerrainVersion();
+		const uint64_t Key = QueryKey(Start, Goal);
+		if(ByQuery.count(Key) > 0)
+		{
+			return;
+		}
+
+		//Pack the moves into runs of one direction
+		Scratch.clear();
+		int32_t Previous = Start;
+		uint8_t RunDirection = 0;
+		int RunLength = 0;
+		for(const int32_t Cell : Path)
+		{
+			const int32_t Delta = Cell - Previous;
+			const uint8_t Direction = Delta == 1 ? 0 : (Delta == -1 ? 1 : (Delta > 0 ? 2 : 3));
+			if(RunLength > 0 && (Direction != RunDirection || RunLength == MaxRun))
+			{
+				Scratch.push_back(static_cast<uint8_t>(RunDirection << 6 | (RunLength - 1)));
+				RunLength = 0;
+			}
+			RunDirection = Direction;
+			RunLength++;
+			Previous = Cell;
+		}
+		Scratch.push_back(static_cast<uint8_t>(RunDirection << 6 | (RunLength - 1)));
+
+		Entry Cached;
+		Cached.Start = Start;
+		Cached.Goal = Goal;
+		Cached.Cost = Cost;
+		Cached.Length = static_cast<int32_t>(Path.size());
+		Cached.Expansions = Expansions;
+		Cached.Runs.assign(Scratch.begin(), Scratch.end());
+		const size_t Bytes = EntryBytes(Cached);
+		if(Bytes > MemoryLimit)
+		{
+			return;
+		}
+		while(UsedBytes + Bytes > MemoryLimit && !Entries.empty())
+		{
+			Erase(std::prev(Entries.end()));
+			Stats.Evictions++;
+		}
+
+		Stats.Stores++;
+		Stats.StoredCells += Cached.Length;
+		Stats.StoredRunBytes += static_cast<int64_t>(Cached.Runs.size());
+		Entries.push_front(std::move(Cached));
+		ByQuery.emplace(Key, Entries.begin());
+		ByGoal.emplace(Goal, Entries.begin());
+		UsedBytes += Bytes;
+	}
+
+	void PathCache::Clear()
+	{
+		Entries.clear();
+		ByQuery.clear();
+		ByGoal.clear();
+		UsedBytes = 0;
+	}
+
+	int32_t PathCache::StepOf(uint8_t Direction) const
+	{
+		const int32_t Steps[4] = {1, -1, Grid->GetPitch(), -Grid->GetPitch()};
+		return Steps[Direction];
+	}
+
+	void PathCache::Decode(const Entry& Cached, std::vector<int32_t>& OutPath) const
+	{
+		OutPath.resize(Cached.Length);
+		int32_t Cell = Cached.Start;
+		size_t i = 0;
+		for(const uint8_t Run : Cached.Runs)
+		{
+			const int32_t Step = StepOf(Run >> 6);
+			for(int Length = (Run & 63) + 1; Length > 0; Length--)
+			{
+				Cell += Step;
+				OutPath[i++] = Cell;
+			}
+		}
+	}
+
+	bool PathCache::FindSuffix(int32_t Start, int32_t Goal, std::vector<int32_t>& OutPath, int32_t& OutCost)
+	{
+		//Walk each cached path to Goal without decoding it, the tail from Start on is only written out on a match
+		const auto Range = ByGoal.equal_range(Goal);
+		for(auto It = Range.first; It != Range.second; ++It)
+		{
+			const Entry& Cached = *It->second;
+			int32_t Cell = Cached.Start;
+			int32_t Cost = Cached.Cost;
+			for(size_t Run = 0; Run < Cached.Runs.size(); Run++)
+			{
+				const int32_t Step = StepOf(Cached.Runs[Run] >> 6);
+				for(int Length = (Cached.Runs[Run] & 63) + 1; Length > 0; Length--)
+				{
+					Cell += Step;
+					Cost -= Grid->GetTravelCost(Cell);
+					if(Cell != Start)
+					{
+						continue;
+					}
+
+					//The rest of this run, then the runs after it
+					OutPath.clear();
+					OutCost = Cost;
+					for(int Rest = Length - 1; Rest > 0; Rest--)
+					{
+						Cell += Step;
+						OutPath.push_back(Cell);
+					}
+					for(size_t Next = Run + 1; Next < Cached.Runs.size(); Next++)
+					{
+						const int32_t NextStep = StepOf(Cached.Runs[Next] >> 6);
+						for(int Rest = (Cached.Runs[Next] & 63) + 1; Rest > 0; Rest--)
+						{
+							Cell += NextStep;
+							OutPath.push_back(Cell);
+						}
+					}
+					Entries.splice(Entries.begin(), Entries, It->second);
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	void PathCache::Erase(EntryList::iterator Cached)
+	{
+		ByQuery.erase(QueryKey(Cached->Start, Cached->Goal));
+		const auto Range = ByGoal.equal_range(Cached->Goal);
+		for(auto It = Range.first; It != Range.second; ++It)
+		{
+			if(It->second == Cached)
+			{
+				ByGoal.erase(It);
+				break;
+			}
+		}
+		UsedBytes -= EntryBytes(*Cached);
+		Entries.erase(Cached);
+	}
+
+	void PathCache::CheckTerrainVersion()
+	{
+		if(TerrainVersion != Grid->GetTerrainVersion())
+		{
+			Clear();
+			TerrainVersion = Grid->GetTerrainVersion();
+		}
+	}
+}
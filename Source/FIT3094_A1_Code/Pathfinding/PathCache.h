@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "GridMap.h"
+
+namespace Pathfinding
+{
+	struct PathCacheStats
+	{
+		int64_t Lookups = 0;
+		int64_t Hits = 0;
+		//Hits answered by the tail of a cached path that passes through the start, counted in Hits as well
+		int64_t SuffixHits = 0;
+		int64_t Stores = 0;
+		int64_t Evictions = 0;
+		//Expansions the searches of the exact hits took when they were first planned
+		int64_t SavedExpansions = 0;
+		//Cells of the stored paths and the bytes of run codes they were packed into
+		int64_t StoredCells = 0;
+		int64_t StoredRunBytes = 0;
+	};
+
+	/**
+	 * Paths found earlier, keyed by start, goal and the terrain version of the grid, so a query that was already
+	 * answered costs a lookup instead of a search. Paths are kept as run lengths of one direction per byte, a straight
+	 * run of up to 64 cells is one byte instead of one index per cell. The least recently used paths are dropped once
+	 * the cache holds more than its memory limit, and all of them once the terrain changes.
+	 *
+	 * With suffix reuse on, a miss also looks through the cached paths to the same goal: when one of them passes
+	 * through the start, the rest of it answers the query. That is only valid for optimal paths, whose every tail is
+	 * optimal as well, so the owner turns it on only while the planner is optimal. Not thread safe.
+	 */
+	class PathCache
+	{
+
+	public:
+
+		//Drops every path, they belong to the old grid
+		void SetGrid(const GridMap* InGrid);
+		//0 turns the cache off
+		void SetMemoryLimit(size_t Bytes);
+		size_t GetMemoryLimit() const { return MemoryLimit; }
+		bool IsEnabled() const { return MemoryLimit > 0 && Grid; }
+		void SetSuffixReuse(bool bEnable) { bSuffixReuse = bEnable; }
+
+		//On a hit OutPath holds the cells after Start up to Goal, like PathPlanner::FindPath
+		bool Find(int32_t Start, int32_t Goal, std::vector<int32_t>& OutPath, int32_t& OutCost);
+		//Path excludes Start, Expansions is what the search that found it took
+		void Store(int32_t Start, int32_t Goal, const std::vector<int32_t>& Path, int32_t Cost, int64_t Expansions);
+		void Clear();
+
+		int GetPathCount() const { return static_cast<int>(Entries.size()); }
+		//Estimated, the run codes plus the bookkeeping of each entry
+		size_t GetMemoryBytes() const { return UsedBytes; }
+		const PathCacheStats& GetStats() const { return Stats; }
+		void ResetStats() { Stats = PathCacheStats(); }
+
+	private:
+
+		struct Entry
+		{
+			int32_t Start = NoCell;
+			int32_t Goal = NoCell;
+			int32_t Cost = 0;
+			int32_t Length = 0;
+			int64_t Expansions = 0;
+			//2 bits of direction, 6 bits of run length - 1
+			std::vector<uint8_t> Runs;
+		};
+		using EntryList = std::list<Entry>;
+
+		//List and map nodes of one entry, counted on top of its run codes
+		static constexpr size_t EntryOverhead = sizeof(Entry) + 4 * sizeof(void*) + 2 * sizeof(uint64_t);
+
+		const GridMap* Grid = nullptr;
+		size_t MemoryLimit = 0;
+		size_t UsedBytes = 0;
+		bool bSuffixReuse = false;
+		uint32_t TerrainVersion = 0;
+
+		//Most recently used first
+		EntryList Entries;
+		std::unordered_map<uint64_t, EntryList::iterator> ByQuery;
+		std::unordered_multimap<int32_t, EntryList::iterator> ByGoal;
+		std::vector<uint8_t> Scratch;
+		PathCacheStats Stats;
+
+		static uint64_t QueryKey(int32_t Start, int32_t Goal) { return static_cast<uint64_t>(static_cast<uint32_t>(Start)) << 32 | static_cast<uint32_t>(Goal); }
+		static size_t EntryBytes(const Entry& Cached) { return EntryOverhead + Cached.Runs.capacity(); }
+		int32_t StepOf(uint8_t Direction) const;
+		void Decode(const Entry& Cached, std::vector<int32_t>& OutPath) const;
+		bool FindSuffix(int32_t Start, int32_t Goal, std::vector<int32_t>& OutPath, int32_t& OutCost);
+		void Erase(EntryList::iterator Cached);
+		void CheckTerrainVersion();
+	};
+}
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathMarkerBuffer.h"
+
+#include <algorithm>
+
+namespace Pathfinding
+{
+	void PathMarkerBuffer::Add(const std::vector<int32_t>& Path)
+	{
+		if(Path.empty())
+		{
+			return;
+		}
+		//FirstChanged is never past the cells already queued, appending keeps it where it is
+		Cells.insert(Cells.end(), Path.begin(), Path.end());
+		Stats.Cells += static_cast<int64_t>(Path.size());
+		bChanged = true;
+	}
+
+	void PathMarkerBuffer::Clear()
+	{
+		bChanged = bChanged || !Cells.empty();
+		FirstChanged = 0;
+		Cells.clear();
+	}
+
+	MarkerFlush PathMarkerBuffer::Flush()
+	{
+		MarkerFlush Plan;
+		if(!bChanged)
+		{
+			return Plan;
+		}
+		bChanged = false;
+
+		//Cells only grow between two clears, so FirstChanged is never past the instances there are
+		const int32_t Shown = static_cast<int32_t>(Cells.size());
+		Plan.First = FirstChanged;
+		Plan.Moved = std::min(InstanceCount, Shown) - Plan.First;
+		Plan.Hidden = std::max(ShownCount - Shown, 0);
+		Plan.Added = std::max(Shown - InstanceCount, 0);
+		InstanceCount += Plan.Added;
+		ShownCount = Shown;
+		FirstChanged = Shown;
+
+		Stats.Flushes++;
+		Stats.Moved += Plan.Moved;
+		Stats.Hidden += Plan.Hidden;
+		Stats.Added += Plan.Added;
+		return Plan;
+	}
+}
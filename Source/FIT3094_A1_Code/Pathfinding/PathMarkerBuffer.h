@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Pathfinding
+{
+	//What one flush writes: the Moved instances from First on are moved onto the cells of the same index, the Hidden
+	//instances after them are scaled to nothing and Added new instances are appended for the cells past the moved ones
+	struct MarkerFlush
+	{
+		int32_t First = 0;
+		int32_t Moved = 0;
+		int32_t Hidden = 0;
+		int32_t Added = 0;
+	};
+
+	struct MarkerStats
+	{
+		//Cells queued, each one was an actor spawn before the markers were instanced
+		int64_t Cells = 0;
+		int64_t Flushes = 0;
+		int64_t Moved = 0;
+		int64_t Hidden = 0;
+		int64_t Added = 0;
+	};
+
+	/**
+	 * Cells of the path markers on show and how many marker instances there are to show them. Instances are only ever
+	 * added: a flush moves the existing ones onto the current cells, appends the missing ones and hides the ones left
+	 * over, so the next plan gets them back without adding any. Only what changed since the last flush is written, a
+	 * replan that appends its path leaves the markers before it alone and a shorter plan only hides what it no longer
+	 * needs. The owner applies each MarkerFlush to its instances.
+	 */
+	class PathMarkerBuffer
+	{
+
+	public:
+
+		//Queues one marker per cell, after the ones already there
+		void Add(const std::vector<int32_t>& Path);
+		//Drops every queued marker, the instances stay for the next plans
+		void Clear();
+		bool IsChanged() const { return bChanged; }
+		//Nothing to write when nothing changed since the last flush
+		MarkerFlush Flush();
+
+		const std::vector<int32_t>& GetCells() const { return Cells; }
+		int32_t GetInstanceCount() const { return InstanceCount; }
+		const MarkerStats& GetStats() const { return Stats; }
+		void ResetStats() { Stats = MarkerStats(); }
+
+	private:
+
+		std::vector<int32_t> Cells;
+		int32_t InstanceCount = 0;
+		//Cells shown by the last flush, and the first one that may have changed since
+		int32_t ShownCount = 0;
+		int32_t FirstChanged = 0;
+		bool bChanged = false;
+		MarkerStats Stats;
+	};
+}
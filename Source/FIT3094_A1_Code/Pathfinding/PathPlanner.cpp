@@ -0,0 +1,401 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathPlanner.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+namespace Pathfinding
+{
+	void PathPlanner::SetGrid(const GridMap* InGrid)
+	{
+		Grid = InGrid;
+
+		const int CellCount = Grid ? Grid->Num() : 0;
+		G.assign(CellCount, 0);
+		Parent.assign(CellCount, NoCell);
+		Generation.assign(CellCount, 0);
+		State.assign(CellCount, Unvisited);
+		OpenList.Resize(CellCount);
+		SearchGeneration = 0;
+	}
+
+	bool PathPlanner::FindPath(int32_t Start, int32_t Goal, std::vector<int32_t>& OutPath, const SearchOptions& Options)
+	{
+		OutPath.clear();
+		LastExpansions = 0;
+		LastPathCost = 0;
+
+		if(!Grid || Start == NoCell || Goal == NoCell)
+		{
+			return false;
+		}
+		if(!IsReachable(Start, Goal, Options))
+		{
+			Stats.Unreachable++;
+			return false;
+		}
+
+		const bool bNoAvoid = Options.AvoidCell == NoCell && !Options.bAvoidOccupied;
+		if(Mode == SearchMode::Hierarchical && bNoAvoid && Sectors && Sectors->GetGrid() == Grid && !Sectors->IsDirty()
+			&& std::abs(Grid->GetX(Goal) - Grid->GetX(Start)) + std::abs(Grid->GetY(Goal) - Grid->GetY(Start)) >= HierarchicalSectors * Sectors->GetSectorSize())
+		{
+			if(Hierarchy.GetGraph() != Sectors)
+			{
+				Hierarchy.SetGraph(Sectors);
+			}
+			const bool bHierarchicalFound = Hierarchy.FindPath(Start, Goal, OutPath);
+			LastExpansions = Hierarchy.GetLastExpansions();
+			LastPathCost = Hierarchy.GetLastPathCost();
+			Stats.Searches++;
+			Stats.Expansions += LastExpansions;
+			Stats.NodesTouched += Hierarchy.GetLastNodesTouched();
+			Stats.OpenPeak = std::max(Stats.OpenPeak, Hierarchy.GetLastOpenPeak());
+			Stats.DecreaseKeys += Hierarchy.GetLastDecreaseKeys();
+			Stats.HeuristicEvaluations += Hierarchy.GetLastHeuristicEvaluations();
+			return bHierarchicalFound;
+		}
+
+		BeginSearch();
+		PushStartNode(Start, Goal);
+
+		bool bFound = false;
+		while(!OpenList.IsEmpty())
+		{
+			//The open list is a binary heap, so the lowest f value cell is popped in O(log n)
+			const int32_t Current = OpenList.Pop();
+			SetState(Current, Closed);
+			if(Current == Goal)
+			{
+				bFound = true;
+				break;
+			}
+			if(Mode == SearchMode::JumpPoint)
+			{
+				GetJumpPoints(Current, Goal, Options);
+			}
+			else
+			{
+				GetNeighbours(Current, Goal, Options);
+			}
+			LastExpansions++;
+			//Popping only shrinks the list, so the peak is always right after an expansion
+			if(OpenList.Num() > Stats.OpenPeak)
+			{
+				Stats.OpenPeak = OpenList.Num();
+			}
+		}
+
+		Stats.Expansions += LastExpansions;
+
+		if(bFound)
+		{
+			LastPathCost = G[Goal];
+			BuildPath(Goal, OutPath);
+		}
+		return bFound;
+	}
+
+	int PathPlanner::GetDistance(int32_t From, int32_t To) const
+	{
+		const int DX = std::abs(Grid->GetX(To) - Grid->GetX(From));
+		const int DY = std::abs(Grid->GetY(To) - Grid->GetY(From));
+		//Every cell costs at least 1, so both are lower bounds and the larger one is the better estimate
+		if(Landmarks && Landmarks->GetCount() > 0 && Landmarks->GetGrid() == Grid)
+		{
+			return HeuristicWeight * std::max(DX + DY, Landmarks->GetLowerBound(From, To));
+		}
+		return HeuristicWeight * (DX + DY);
+	}
+
+	bool PathPlanner::IsReachable(int32_t Start, int32_t Goal, const SearchOptions& Options) const
+	{
+		//Occupied cells only close the map for searches that avoid them, the terrain labels are a looser bound for the rest
+		const ConnectedComponents* Labels = TerrainComponents;
+		if(Options.bAvoidOccupied && FreeWater && FreeWater->GetGrid() == Grid && FreeWater->BlocksOccupied())
+		{
+			Labels = FreeWater;
+		}
+		if(!Labels || Labels->GetGrid() != Grid || static_cast<int>(Labels->GetIds().size()) != Grid->Num())
+		{
+			return true;
+		}
+		return Labels->CanReach(Start, Goal);
+	}
+
+	int64_t PathPlanner::GetNodeResetsSkipped() const
+	{
+		const int64_t CellsPerSweep = Grid ? static_cast<int64_t>(Grid->GetWidth()) * Grid->GetHeight() : 0;
+		return Stats.Searches * CellsPerSweep - Stats.NodesTouched;
+	}
+
+	size_t PathPlanner::GetFlatMemoryBytes() const
+	{
+		return G.capacity() * sizeof(int32_t) + Parent.capacity() * sizeof(int32_t) + Generation.capacity() * sizeof(uint32_t)
+			+ State.capacity() * sizeof(ListState) + OpenList.GetMemoryBytes();
+	}
+
+	void PathPlanner::BeginSearch()
+	{
+		//The grid may have been re-initialised since SetGrid
+		if(static_cast<int>(G.size()) != Grid->Num())
+		{
+			SetGrid(Grid);
+		}
+
+		Stats.Searches++;
+		OpenList.Clear();
+		SearchGeneration++;
+		//After the counter wrapped around old stamps could match again, so clear them once
+		if(SearchGeneration == 0)
+		{
+			Generation.assign(Generation.size(), 0);
+			SearchGeneration = 1;
+		}
+	}
+
+	void PathPlanner::PushStartNode(int32_t Start, int32_t Goal)
+	{
+		const int H = GetDistance(Start, Goal);
+		Parent[Start] = NoCell;
+		G[Start] = 0;
+		SetState(Start, Open);
+		OpenList.Push(Start, H, H);
+		Stats.NodesTouched++;
+		Stats.HeuristicEvaluations++;
+		Stats.OpenPeak = std::max<int64_t>(Stats.OpenPeak, 1);
+	}
+
+	void PathPlanner::GetNeighbours(int32_t Current, int32_t Goal, const SearchOptions& Options)
+	{
+		//X+1, X-1, Y+1, Y-1. The grid is padded with a border of land, so none of them can leave the map
+		const int Pitch = Grid->GetPitch();
+		const int32_t Neighbours[4] = {Current + 1, Current - 1, Current + Pitch, Current - Pitch};
+
+		for(const int32_t Neighbour : Neighbours)
+		{
+			//Land costs 100 and is never entered
+			if(!CanEnter(Neighbour, Options) || IsClosed(Neighbour))
+			{
+				continue;
+			}
+			OpenNode(Neighbour, Current, G[Current] + Grid->GetTravelCost(Neighbour), Goal);
+		}
+	}
+
+	void PathPlanner::GetJumpPoints(int32_t Current, int32_t Goal, const SearchOptions& Options)
+	{
+		const int Pitch = Grid->GetPitch();
+		int Directions[4] = {1, -1, Pitch, -Pitch};
+		int DirectionCount = 4;
+
+		//The start cell scans all four directions, any other jump point is pruned by the direction it was reached from
+		const int32_t From = Parent[Current];
+		if(From != NoCell)
+		{
+			const int32_t Delta = Current - From;
+			if(Delta % Pitch != 0)
+			{
+				//Reached horizontally: keep going and turn either way
+				Directions[0] = Delta > 0 ? 1 : -1;
+				Directions[1] = Pitch;
+				Directions[2] = -Pitch;
+				DirectionCount = 3;
+			}
+			else
+			{
+				//Reached vertically: keep going, and turn only where the cell behind the side is not of the same cost
+				const int Step = Delta > 0 ? Pitch : -Pitch;
+				const int Cost = Grid->GetTravelCost(Current);
+				Directions[0] = Step;
+				DirectionCount = 1;
+				for(const int Side : {1, -1})
+				{
+					const int32_t Behind = Current + Side - Step;
+					if(CanEnter(Current + Side, Options) && !(CanEnter(Behind, Options) && Grid->GetTravelCost(Behind) == Cost))
+					{
+						Directions[DirectionCount++] = Side;
+					}
+				}
+			}
+		}
+
+		const bool bUseTable = Jumps && Jumps->GetGrid() == Grid && Options.AvoidCell == NoCell && !Options.bAvoidOccupied;
+		for(int i = 0; i < DirectionCount; i++)
+		{
+			const int Direction = Directions[i];
+			if(!CanEnter(Current + Direction, Options))
+			{
+				continue;
+			}
+
+			const int32_t JumpPoint = bUseTable ? JumpFromTable(Current, Direction, Goal) : Jump(Current, Direction, Goal, Options);
+			if(JumpPoint == NoCell || IsClosed(JumpPoint))
+			{
+				continue;
+			}
+			//Every cell on the way has the cost of the first one
+			const int Steps = (JumpPoint - Current) / Direction;
+			OpenNode(JumpPoint, Current, G[Current] + Steps * Grid->GetTravelCost(Current + Direction), Goal);
+		}
+	}
+
+	int32_t PathPlanner::Jump(int32_t From, int Direction, int32_t Goal, const SearchOptions& Options) const
+	{
+		const int Pitch = Grid->GetPitch();
+		const bool bHorizontal = Direction == 1 || Direction == -1;
+		const int Cost = Grid->GetTravelCost(From + Direction);
+
+		int32_t Cell = From;
+		while(true)
+		{
+			const int32_t Next = Cell + Direction;
+			if(!CanEnter(Next, Options))
+			{
+				return NoCell;
+			}
+			//Stop in front of a cost change, the next cell is expanded like a normal neighbour
+			if(Grid->GetTravelCost(Next) != Cost)
+			{
+				return Cell;
+			}
+			Cell = Next;
+			if(Cell == Goal)
+			{
+				return Cell;
+			}
+
+			if(bHorizontal)
+			{
+				//A horizontal move may turn anywhere, so the cell is a jump point if a vertical scan from it finds one
+				for(const int Side : {Pitch, -Pitch})
+				{
+					if(!CanEnter(Cell + Side, Options))
+					{
+						continue;
+					}
+					if(Grid->GetTravelCost(Cell + Side) != Cost || Jump(Cell, Side, Goal, Options) != NoCell)
+					{
+						return Cell;
+					}
+				}
+			}
+			else
+			{
+				//A vertical move only turns to a side cell that could not have been reached along its own column
+				for(const int Side : {1, -1})
+				{
+					const int32_t Behind = Cell + Side - Direction;
+					if(CanEnter(Cell + Side, Options) && !(CanEnter(Behind, Options) && Grid->GetTravelCost(Behind) == Cost))
+					{
+						return Cell;
+					}
+				}
+			}
+		}
+	}
+
+	int32_t PathPlanner::JumpFromTable(int32_t From, int Direction, int32_t Goal) const
+	{
+		const int Pitch = Grid->GetPitch();
+		const bool bHorizontal = Direction == 1 || Direction == -1;
+		const int Step = Direction > 0 ? 1 : -1;
+		const JumpTable::Direction Dir = bHorizontal ? (Step > 0 ? JumpTable::Right : JumpTable::Left) : (Step > 0 ? JumpTable::Down : JumpTable::Up);
+
+		const int Distance = Jumps->GetDistance(From, Dir);
+		const int Walked = Distance > 0 ? Distance : -Distance;
+		int Steps = Distance > 0 ? Distance : INT_MAX;
+
+		//The table does not know the goal, so check whether the walked cells reach it first
+		const int DX = Grid->GetX(Goal) - Grid->GetX(From);
+		const int DY = Grid->GetY(Goal) - Grid->GetY(From);
+		if(!bHorizontal)
+		{
+			if(DX == 0 && DY * Step >= 1 && DY * Step <= Walked)
+			{
+				Steps = DY * Step;
+			}
+		}
+		else if(DX * Step >= 1 && DX * Step <= Walked && DX * Step < Steps)
+		{
+			if(DY == 0)
+			{
+				Steps = DX * Step;
+			}
+			else
+			{
+				//The goal is straight above or below a walked cell, the vertical scan from there has to reach it
+				const int32_t Column = From + DX;
+				const int Side = DY > 0 ? Pitch : -Pitch;
+				if(Grid->IsPassable(Column + Side) && Grid->GetTravelCost(Column + Side) == Grid->GetTravelCost(From + Direction))
+				{
+					const int Vertical = Jumps->GetDistance(Column, DY > 0 ? JumpTable::Down : JumpTable::Up);
+					if((Vertical > 0 ? Vertical : -Vertical) >= (DY > 0 ? DY : -DY))
+					{
+						Steps = DX * Step;
+					}
+				}
+			}
+		}
+		return Steps == INT_MAX ? NoCell : From + Steps * Direction;
+	}
+
+	void PathPlanner::OpenNode(int32_t Cell, int32_t From, int32_t NewG, int32_t Goal)
+	{
+		if(!IsOpen(Cell))
+		{
+			const int H = GetDistance(Cell, Goal);
+			Parent[Cell] = From;
+			G[Cell] = NewG;
+			SetState(Cell, Open);
+			OpenList.Push(Cell, NewG + H, H);
+			Stats.NodesTouched++;
+			Stats.HeuristicEvaluations++;
+		}
+		else if(NewG < G[Cell])
+		{
+			//H does not change for the same goal, so the one the cell was pushed with is reused and only g and f are updated
+			Parent[Cell] = From;
+			G[Cell] = NewG;
+			OpenList.DecreaseKey(Cell, NewG + OpenList.GetH(Cell));
+			Stats.DecreaseKeys++;
+		}
+	}
+
+	void PathPlanner::BuildPath(int32_t Goal, std::vector<int32_t>& OutPath) const
+	{
+		//A parent is either a neighbour or, after a jump, the far end of a straight line of cells
+		const int Pitch = Grid->GetPitch();
+		auto StepOf = [Pitch](int32_t Delta)
+		{
+			if(Delta % Pitch == 0)
+			{
+				return Delta > 0 ? Pitch : -Pitch;
+			}
+			return Delta > 0 ? 1 : -1;
+		};
+
+		//Count the steps first so the path can be written back to front without shifting
+		int Length = 0;
+		for(int32_t Cell = Goal; Parent[Cell] != NoCell; Cell = Parent[Cell])
+		{
+			const int32_t Delta = Cell - Parent[Cell];
+			Length += Delta / StepOf(Delta);
+		}
+
+		OutPath.resize(Length);
+		int32_t Cell = Goal;
+		int i = Length - 1;
+		while(i >= 0)
+		{
+			const int32_t From = Parent[Cell];
+			const int Step = StepOf(Cell - From);
+			for(; Cell != From; Cell -= Step)
+			{
+				OutPath[i--] = Cell;
+			}
+		}
+	}
+}
@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ConnectedComponents.h"
+#include "GridMap.h"
+#include "HierarchicalSearch.h"
+#include "JumpTable.h"
+#include "LandmarkTable.h"
+#include "NodePriorityQueue.h"
+#include "OccupancyGrid.h"
+#include "SectorGraph.h"
+
+namespace Pathfinding
+{
+	struct SearchOptions
+	{
+		//Cell that must not be entered, e.g. the potential crash cell when replanning
+		int32_t AvoidCell = NoCell;
+		//Skip every cell a ship holds in the planner's OccupancyGrid
+		bool bAvoidOccupied = false;
+	};
+
+	enum class SearchMode : uint8_t
+	{
+		//Expand every neighbour of a cell
+		AStar,
+		//Jump along straight lines of equal cost and only expand the cells where a turn may be needed
+		JumpPoint,
+		//Search the entrances of a SectorGraph and refine the result, near optimal
+		Hierarchical
+	};
+
+	struct PlannerStats
+	{
+		int64_t Searches = 0;
+		int64_t Expansions = 0;
+		//Cells whose search state was initialised, every other cell was never written
+		int64_t NodesTouched = 0;
+		//Queries rejected by the component check without searching
+		int64_t Unreachable = 0;
+		//Largest open list of any search
+		int64_t OpenPeak = 0;
+		//A closed cell is never expanded again, an open one reached again more cheaply has its key lowered instead
+		int64_t DecreaseKeys = 0;
+		int64_t HeuristicEvaluations = 0;
+	};
+
+	/**
+	 * Weighted A* over a GridMap with 4-connected moves, entering a cell costs its travel cost.
+	 * The planner owns all per-search scratch state, the GridMap is only read.
+	 * State is stamped with a search generation, so starting a search costs O(1).
+	 *
+	 * In JumpPoint mode the search only expands jump points. Canonical paths move horizontally first and only turn
+	 * from vertical to horizontal next to an obstacle. A cell with a different travel cost is handled like an obstacle
+	 * when pruning, and a jump always stops in front of it, so the paths found cost the same as in AStar mode.
+	 * With a JumpTable for the grid, searches without avoid options read the jump distances instead of scanning.
+	 *
+	 * Hierarchical mode hands searches without avoid options that span a few sectors to a HierarchicalSearch over
+	 * the SectorGraph. Short ones, where detours through the entrances cost the most, run as plain A*
+	 * like every search while the graph is missing or out of date.
+	 */
+	class PathPlanner
+	{
+
+	public:
+
+		void SetGrid(const GridMap* InGrid);
+		const GridMap* GetGrid() const { return Grid; }
+
+		/*
+		 * Search from Start to Goal. On success OutPath holds the cells to walk through,
+		 * starting with the first move and ending with Goal. Returns false if Goal cannot be reached.
+		 */
+		bool FindPath(int32_t Start, int32_t Goal, std::vector<int32_t>& OutPath, const SearchOptions& Options = SearchOptions());
+
+		//Manhattan distance, or the landmark bound when that is larger, scaled by the heuristic weight
+		int GetDistance(int32_t From, int32_t To) const;
+
+		void SetHeuristicWeight(int Weight) { HeuristicWeight = Weight; }
+		int GetHeuristicWeight() const { return HeuristicWeight; }
+
+		void SetSearchMode(SearchMode NewMode) { Mode = NewMode; }
+		SearchMode GetSearchMode() const { return Mode; }
+		//Optional and shared between planners, must have been built from the planner's grid
+		void SetJumpTable(const JumpTable* InJumps) { Jumps = InJumps; }
+		//Optional and shared between planners like the JumpTable
+		void SetSectorGraph(const SectorGraph* InSectors) { Sectors = InSectors; }
+		//Optional and shared, an empty table or one built from another grid is ignored
+		void SetLandmarks(const LandmarkTable* InLandmarks) { Landmarks = InLandmarks; }
+		/*
+		 * Optional and shared. Before searching, the goal is checked against the component labels so an unreachable goal
+		 * costs O(1) instead of draining its whole region. FreeWater must block occupied cells, it is used by
+		 * searches with bAvoidOccupied, Terrain by all others.
+		 */
+		void SetComponents(const ConnectedComponents* InTerrain, const ConnectedComponents* InFreeWater) { TerrainComponents = InTerrain; FreeWater = InFreeWater; }
+		//Optional and shared, read by searches with bAvoidOccupied. Without one they only avoid AvoidCell
+		void SetOccupancy(const OccupancyGrid* InOccupancy) { Occupancy = InOccupancy; }
+
+		int64_t GetLastExpansions() const { return LastExpansions; }
+		int32_t GetLastPathCost() const { return LastPathCost; }
+
+		const PlannerStats& GetStats() const { return Stats; }
+		void ResetStats() { Stats = PlannerStats(); }
+		//Node writes that a sweep over the whole grid before every search would have made
+		int64_t GetNodeResetsSkipped() const;
+		//Scratch owned by this planner, the shared JumpTable and SectorGraph are not included
+		size_t GetFlatMemoryBytes() const;
+		size_t GetHierarchicalMemoryBytes() const { return Hierarchy.GetMemoryBytes(); }
+
+	private:
+
+		enum ListState : uint8_t
+		{
+			Unvisited,
+			Open,
+			Closed
+		};
+
+		const GridMap* Grid = nullptr;
+		int HeuristicWeight = 2;
+		SearchMode Mode = SearchMode::AStar;
+		const JumpTable* Jumps = nullptr;
+		const SectorGraph* Sectors = nullptr;
+		const LandmarkTable* Landmarks = nullptr;
+		const ConnectedComponents* TerrainComponents = nullptr;
+		const ConnectedComponents* FreeWater = nullptr;
+		const OccupancyGrid* Occupancy = nullptr;
+		//Queries shorter than this many sector widths are not worth the abstract search
+		static constexpr int HierarchicalSectors = 2;
+		HierarchicalSearch Hierarchy;
+
+		//Search scratch, only valid for cells whose Generation matches the running search
+		std::vector<int32_t> G;
+		std::vector<int32_t> Parent;
+		std::vector<uint32_t> Generation;
+		std::vector<ListState> State;
+		NodePriorityQueue OpenList;
+		uint32_t SearchGeneration = 0;
+
+		int64_t LastExpansions = 0;
+		int32_t LastPathCost = 0;
+		PlannerStats Stats;
+
+		bool IsReachable(int32_t Start, int32_t Goal, const SearchOptions& Options) const;
+
+		bool IsOpen(int32_t Cell) const { return Generation[Cell] == SearchGeneration && State[Cell] == Open; }
+		bool IsClosed(int32_t Cell) const { return Generation[Cell] == SearchGeneration && State[Cell] == Closed; }
+		void SetState(int32_t Cell, ListState NewState)
+		{
+			Generation[Cell] = SearchGeneration;
+			State[Cell] = NewState;
+		}
+
+		void BeginSearch();
+		void PushStartNode(int32_t Start, int32_t Goal);
+		void GetNeighbours(int32_t Current, int32_t Goal, const SearchOptions& Options);
+		void GetJumpPoints(int32_t Current, int32_t Goal, const SearchOptions& Options);
+		//Walk from From in Direction over cells of one travel cost, returns the first jump point or NoCell at a dead end
+		int32_t Jump(int32_t From, int Direction, int32_t Goal, const SearchOptions& Options) const;
+		//Same result as Jump without avoid options, read from the JumpTable
+		int32_t JumpFromTable(int32_t From, int Direction, int32_t Goal) const;
+		void OpenNode(int32_t Cell, int32_t From, int32_t NewG, int32_t Goal);
+
+		bool CanEnter(int32_t Cell, const SearchOptions& Options) const
+		{
+			return Grid->IsPassable(Cell) && Cell != Options.AvoidCell && !(Options.bAvoidOccupied && Occupancy && Occupancy->IsHeld(Cell));
+		}
+		void BuildPath(int32_t Goal, std::vector<int32_t>& OutPath) const;
+	};
+}
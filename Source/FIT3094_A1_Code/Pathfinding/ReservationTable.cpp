@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ReservationTable.h"
+
+#include <algorithm>
+
+namespace Pathfinding
+{
+	void ReservationTable::Init(int CellCount)
+	{
+		//1024 slots to start with, enough for a few ships before the first Grow
+		Shift = 54;
+		Keys.assign(size_t(1) << (64 - Shift), EmptyKey);
+		Owners.assign(Keys.size(), NoShip);
+		Count = 0;
+		ParkedFrom.assign(CellCount, Never);
+		ParkedBy.assign(CellCount, NoShip);
+		LatestTime.assign(CellCount, -1);
+		UsedCells.clear();
+		ParkedCount = 0;
+	}
+
+	void ReservationTable::Clear()
+	{
+		if(Count > 0)
+		{
+			std::fill(Keys.begin(), Keys.end(), EmptyKey);
+			Count = 0;
+		}
+		//Only the cells that were reserved or parked on need resetting
+		for(const int32_t Cell : UsedCells)
+		{
+			ParkedFrom[Cell] = Never;
+			ParkedBy[Cell] = NoShip;
+			LatestTime[Cell] = -1;
+		}
+		UsedCells.clear();
+		ParkedCount = 0;
+	}
+
+	bool ReservationTable::Reserve(int32_t Cell, int32_t Time, int32_t Ship)
+	{
+		if(ParkedFrom[Cell] <= Time && ParkedBy[Cell] != Ship)
+		{
+			return false;
+		}
+		if((Count + 1) * 2 > static_cast<int>(Keys.size()))
+		{
+			Grow();
+		}
+
+		const uint64_t Key = MakeKey(Cell, Time);
+		const size_t Mask = Keys.size() - 1;
+		size_t Index = Slot(Key);
+		//Linear probing, the table is at most half full so runs stay short
+		while(Keys[Index] != EmptyKey)
+		{
+			if(Keys[Index] == Key)
+			{
+				return Owners[Index] == Ship;
+			}
+			Index = (Index + 1) & Mask;
+		}
+		Keys[Index] = Key;
+		Owners[Index] = Ship;
+		Count++;
+
+		if(LatestTime[Cell] < 0 && ParkedBy[Cell] == NoShip)
+		{
+			UsedCells.push_back(Cell);
+		}
+		LatestTime[Cell] = std::max(LatestTime[Cell], Time);
+		return true;
+	}
+
+	void ReservationTable::Park(int32_t Cell, int32_t FromTime, int32_t Ship)
+	{
+		if(LatestTime[Cell] < 0 && ParkedBy[Cell] == NoShip)
+		{
+			UsedCells.push_back(Cell);
+		}
+		if(ParkedBy[Cell] == NoShip)
+		{
+			ParkedCount++;
+		}
+		ParkedFrom[Cell] = FromTime;
+		ParkedBy[Cell] = Ship;
+	}
+
+	int32_t ReservationTable::GetOwner(int32_t Cell, int32_t Time) const
+	{
+		if(ParkedFrom[Cell] <= Time)
+		{
+			return ParkedBy[Cell];
+		}
+		if(LatestTime[Cell] < Time)
+		{
+			return NoShip;
+		}
+
+		const uint64_t Key = MakeKey(Cell, Time);
+		const size_t Mask = Keys.size() - 1;
+		for(size_t Index = Slot(Key); Keys[Index] != EmptyKey; Index = (Index + 1) & Mask)
+		{
+			if(Keys[Index] == Key)
+			{
+				return Owners[Index];
+			}
+		}
+		return NoShip;
+	}
+
+	bool ReservationTable::IsFree(int32_t Cell, int32_t Time, int32_t Ship) const
+	{
+		const int32_t Owner = GetOwner(Cell, Time);
+		return Owner == NoShip || Owner == Ship;
+	}
+
+	bool ReservationTable::CanMove(int32_t From, int32_t To, int32_t Time, int32_t Ship) const
+	{
+		if(!IsFree(To, Time + 1, Ship))
+		{
+			return false;
+		}
+		if(From == To)
+		{
+			return true;
+		}
+		//Whoever stands on To now must not be moving onto From at the same time
+		const int32_t Other = GetOwner(To, Time);
+		return Other == NoShip || Other == Ship || GetOwner(From, Time + 1) != Other;
+	}
+
+	bool ReservationTable::CanPark(int32_t Cell, int32_t FromTime, int32_t Ship) const
+	{
+		if(ParkedBy[Cell] != NoShip && ParkedBy[Cell] != Ship)
+		{
+			return false;
+		}
+		for(int32_t Time = FromTime; Time <= LatestTime[Cell]; Time++)
+		{
+			if(!IsFree(Cell, Time, Ship))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	size_t ReservationTable::GetMemoryBytes() const
+	{
+		return GetSlotBytes() + (ParkedFrom.capacity() + ParkedBy.capacity() + LatestTime.capacity() + UsedCells.capacity()) * sizeof(int32_t);
+	}
+
+	void ReservationTable::Grow()
+	{
+		std::vector<uint64_t> OldKeys(Keys.size() * 2, EmptyKey);
+		std::vector<int32_t> OldOwners(Keys.size() * 2, NoShip);
+		OldKeys.swap(Keys);
+		OldOwners.swap(Owners);
+		Shift--;
+
+		const size_t Mask = Keys.size() - 1;
+		for(size_t i = 0; i < OldKeys.size(); i++)
+		{
+			if(OldKeys[i] == EmptyKey)
+			{
+				continue;
+			}
+			size_t Index = Slot(OldKeys[i]);
+			while(Keys[Index] != EmptyKey)
+			{
+				Index = (Index + 1) & Mask;
+			}
+			Keys[Index] = OldKeys[i];
+			Owners[Index] = OldOwners[i];
+		}
+	}
+}
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "GridMap.h"
+
+namespace Pathfinding
+{
+	/**
+	 * Space-time reservations for cooperative planning: which ship holds a cell at a time step.
+	 * Reservations live in an open addressing hash keyed by (time, cell), so memory follows the number of
+	 * reservations instead of cells * time steps. Ships that reached their goal park there, a park holds the
+	 * cell from its time step on and is kept in a flat array, since it never ends.
+	 */
+	class ReservationTable
+	{
+
+	public:
+
+		void Init(int CellCount);
+		//Drops every reservation and park, keeps the allocated slots
+		void Clear();
+
+		//False when another ship already holds the cell at that time
+		bool Reserve(int32_t Cell, int32_t Time, int32_t Ship);
+		void Park(int32_t Cell, int32_t FromTime, int32_t Ship);
+
+		//Ship holding the cell at Time, NoShip if it is free
+		int32_t GetOwner(int32_t Cell, int32_t Time) const;
+		bool IsFree(int32_t Cell, int32_t Time, int32_t Ship) const;
+		//Moving From -> To between Time and Time + 1 neither enters a held cell nor swaps places with another ship
+		bool CanMove(int32_t From, int32_t To, int32_t Time, int32_t Ship) const;
+		//No other ship holds the cell at FromTime or any time after it
+		bool CanPark(int32_t Cell, int32_t FromTime, int32_t Ship) const;
+
+		int GetCount() const { return Count; }
+		int GetParkedCount() const { return ParkedCount; }
+		size_t GetMemoryBytes() const;
+		//Only the hash slots, the part that grows with the reservations
+		size_t GetSlotBytes() const { return Keys.capacity() * sizeof(uint64_t) + Owners.capacity() * sizeof(int32_t); }
+
+	private:
+
+		static constexpr uint64_t EmptyKey = UINT64_MAX;
+		static constexpr int32_t Never = INT32_MAX;
+
+		//Keys and owners side by side, 12 bytes a slot, kept at most half full
+		std::vector<uint64_t> Keys;
+		std::vector<int32_t> Owners;
+		int Shift = 64;
+		int Count = 0;
+
+		//Per cell: the time a ship parks from and which one, and the latest time any reservation was made
+		std::vector<int32_t> ParkedFrom;
+		std::vector<int32_t> ParkedBy;
+		std::vector<int32_t> LatestTime;
+		std::vector<int32_t> UsedCells;
+		int ParkedCount = 0;
+
+		static uint64_t MakeKey(int32_t Cell, int32_t Time) { return static_cast<uint64_t>(static_cast<uint32_t>(Time)) << 32 | static_cast<uint32_t>(Cell); }
+		size_t Slot(uint64_t Key) const { return static_cast<size_t>((Key * 0x9E3779B97F4A7C15ull) >> Shift); }
+		void Grow();
+	};
+}
@@ -0,0 +1,270 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SectorGraph.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Pathfinding
+{
+	namespace
+	{
+		//Runs shorter than this get one entrance in the middle, longer ones one at each end
+		constexpr int LongEntrance = 6;
+
+		template<typename T>
+		size_t BytesOf(const std::vector<T>& Array)
+		{
+			return Array.capacity() * sizeof(T);
+		}
+	}
+
+	void SectorGraph::Build(const GridMap& InGrid, int InSectorSize)
+	{
+		Grid = &InGrid;
+		SectorSize = std::max(2, InSectorSize);
+		SectorsX = (Grid->GetWidth() + SectorSize - 1) / SectorSize;
+		SectorsY = (Grid->GetHeight() + SectorSize - 1) / SectorSize;
+
+		const int Count = SectorsX * SectorsY;
+		Sectors.assign(Count, SectorData());
+		EastTransitions.assign(Count, std::vector<Transition>());
+		SouthTransitions.assign(Count, std::vector<Transition>());
+		DirtySectors.clear();
+		Search.Init(Grid, SectorSize);
+
+		for(int i = 0; i < Count; i++)
+		{
+			BuildTransitions(i);
+		}
+		for(int i = 0; i < Count; i++)
+		{
+			BuildSector(i);
+		}
+	}
+
+	void SectorGraph::MarkTerrainChanged(int X, int Y)
+	{
+		if(!Grid || !Grid->IsInside(X, Y))
+		{
+			return;
+		}
+		const int Index = Y / SectorSize * SectorsX + X / SectorSize;
+		if(!Sectors[Index].bDirty)
+		{
+			Sectors[Index].bDirty = true;
+			DirtySectors.push_back(Index);
+		}
+	}
+
+	void SectorGraph::Update()
+	{
+		if(DirtySectors.empty())
+		{
+			return;
+		}
+
+		//A changed sector can move the entrances on all four of its borders, which the neighbours share
+		std::vector<int> Rebuild;
+		for(const int Index : DirtySectors)
+		{
+			const int X = Index % SectorsX;
+			const int Y = Index / SectorsX;
+			BuildTransitions(Index);
+			Rebuild.push_back(Index);
+			if(X > 0)
+			{
+				BuildTransitions(Index - 1);
+				Rebuild.push_back(Index - 1);
+			}
+			if(Y > 0)
+			{
+				BuildTransitions(Index - SectorsX);
+				Rebuild.push_back(Index - SectorsX);
+			}
+			if(X + 1 < SectorsX)
+			{
+				Rebuild.push_back(Index + 1);
+			}
+			if(Y + 1 < SectorsY)
+			{
+				Rebuild.push_back(Index + SectorsX);
+			}
+			Sectors[Index].bDirty = false;
+		}
+		DirtySectors.clear();
+
+		std::sort(Rebuild.begin(), Rebuild.end());
+		Rebuild.erase(std::unique(Rebuild.begin(), Rebuild.end()), Rebuild.end());
+		for(const int Index : Rebuild)
+		{
+			BuildSector(Index);
+		}
+	}
+
+	int SectorGraph::GetNodeCount() const
+	{
+		int Count = 0;
+		for(const SectorData& Item : Sectors)
+		{
+			Count += static_cast<int>(Item.Nodes.size());
+		}
+		return Count;
+	}
+
+	int SectorGraph::FindNode(int Index, int32_t Cell) const
+	{
+		//Nodes are sorted by cell
+		const std::vector<int32_t>& Nodes = Sectors[Index].Nodes;
+		const auto Found = std::lower_bound(Nodes.begin(), Nodes.end(), Cell);
+		return Found != Nodes.end() && *Found == Cell ? static_cast<int>(Found - Nodes.begin()) : -1;
+	}
+
+	void SectorGraph::AppendRoute(int Index, int From, int To, std::vector<int32_t>& OutPath) const
+	{
+		const SectorData& Source = Sectors[Index];
+		const uint8_t* Codes = &Source.Routes[static_cast<size_t>(From) * SectorSize * SectorSize];
+		const int OriginX = Index % SectorsX * SectorSize;
+		const int OriginY = Index / SectorsX * SectorSize;
+		const int32_t FromCell = Source.Nodes[From];
+
+		//Follow the parents back from To, then reverse the appended part
+		const size_t First = OutPath.size();
+		int32_t Cell = Source.Nodes[To];
+		int Local = Grid->GetX(Cell) - OriginX + (Grid->GetY(Cell) - OriginY) * SectorSize;
+		while(Cell != FromCell && Codes[Local] != SectorSearch::NoParent)
+		{
+			OutPath.push_back(Cell);
+			Local += Search.ParentOffset(Codes[Local]);
+			Cell = Grid->ToIndex(OriginX + Local % SectorSize, OriginY + Local / SectorSize);
+		}
+		std::reverse(OutPath.begin() + First, OutPath.end());
+	}
+
+	size_t SectorGraph::GetMemoryBytes() const
+	{
+		size_t Bytes = BytesOf(Sectors) + BytesOf(EastTransitions) + BytesOf(SouthTransitions);
+		for(int i = 0; i < static_cast<int>(Sectors.size()); i++)
+		{
+			Bytes += BytesOf(Sectors[i].Nodes) + BytesOf(Sectors[i].IntraCost) + BytesOf(Sectors[i].Routes);
+			Bytes += BytesOf(Sectors[i].LinkOffset) + BytesOf(Sectors[i].LinkCell);
+			Bytes += BytesOf(EastTransitions[i]) + BytesOf(SouthTransitions[i]);
+		}
+		return Bytes;
+	}
+
+	void SectorGraph::BuildTransitions(int Index)
+	{
+		const int OriginX = Index % SectorsX * SectorSize;
+		const int OriginY = Index / SectorsX * SectorSize;
+		const int EndX = std::min(OriginX + SectorSize, Grid->GetWidth());
+		const int EndY = std::min(OriginY + SectorSize, Grid->GetHeight());
+
+		//Walk along one border and turn every run of cells that are open on both sides into entrances
+		auto ScanBorder = [this](int32_t First, int Along, int Across, int Length, std::vector<Transition>& Out)
+		{
+			Out.clear();
+			int RunStart = -1;
+			for(int i = 0; i <= Length; i++)
+			{
+				const int32_t Cell = First + i * Along;
+				const bool bOpen = i < Length && Grid->IsPassable(Cell) && Grid->IsPassable(Cell + Across);
+				if(bOpen && RunStart < 0)
+				{
+					RunStart = i;
+				}
+				else if(!bOpen && RunStart >= 0)
+				{
+					const int RunLength = i - RunStart;
+					if(RunLength < LongEntrance)
+					{
+						const int32_t Middle = First + (RunStart + RunLength / 2) * Along;
+						Out.push_back({Middle, Middle + Across});
+					}
+					else
+					{
+						const int32_t Low = First + RunStart * Along;
+						const int32_t High = First + (i - 1) * Along;
+						Out.push_back({Low, Low + Across});
+						Out.push_back({High, High + Across});
+					}
+					RunStart = -1;
+				}
+			}
+		};
+
+		const int Pitch = Grid->GetPitch();
+		if(EndX < Grid->GetWidth())
+		{
+			ScanBorder(Grid->ToIndex(EndX - 1, OriginY), Pitch, 1, EndY - OriginY, EastTransitions[Index]);
+		}
+		if(EndY < Grid->GetHeight())
+		{
+			ScanBorder(Grid->ToIndex(OriginX, EndY - 1), 1, Pitch, EndX - OriginX, SouthTransitions[Index]);
+		}
+	}
+
+	void SectorGraph::BuildSector(int Index)
+	{
+		const int X = Index % SectorsX;
+		const int Y = Index / SectorsX;
+
+		//Entrance cell in this sector and the cell it leads to, from all four borders
+		std::vector<std::pair<int32_t, int32_t>> Links;
+		for(const Transition& Item : EastTransitions[Index])
+		{
+			Links.emplace_back(Item.Inner, Item.Outer);
+		}
+		for(const Transition& Item : SouthTransitions[Index])
+		{
+			Links.emplace_back(Item.Inner, Item.Outer);
+		}
+		if(X > 0)
+		{
+			for(const Transition& Item : EastTransitions[Index - 1])
+			{
+				Links.emplace_back(Item.Outer, Item.Inner);
+			}
+		}
+		if(Y > 0)
+		{
+			for(const Transition& Item : SouthTransitions[Index - SectorsX])
+			{
+				Links.emplace_back(Item.Outer, Item.Inner);
+			}
+		}
+		std::sort(Links.begin(), Links.end());
+
+		SectorData& Target = Sectors[Index];
+		Target.Nodes.clear();
+		Target.LinkOffset.clear();
+		Target.LinkCell.clear();
+		for(const std::pair<int32_t, int32_t>& Link : Links)
+		{
+			//A corner cell can be an entrance on two borders, it is still one node
+			if(Target.Nodes.empty() || Target.Nodes.back() != Link.first)
+			{
+				Target.Nodes.push_back(Link.first);
+				Target.LinkOffset.push_back(static_cast<int32_t>(Target.LinkCell.size()));
+			}
+			Target.LinkCell.push_back(Link.second);
+		}
+		Target.LinkOffset.push_back(static_cast<int32_t>(Target.LinkCell.size()));
+
+		const size_t NodeCount = Target.Nodes.size();
+		const size_t RouteSize = static_cast<size_t>(SectorSize) * SectorSize;
+		Target.IntraCost.assign(NodeCount * NodeCount, Unreachable);
+		Target.Routes.resize(NodeCount * RouteSize);
+		Target.Routes.shrink_to_fit();
+		for(size_t From = 0; From < NodeCount; From++)
+		{
+			Search.Flood(Target.Nodes[From], false);
+			Search.CopyParents(&Target.Routes[From * RouteSize]);
+			for(size_t To = 0; To < NodeCount; To++)
+			{
+				Target.IntraCost[From * NodeCount + To] = Search.GetCost(Target.Nodes[To]);
+			}
+		}
+	}
+}
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "GridMap.h"
+#include "SectorSearch.h"
+
+namespace Pathfinding
+{
+	/**
+	 * Abstract graph for hierarchical (HPA*) searches.
+	 * The map is cut into square sectors. Every run of open cells along the border of two sectors gets one or two
+	 * entrances, and for every sector the cost and route between each pair of its entrance cells is precomputed with
+	 * a search that stays inside the sector, so refining an abstract path never searches again. Moves are costed like PathPlanner does, by the travel cost of the cell entered,
+	 * so the costs are directional.
+	 * When terrain changes only the touched sectors and their neighbours are rebuilt.
+	 */
+	class SectorGraph
+	{
+
+	public:
+
+		static constexpr int32_t Unreachable = SectorSearch::Unreachable;
+
+		void Build(const GridMap& InGrid, int InSectorSize = 16);
+
+		//Call after GridMap::SetTerrain, Update rebuilds the sectors marked since the last update
+		void MarkTerrainChanged(int X, int Y);
+		void Update();
+		bool IsDirty() const { return !DirtySectors.empty(); }
+
+		const GridMap* GetGrid() const { return Grid; }
+		int GetSectorSize() const { return SectorSize; }
+		int GetSectorCount() const { return static_cast<int>(Sectors.size()); }
+		int SectorOf(int32_t Cell) const { return Grid->GetY(Cell) / SectorSize * SectorsX + Grid->GetX(Cell) / SectorSize; }
+
+		//Upper bound on the entrance cells of one sector, the cells around its edge
+		int GetNodeStride() const { return 4 * SectorSize; }
+		int GetNodeCount() const;
+		const std::vector<int32_t>& GetNodes(int Sector) const { return Sectors[Sector].Nodes; }
+		int FindNode(int Sector, int32_t Cell) const;
+		int32_t GetIntraCost(int Sector, int From, int To) const
+		{
+			return Sectors[Sector].IntraCost[From * Sectors[Sector].Nodes.size() + To];
+		}
+
+		//Cells in neighbouring sectors that entrance node Local leads to
+		const int32_t* LinksBegin(int Sector, int Local) const { return Sectors[Sector].LinkCell.data() + Sectors[Sector].LinkOffset[Local]; }
+		const int32_t* LinksEnd(int Sector, int Local) const { return Sectors[Sector].LinkCell.data() + Sectors[Sector].LinkOffset[Local + 1]; }
+
+		//Appends the cells after entrance node From up to and including node To, both in Sector
+		void AppendRoute(int Sector, int From, int To, std::vector<int32_t>& OutPath) const;
+
+		size_t GetMemoryBytes() const;
+
+	private:
+
+		struct Transition
+		{
+			//Cell inside the sector and the cell across the border
+			int32_t Inner;
+			int32_t Outer;
+		};
+
+		struct SectorData
+		{
+			std::vector<int32_t> Nodes;
+			//Nodes.size() squared, row is the node the move starts from
+			std::vector<int32_t> IntraCost;
+			//SectorSize squared parent codes per node, the shortest path tree grown from that node
+			std::vector<uint8_t> Routes;
+			//Links of node i are LinkCell[LinkOffset[i]] up to LinkCell[LinkOffset[i + 1]]
+			std::vector<int32_t> LinkOffset;
+			std::vector<int32_t> LinkCell;
+			bool bDirty = false;
+		};
+
+		const GridMap* Grid = nullptr;
+		int SectorSize = 16;
+		int SectorsX = 0;
+		int SectorsY = 0;
+
+		std::vector<SectorData> Sectors;
+		//Entrances on the east and south border of every sector, the other two belong to the neighbours
+		std::vector<std::vector<Transition>> EastTransitions;
+		std::vector<std::vector<Transition>> SouthTransitions;
+		std::vector<int> DirtySectors;
+		SectorSearch Search;
+
+		void BuildTransitions(int Index);
+		void BuildSector(int Index);
+	};
+}
@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SectorSearch.h"
+
+#include <algorithm>
+
+namespace Pathfinding
+{
+	void SectorSearch::Init(const GridMap* InGrid, int InSectorSize)
+	{
+		Grid = InGrid;
+		SectorSize = InSectorSize;
+
+		const int CellCount = SectorSize * SectorSize;
+		G.assign(CellCount, 0);
+		Parent.assign(CellCount, -1);
+		Generation.assign(CellCount, 0);
+		Closed.assign(CellCount, 0);
+		OpenList.Resize(CellCount);
+		SearchGeneration = 0;
+	}
+
+	void SectorSearch::Flood(int32_t Source, bool bReverse)
+	{
+		bLastReverse = bReverse;
+		OriginX = Grid->GetX(Source) / SectorSize * SectorSize;
+		OriginY = Grid->GetY(Source) / SectorSize * SectorSize;
+		SizeX = std::min(SectorSize, Grid->GetWidth() - OriginX);
+		SizeY = std::min(SectorSize, Grid->GetHeight() - OriginY);
+
+		OpenList.Clear();
+		SearchGeneration++;
+		if(SearchGeneration == 0)
+		{
+			Generation.assign(Generation.size(), 0);
+			SearchGeneration = 1;
+		}
+
+		const int Start = ToLocal(Source);
+		Generation[Start] = SearchGeneration;
+		Closed[Start] = 0;
+		G[Start] = 0;
+		Parent[Start] = -1;
+		OpenList.Push(Start, 0, 0);
+		NodesTouched++;
+
+		while(!OpenList.IsEmpty())
+		{
+			//Popping only shrinks the list, so it is at its largest right before a pop
+			OpenPeak = std::max<int64_t>(OpenPeak, OpenList.Num());
+			const int Current = OpenList.Pop();
+			Closed[Current] = 1;
+			Expansions++;
+			const int32_t CurrentCell = ToCell(Current);
+
+			const int X = Current % SectorSize;
+			const int Y = Current / SectorSize;
+			const int NeighbourX[4] = {X + 1, X - 1, X, X};
+			const int NeighbourY[4] = {Y, Y, Y + 1, Y - 1};
+			for(int i = 0; i < 4; i++)
+			{
+				if(NeighbourX[i] < 0 || NeighbourX[i] >= SizeX || NeighbourY[i] < 0 || NeighbourY[i] >= SizeY)
+				{
+					continue;
+				}
+				const int Neighbour = NeighbourX[i] + NeighbourY[i] * SectorSize;
+				const int32_t NeighbourCell = Grid->ToIndex(OriginX + NeighbourX[i], OriginY + NeighbourY[i]);
+				const bool bSeen = Generation[Neighbour] == SearchGeneration;
+				if(!Grid->IsPassable(NeighbourCell) || (bSeen && Closed[Neighbour]))
+				{
+					continue;
+				}
+
+				//Walking backwards the move goes from the neighbour into the current cell
+				const int32_t NewG = G[Current] + Grid->GetTravelCost(bReverse ? CurrentCell : NeighbourCell);
+				if(!bSeen)
+				{
+					Generation[Neighbour] = SearchGeneration;
+					Closed[Neighbour] = 0;
+					G[Neighbour] = NewG;
+					Parent[Neighbour] = Current;
+					OpenList.Push(Neighbour, NewG, 0);
+					NodesTouched++;
+				}
+				else if(NewG < G[Neighbour])
+				{
+					G[Neighbour] = NewG;
+					Parent[Neighbour] = Current;
+					OpenList.DecreaseKey(Neighbour, NewG);
+					DecreaseKeys++;
+				}
+			}
+		}
+	}
+
+	void SectorSearch::ResetCounters()
+	{
+		Expansions = 0;
+		NodesTouched = 0;
+		DecreaseKeys = 0;
+		OpenPeak = 0;
+	}
+
+	int32_t SectorSearch::GetCost(int32_t Cell) const
+	{
+		const int X = Grid->GetX(Cell) - OriginX;
+		const int Y = Grid->GetY(Cell) - OriginY;
+		if(X < 0 || X >= SizeX || Y < 0 || Y >= SizeY)
+		{
+			return Unreachable;
+		}
+		const int Local = X + Y * SectorSize;
+		return Generation[Local] == SearchGeneration && Closed[Local] ? G[Local] : Unreachable;
+	}
+
+	size_t SectorSearch::GetMemoryBytes() const
+	{
+		return G.capacity() * sizeof(int32_t) + Parent.capacity() * sizeof(int32_t) + Generation.capacity() * sizeof(uint32_t)
+			+ Closed.capacity() * sizeof(uint8_t) + OpenList.GetMemoryBytes();
+	}
+
+	bool SectorSearch::AppendPath(int32_t Cell, std::vector<int32_t>& OutPath) const
+	{
+		if(GetCost(Cell) == Unreachable)
+		{
+			return false;
+		}
+
+		//Parents point towards the source, which is the end of the path for a reverse flood
+		const size_t First = OutPath.size();
+		if(bLastReverse)
+		{
+			for(int Local = Parent[ToLocal(Cell)]; Local != -1; Local = Parent[Local])
+			{
+				OutPath.push_back(ToCell(Local));
+			}
+		}
+		else
+		{
+			for(int Local = ToLocal(Cell); Parent[Local] != -1; Local = Parent[Local])
+			{
+				OutPath.push_back(ToCell(Local));
+			}
+			std::reverse(OutPath.begin() + First, OutPath.end());
+		}
+		return true;
+	}
+
+	void SectorSearch::CopyParents(uint8_t* OutCodes) const
+	{
+		for(int Local = 0; Local < SectorSize * SectorSize; Local++)
+		{
+			const int X = Local % SectorSize;
+			const int Y = Local / SectorSize;
+			OutCodes[Local] = NoParent;
+			if(X >= SizeX || Y >= SizeY || Generation[Local] != SearchGeneration || !Closed[Local] || Parent[Local] == -1)
+			{
+				continue;
+			}
+			for(uint8_t Code = 0; Code < 4; Code++)
+			{
+				if(Local + ParentOffset(Code) == Parent[Local])
+				{
+					OutCodes[Local] = Code;
+				}
+			}
+		}
+	}
+}
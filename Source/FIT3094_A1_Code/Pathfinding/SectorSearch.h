@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "GridMap.h"
+#include "NodePriorityQueue.h"
+
+namespace Pathfinding
+{
+	/**
+	 * Search that never leaves the square sector of the cell it starts from.
+	 * Used by SectorGraph to cost and store the paths between the entrances of a sector and by HierarchicalSearch
+	 * to connect the start and goal to the abstract graph.
+	 * Scratch state only covers one sector, so it stays small whatever the size of the map.
+	 */
+	class SectorSearch
+	{
+
+	public:
+
+		static constexpr int32_t Unreachable = INT32_MAX;
+		//Parent codes written by CopyParents, the parent of local cell L is L + ParentOffset(Code)
+		static constexpr uint8_t NoParent = 255;
+
+		void Init(const GridMap* InGrid, int InSectorSize);
+
+		/*
+		 * Dijkstra over the whole sector of Source. Afterwards GetCost returns the cost from Source to a cell,
+		 * or with bReverse the cost from a cell to Source.
+		 */
+		void Flood(int32_t Source, bool bReverse);
+		int32_t GetCost(int32_t Cell) const;
+
+		//Appends the path of the last flood between Source and Cell, in walking order and without the first cell
+		bool AppendPath(int32_t Cell, std::vector<int32_t>& OutPath) const;
+		//Parent code of every local cell after the last flood, SectorSize * SectorSize entries
+		void CopyParents(uint8_t* OutCodes) const;
+		int ParentOffset(uint8_t Code) const
+		{
+			const int Offsets[4] = {1, -1, SectorSize, -SectorSize};
+			return Offsets[Code];
+		}
+
+		//Counted over every flood since the last ResetCounters
+		int64_t GetExpansions() const { return Expansions; }
+		int64_t GetNodesTouched() const { return NodesTouched; }
+		int64_t GetDecreaseKeys() const { return DecreaseKeys; }
+		int64_t GetOpenPeak() const { return OpenPeak; }
+		void ResetCounters();
+		size_t GetMemoryBytes() const;
+
+	private:
+
+		const GridMap* Grid = nullptr;
+		int SectorSize = 0;
+
+		//Bounds of the sector searched last, in map coordinates
+		int OriginX = 0;
+		int OriginY = 0;
+		int SizeX = 0;
+		int SizeY = 0;
+
+		//Indexed by local cell, X + Y * SectorSize
+		std::vector<int32_t> G;
+		std::vector<int32_t> Parent;
+		std::vector<uint32_t> Generation;
+		std::vector<uint8_t> Closed;
+		NodePriorityQueue OpenList;
+		uint32_t SearchGeneration = 0;
+		int64_t Expansions = 0;
+		int64_t NodesTouched = 0;
+		int64_t DecreaseKeys = 0;
+		int64_t OpenPeak = 0;
+		bool bLastReverse = false;
+
+		int ToLocal(int32_t Cell) const { return Grid->GetX(Cell) - OriginX + (Grid->GetY(Cell) - OriginY) * SectorSize; }
+		int32_t ToCell(int Local) const { return Grid->ToIndex(OriginX + Local % SectorSize, OriginY + Local / SectorSize); }
+	};
+}
@@ -0,0 +1,161 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShipFleet.h"
+
+#include <cmath>
+
+namespace Pathfinding
+{
+	namespace
+	{
+		/*
+		 * The move of ShipFleet::Advance over raw arrays that never overlap. Every lane is computed and a stopped ship
+		 * moves by a step of 0, the flags are combined with & and | instead of && and ||, so the loop has no branches
+		 * and vectorises; restrict spares the compiler a run time overlap check for every pair of arrays
+		 */
+		void MoveShips(int32_t Count, float DeltaTime, float* __restrict PositionX, float* __restrict PositionY, float* __restrict HeadingX,
+			float* __restrict HeadingY, int32_t* __restrict IsMoving, int32_t* __restrict HasArrived, int32_t* __restrict HasChanged,
+			const float* __restrict GoalX, const float* __restrict GoalY, const float* __restrict Speeds, const float* __restrict Tolerances)
+		{
+			for(int32_t i = 0; i < Count; i++)
+			{
+				//Both headings are read up front, a load in one arm of a select would be a branch
+				const float OldDirX = HeadingX[i];
+				const float OldDirY = HeadingY[i];
+				const float DX = GoalX[i] - PositionX[i];
+				const float DY = GoalY[i] - PositionY[i];
+				const float Distance = std::sqrt(DX * DX + DY * DY);
+				const float Step = Speeds[i] * DeltaTime * static_cast<float>(IsMoving[i]);
+				//On the target DX and DY are 0 and so is the heading, anywhere else the tiny term vanishes in the rounding.
+				//Adding it instead of picking with a compare keeps the division unconditional
+				const float InvDistance = 1 / (Distance + 1e-30f);
+				const float NewDirX = DX * InvDistance;
+				const float NewDirY = DY * InvDistance;
+				const float NewX = PositionX[i] + NewDirX * Step;
+				const float NewY = PositionY[i] + NewDirY * Step;
+				const float LeftX = GoalX[i] - NewX;
+				const float LeftY = GoalY[i] - NewY;
+				const int32_t There = IsMoving[i] & static_cast<int32_t>((LeftX * LeftX + LeftY * LeftY <= Tolerances[i]) | (Distance <= Step));
+				const int32_t Turned = IsMoving[i] & static_cast<int32_t>(Distance > 0);
+
+				PositionX[i] = There ? GoalX[i] : NewX;
+				PositionY[i] = There ? GoalY[i] : NewY;
+				HeadingX[i] = Turned ? NewDirX : OldDirX;
+				HeadingY[i] = Turned ? NewDirY : OldDirY;
+				HasArrived[i] = There;
+				//Bit 0 the ship moved, bit 1 its heading changed as well, which only happens when it sets off somewhere new
+				const int32_t NewHeading = Turned & static_cast<int32_t>((NewDirX != OldDirX) | (NewDirY != OldDirY));
+				HasChanged[i] |= IsMoving[i] | NewHeading << 1;
+				IsMoving[i] &= ~There;
+			}
+		}
+	}
+
+	void ShipFleet::Clear()
+	{
+		X.clear();
+		Y.clear();
+		Z.clear();
+		TargetX.clear();
+		TargetY.clear();
+		DirX.clear();
+		DirY.clear();
+		Speed.clear();
+		ToleranceSquared.clear();
+		Moving.clear();
+		Arrived.clear();
+		Changed.clear();
+		AtGoal.clear();
+		Arrivals.clear();
+		AtGoalCount = 0;
+	}
+
+	int32_t ShipFleet::Add(float InX, float InY, float InZ, float InSpeed, float Tolerance)
+	{
+		X.push_back(InX);
+		Y.push_back(InY);
+		Z.push_back(InZ);
+		TargetX.push_back(InX);
+		TargetY.push_back(InY);
+		DirX.push_back(1);
+		DirY.push_back(0);
+		Speed.push_back(InSpeed);
+		ToleranceSquared.push_back(Tolerance * Tolerance);
+		Moving.push_back(0);
+		Arrived.push_back(0);
+		Changed.push_back(3);
+		AtGoal.push_back(0);
+		return Num() - 1;
+	}
+
+	void ShipFleet::SetTarget(int32_t Ship, float InTargetX, float InTargetY)
+	{
+		TargetX[Ship] = InTargetX;
+		TargetY[Ship] = InTargetY;
+		Moving[Ship] = 1;
+	}
+
+	void ShipFleet::SetPosition(int32_t Ship, float NewX, float NewY)
+	{
+		X[Ship] = NewX;
+		Y[Ship] = NewY;
+		Changed[Ship] |= 1;
+	}
+
+	void ShipFleet::SetHeading(int32_t Ship, float NewDirX, float NewDirY)
+	{
+		Changed[Ship] |= (NewDirX != DirX[Ship] || NewDirY != DirY[Ship]) ? 2 : 0;
+		DirX[Ship] = NewDirX;
+		DirY[Ship] = NewDirY;
+	}
+
+	void ShipFleet::Advance(float DeltaTime)
+	{
+		const int32_t Count = Num();
+		MoveShips(Count, DeltaTime, X.data(), Y.data(), DirX.data(), DirY.data(), Moving.data(), Arrived.data(), Changed.data(), TargetX.data(), TargetY.data(),
+			Speed.data(), ToleranceSquared.data());
+
+		//Arrivals are rare next to moves, gather them apart so the loop above stays branch free
+		Arrivals.clear();
+		for(int32_t i = 0; i < Count; i++)
+		{
+			if(Arrived[i])
+			{
+				Arrivals.push_back(i);
+			}
+		}
+	}
+
+	void ShipFleet::CollectChanged(std::vector<int32_t>& OutMoved, std::vector<int32_t>& OutTurned)
+	{
+		OutMoved.clear();
+		OutTurned.clear();
+		for(int32_t i = 0; i < Num(); i++)
+		{
+			if(Changed[i] & 2)
+			{
+				OutTurned.push_back(i);
+			}
+			else if(Changed[i])
+			{
+				OutMoved.push_back(i);
+			}
+			Changed[i] = 0;
+		}
+	}
+
+	void ShipFleet::MarkAtGoal(int32_t Ship)
+	{
+		AtGoalCount += AtGoal[Ship] ? 0 : 1;
+		AtGoal[Ship] = 1;
+	}
+
+	size_t ShipFleet::GetMemoryBytes() const
+	{
+		const size_t Floats = X.capacity() + Y.capacity() + Z.capacity() + TargetX.capacity() + TargetY.capacity() + DirX.capacity() + DirY.capacity()
+			+ Speed.capacity() + ToleranceSquared.capacity();
+		const size_t Flags = Moving.capacity() + Arrived.capacity() + Changed.capacity() + Arrivals.capacity();
+		return Floats * sizeof(float) + Flags * sizeof(int32_t) + AtGoal.capacity();
+	}
+}
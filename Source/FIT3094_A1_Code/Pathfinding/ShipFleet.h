@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pathfinding
+{
+	/**
+	 * Where every ship of a level is and where it is heading, one array per field instead of one actor per ship, so a
+	 * frame moves all of them in one loop without branches the compiler cannot turn into selects. A ship heads
+	 * straight for its target at its own speed and arrives once it is within its tolerance of it, or would step past
+	 * it. Arrivals are listed in ship order for the owner to handle, the ships that moved or turned since the
+	 * last CollectChanged tell it which transforms to push, and the ships on their goal are counted as they get there.
+	 *
+	 * Knows nothing of cells or paths: the owner turns the next cell of a path into a target.
+	 */
+	class ShipFleet
+	{
+
+	public:
+
+		void Clear();
+		//Ship standing at X, Y. Z is kept for the transforms and never changes. Returns its index
+		int32_t Add(float X, float Y, float Z, float Speed, float Tolerance);
+		int32_t Num() const { return static_cast<int32_t>(X.size()); }
+
+		void SetTarget(int32_t Ship, float TargetX, float TargetY);
+		void Stop(int32_t Ship) { Moving[Ship] = 0; }
+		//Put the ship somewhere without moving it there, it keeps its target and heading
+		void SetPosition(int32_t Ship, float NewX, float NewY);
+		void SetHeading(int32_t Ship, float NewDirX, float NewDirY);
+		//Moves every ship that has a target, the ones that got there stop on it and are listed in GetArrivals
+		void Advance(float DeltaTime);
+		const std::vector<int32_t>& GetArrivals() const { return Arrivals; }
+		//Ships moved or put somewhere since the last call, in ship order: OutTurned those whose heading changed as well,
+		//OutMoved the rest. A ship only turns when it heads for a new target, so most frames only need the location
+		void CollectChanged(std::vector<int32_t>& OutMoved, std::vector<int32_t>& OutTurned);
+
+		bool IsMoving(int32_t Ship) const { return Moving[Ship] != 0; }
+		float GetX(int32_t Ship) const { return X[Ship]; }
+		float GetY(int32_t Ship) const { return Y[Ship]; }
+		float GetZ(int32_t Ship) const { return Z[Ship]; }
+		//Unit vector of the last move, along +X until the ship first moves
+		float GetDirX(int32_t Ship) const { return DirX[Ship]; }
+		float GetDirY(int32_t Ship) const { return DirY[Ship]; }
+
+		//Counts the ship once however often it is marked
+		void MarkAtGoal(int32_t Ship);
+		bool IsAtGoal(int32_t Ship) const { return AtGoal[Ship] != 0; }
+		int32_t GetAtGoalCount() const { return AtGoalCount; }
+		bool AllAtGoal() const { return AtGoalCount == Num(); }
+
+		size_t GetMemoryBytes() const;
+
+	private:
+
+		std::vector<float> X;
+		std::vector<float> Y;
+		std::vector<float> Z;
+		std::vector<float> TargetX;
+		std::vector<float> TargetY;
+		std::vector<float> DirX;
+		std::vector<float> DirY;
+		std::vector<float> Speed;
+		std::vector<float> ToleranceSquared;
+		//32 bit flags rather than bools: a store through a byte may alias any array, which would stop the move loop vectorising
+		std::vector<int32_t> Moving;
+		std::vector<int32_t> Arrived;
+		//Bit 0 moved, bit 1 turned
+		std::vector<int32_t> Changed;
+		std::vector<uint8_t> AtGoal;
+		std::vector<int32_t> Arrivals;
+		int32_t AtGoalCount = 0;
+	};
+}
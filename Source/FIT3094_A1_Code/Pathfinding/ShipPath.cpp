@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShipPath.h"
+
+namespace Pathfinding
+{
+	void ShipPath::Assign(const int32_t* InCells, int32_t Count)
+	{
+		//assign keeps the capacity, a replan only allocates when it is longer than every plan before it
+		Cells.assign(InCells, InCells + Count);
+		Cursor = 0;
+	}
+
+	void ShipPath::Clear()
+	{
+		Cells.clear();
+		Cursor = 0;
+	}
+}
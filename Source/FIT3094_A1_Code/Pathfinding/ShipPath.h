@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pathfinding
+{
+	/**
+	 * The cells a ship still has to walk through, in walking order. Walking into the next cell moves a cursor instead
+	 * of shifting every cell after it, and a new plan is copied over the old one in place, so each ship allocates its
+	 * buffer once and every later plan and replan reuses it. Index 0 is always the next cell.
+	 */
+	class ShipPath
+	{
+
+	public:
+
+		void Assign(const int32_t* InCells, int32_t Count);
+		void Assign(const std::vector<int32_t>& InCells) { Assign(InCells.data(), static_cast<int32_t>(InCells.size())); }
+		void Clear();
+
+		int32_t Num() const { return static_cast<int32_t>(Cells.size()) - Cursor; }
+		bool IsEmpty() const { return Num() == 0; }
+		int32_t operator[](int32_t Index) const { return Cells[Cursor + Index]; }
+		int32_t GetNext() const { return Cells[Cursor]; }
+		//The ship arrived in the next cell
+		void PopFront() { Cursor++; }
+
+		const int32_t* begin() const { return Cells.data() + Cursor; }
+		const int32_t* end() const { return Cells.data() + Cells.size(); }
+		size_t GetMemoryBytes() const { return Cells.capacity() * sizeof(int32_t); }
+
+	private:
+
+		std::vector<int32_t> Cells;
+		//Cells before the cursor were walked already
+		int32_t Cursor = 0;
+	};
+}
@@ -0,0 +1,230 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShipSimulation.h"
+
+#include <numeric>
+#include <random>
+#include <utility>
+
+namespace Pathfinding
+{
+	void ShipSimulation::SetGrid(const GridMap* InGrid)
+	{
+		Grid = InGrid;
+		Occupancy.Init(Grid ? Grid->Num() : 0);
+		Planner.SetOccupancy(&Occupancy);
+		Planner.SetWorkerCount(1);
+		Planner.SetGrid(Grid);
+	}
+
+	SimulationResult ShipSimulation::Run(const std::vector<PathQuery>& Ships, const SimulationSettings& Settings)
+	{
+		Result = SimulationResult();
+		Result.Ships = static_cast<int32_t>(Ships.size());
+		Result.Checksum = 14695981039346656037ull;
+		const int32_t ShipCount = Result.Ships;
+
+		Done = 0;
+		Occupancy.Clear();
+		States.clear();
+		States.resize(ShipCount);
+		for(int32_t Ship = 0; Ship < ShipCount; Ship++)
+		{
+			States[Ship].Goal = Ships[Ship].Goal;
+			States[Ship].LastNode = Ships[Ship].Start;
+			Occupancy.Place(Ship, Ships[Ship].Start);
+		}
+		Planner.OnOccupancyCleared();
+		if(Markers)
+		{
+			Markers->Clear();
+		}
+
+		//One plan after another on the first context, with the path cache the order decides which queries hit it
+		for(int32_t Ship = 0; Ship < ShipCount; Ship++)
+		{
+			PathQuery Query;
+			Query.Start = Ships[Ship].Start;
+			Query.Goal = Ships[Ship].Goal;
+			{
+				const ScopedPhaseTimer Timer(Collector, "Plan");
+				Planner.RunQuery(0, Query, Scratch);
+			}
+			States[Ship].Path.Assign(Scratch.Path);
+			if(Markers)
+			{
+				Markers->Add(Scratch.Path);
+			}
+			Done += Scratch.Path.empty() ? 1 : 0;
+			Result.Arrived += Query.Start == Query.Goal ? 1 : 0;
+			Result.PlannedCost += Scratch.PathCost;
+			Result.Expansions += Scratch.Expansions;
+		}
+
+		Order.resize(ShipCount);
+		std::iota(Order.begin(), Order.end(), 0);
+		if(Settings.Seed != 0)
+		{
+			//A hand rolled Fisher-Yates, std::shuffle may differ between standard libraries
+			std::mt19937 Random(Settings.Seed);
+			for(int32_t i = ShipCount - 1; i > 0; i--)
+			{
+				std::swap(Order[i], Order[Random() % (i + 1)]);
+			}
+		}
+
+		int32_t Step = 0;
+		for(; Step < Settings.StepLimit && Done < ShipCount; Step++)
+		{
+			for(const int32_t Ship : Order)
+			{
+				ShipState& State = States[Ship];
+				if(State.ArriveStep < 0 && State.Path.Num() > 0)
+				{
+					SetOff(Ship, Step, Settings);
+				}
+			}
+			for(const int32_t Ship : Order)
+			{
+				if(States[Ship].ArriveStep == Step)
+				{
+					Arrive(Ship, Step, Settings);
+				}
+			}
+			if(Markers)
+			{
+				Markers->Flush();
+			}
+		}
+		Result.Steps = Step;
+		return Result;
+	}
+
+	void ShipSimulation::SetOff(int32_t Ship, int32_t Step, const SimulationSettings& Settings)
+	{
+		ShipState& State = States[Ship];
+		//Steps stand in for seconds, the ship crosses over halfway and holds the cell it leaves until it arrives
+		const float CrossTime = Step + 0.5f * Settings.StepsPerMove;
+		int32_t Other = Occupancy.FindConflict(Ship, State.Path[0], CrossTime);
+		if(Other != NoShip && Settings.bReplan)
+		{
+			Replan(Ship, Settings);
+			if(State.Path.Num() == 0)
+			{
+				//The goal is cut off by the terrain, the ship stays where it is
+				Done++;
+				return;
+			}
+			Other = Occupancy.FindConflict(Ship, State.Path[0], CrossTime);
+		}
+		State.PotentialCrash = Other;
+		const int32_t Next = State.Path[0];
+		Occupancy.BeginMove(Ship, Next, static_cast<float>(Step + Settings.StepsPerMove));
+		Planner.OnOccupancyChanged(Next);
+		//The set off step is the first of the move
+		State.ArriveStep = Step + Settings.StepsPerMove - 1;
+	}
+
+	void ShipSimulation::Arrive(int32_t Ship, int32_t Step, const SimulationSettings& Settings)
+	{
+		ShipState& State = States[Ship];
+		const int32_t Cell = State.Path[0];
+		if(State.PotentialCrash != NoShip)
+		{
+			Result.Crashes++;
+			Result.CrashPenalty += Settings.CrashPenalty;
+			Hash(-1);
+			Hash(Ship);
+			Hash(State.PotentialCrash);
+			//Two ships meeting head on are both on course for each other, the crash counts once
+			ShipState& Other = States[State.PotentialCrash];
+			if(Other.PotentialCrash == Ship && Other.Path.Num() > 0 && Other.Path[0] == State.LastNode)
+			{
+				Other.PotentialCrash = NoShip;
+			}
+			State.PotentialCrash = NoShip;
+		}
+
+		if(Cell == State.Goal && !State.bAtGoal)
+		{
+			State.bAtGoal = true;
+			Result.Arrived++;
+		}
+		const int32_t From = Occupancy.GetCell(Ship);
+		Occupancy.Arrive(Ship);
+		Planner.OnOccupancyChanged(From);
+
+		//The first move of every ship is not counted, the same as AShip::FirstMove
+		if(State.bFirstMove)
+		{
+			State.bFirstMove = false;
+		}
+		else
+		{
+			Result.CostTaken += Grid->GetTravelCost(Cell);
+		}
+		Result.Moves++;
+		Hash(Step);
+		Hash(Ship);
+		Hash(Cell);
+
+		State.LastNode = Cell;
+		State.Path.PopFront();
+		State.ArriveStep = -1;
+		Done += State.Path.Num() == 0 ? 1 : 0;
+	}
+
+	/*
+	 * The same fallbacks as ALevelGenerator::Replan: around the cell in the way and every held cell, then only around
+	 * the cell in the way, then the plain path and the risk of the crash
+	 */
+	void ShipSimulation::Replan(int32_t Ship, const SimulationSettings& Settings)
+	{
+		ShipState& State = States[Ship];
+		PathQuery Query;
+		Query.Start = Occupancy.GetCell(Ship);
+		Query.Goal = State.Goal;
+		Query.Options.AvoidCell = State.Path[0];
+		Query.Options.bAvoidOccupied = true;
+		Result.Replans++;
+		const ScopedPhaseTimer Timer(Collector, "Replan");
+
+		bool bFound = false;
+		if(Settings.bIncremental)
+		{
+			bFound = Planner.Replan(Ship, Query, Scratch);
+		}
+		else
+		{
+			Planner.RunQuery(0, Query, Scratch);
+			bFound = Scratch.bFound;
+		}
+		Result.Expansions += Scratch.Expansions;
+		if(!bFound)
+		{
+			Query.Options.bAvoidOccupied = false;
+			Planner.RunQuery(0, Query, Scratch);
+			Result.Expansions += Scratch.Expansions;
+			if(!Scratch.bFound)
+			{
+				Query.Options = SearchOptions();
+				Planner.RunQuery(0, Query, Scratch);
+				Result.Expansions += Scratch.Expansions;
+			}
+		}
+		State.Path.Assign(Scratch.Path);
+		if(Markers)
+		{
+			Markers->Add(Scratch.Path);
+		}
+	}
+
+	void ShipSimulation::Hash(int64_t Value)
+	{
+		for(int Byte = 0; Byte < 8; Byte++)
+		{
+			Result.Checksum = (Result.Checksum ^ static_cast<uint8_t>(Value >> (Byte * 8))) * 1099511628211ull;
+		}
+	}
+}
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "BatchPlanner.h"
+#include "GridMap.h"
+#include "OccupancyGrid.h"
+#include "PathMarkerBuffer.h"
+#include "ShipPath.h"
+#include "StatsCollector.h"
+
+namespace Pathfinding
+{
+	struct SimulationSettings
+	{
+		//Steps a move into the next cell takes. 9 is what a ship at 500 units a second with a tolerance of 25 takes at
+		//60 frames a second, the crossing into the next cell is halfway
+		int32_t StepsPerMove = 9;
+		//Steps after which a level stops even with ships short of their goal
+		int32_t StepLimit = 36000;
+		//Replan a ship that would run into another one, like CollisionAndReplanning
+		bool bReplan = true;
+		//Replans repair the ship's kept D* Lite search, like IncrementalReplanning
+		bool bIncremental = true;
+		int32_t CrashPenalty = 50;
+		//0 updates the ships in ship order every step, like the game. Any other seed shuffles that order once per level
+		uint32_t Seed = 0;
+	};
+
+	struct SimulationResult
+	{
+		int32_t Ships = 0;
+		//Ships that reached their goal
+		int32_t Arrived = 0;
+		int32_t Steps = 0;
+		//Sum of the costs of the first plans, then what the ships actually paid the way DetailActual counts it
+		int64_t PlannedCost = 0;
+		int64_t CostTaken = 0;
+		int64_t Moves = 0;
+		int64_t Crashes = 0;
+		int64_t CrashPenalty = 0;
+		int64_t Replans = 0;
+		int64_t Expansions = 0;
+		//FNV-1a over every arrival and crash in the order they happened, equal checksums mean identical runs
+		uint64_t Checksum = 0;
+	};
+
+	/**
+	 * The ship, crash and replan loop of a real time level on a step clock instead of frame time: every move takes
+	 * the same whole number of steps, so the costs, crashes and replans of a level only depend on the map, the
+	 * ships, the planner settings and the seed, never on how fast the frames came. Ships set off through an
+	 * OccupancyGrid with the same conflict check, replans and crash rule as ALevelGenerator::SimulateShips, plans
+	 * and replans run one after another on the first context of the simulation's own BatchPlanner. Nothing is
+	 * rendered and no time is read, a level runs as fast as the searches allow.
+	 */
+	class ShipSimulation
+	{
+
+	public:
+
+		//Set the planner up before SetGrid, the precomputed data is built for the grid there
+		BatchPlanner& GetPlanner() { return Planner; }
+		void SetGrid(const GridMap* InGrid);
+
+		//Plans every ship from its start to its goal and moves them until all are there or StepLimit runs out
+		SimulationResult Run(const std::vector<PathQuery>& Ships, const SimulationSettings& Settings);
+		//Optional, times every first plan and every replan into the collector's current scenario
+		void SetStatsCollector(StatsCollector* InCollector) { Collector = InCollector; }
+		//Optional, gets every plan and replan like ALevelGenerator::RenderPath and is flushed once per step
+		void SetPathMarkers(PathMarkerBuffer* InMarkers) { Markers = InMarkers; }
+
+		const OccupancyGrid& GetOccupancy() const { return Occupancy; }
+
+	private:
+
+		struct ShipState
+		{
+			ShipPath Path;
+			int32_t Goal = NoCell;
+			int32_t LastNode = NoCell;
+			//Step the move under way ends on, -1 while the ship stands
+			int32_t ArriveStep = -1;
+			int32_t PotentialCrash = NoShip;
+			bool bFirstMove = true;
+			bool bAtGoal = false;
+		};
+
+		const GridMap* Grid = nullptr;
+		BatchPlanner Planner;
+		OccupancyGrid Occupancy;
+		std::vector<ShipState> States;
+		std::vector<int32_t> Order;
+		PathResult Scratch;
+		SimulationResult Result;
+		StatsCollector* Collector = nullptr;
+		PathMarkerBuffer* Markers = nullptr;
+		//Ships with nothing left to walk, on their goal or cut off from it
+		int32_t Done = 0;
+
+		void SetOff(int32_t Ship, int32_t Step, const SimulationSettings& Settings);
+		void Arrive(int32_t Ship, int32_t Step, const SimulationSettings& Settings);
+		void Replan(int32_t Ship, const SimulationSettings& Settings);
+		void Hash(int64_t Value);
+	};
+}
@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "StatsCollector.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+
+namespace Pathfinding
+{
+	namespace
+	{
+		void AppendString(std::string& Out, const std::string& Text)
+		{
+			Out += '"';
+			for(const char Character : Text)
+			{
+				if(Character == '"' || Character == '\\')
+				{
+					Out += '\\';
+				}
+				Out += Character;
+			}
+			Out += '"';
+		}
+
+		void AppendMilliseconds(std::string& Out, const char* Key, double Seconds)
+		{
+			char Buffer[64];
+			std::snprintf(Buffer, sizeof(Buffer), "\"%s\": %.6f", Key, Seconds * 1000.0);
+			Out += Buffer;
+		}
+	}
+
+	void StatsCollector::BeginScenario(const std::string& Name)
+	{
+		Scenarios.emplace_back();
+		Scenarios.back().Name = Name;
+	}
+
+	void StatsCollector::AddTime(const char* Phase, double Seconds)
+	{
+		Scenario& Target = Current();
+		auto Found = std::find_if(Target.Phases.begin(), Target.Phases.end(), [Phase](const std::pair<std::string, PhaseTimes>& Entry) { return Entry.first == Phase; });
+		if(Found == Target.Phases.end())
+		{
+			Target.Phases.emplace_back(Phase, PhaseTimes());
+			Found = std::prev(Target.Phases.end());
+			Found->second.MinSeconds = Seconds;
+		}
+		PhaseTimes& Times = Found->second;
+		Times.Count++;
+		Times.TotalSeconds += Seconds;
+		Times.MinSeconds = std::min(Times.MinSeconds, Seconds);
+		Times.MaxSeconds = std::max(Times.MaxSeconds, Seconds);
+	}
+
+	void StatsCollector::AddCount(const char* Name, int64_t Amount)
+	{
+		Counter(Name) += Amount;
+	}
+
+	void StatsCollector::SetMax(const char* Name, int64_t Value)
+	{
+		int64_t& Target = Counter(Name);
+		Target = std::max(Target, Value);
+	}
+
+	const PhaseTimes* StatsCollector::FindPhase(const char* Phase) const
+	{
+		if(Scenarios.empty())
+		{
+			return nullptr;
+		}
+		for(const std::pair<std::string, PhaseTimes>& Entry : Scenarios.back().Phases)
+		{
+			if(Entry.first == Phase)
+			{
+				return &Entry.second;
+			}
+		}
+		return nullptr;
+	}
+
+	int64_t StatsCollector::GetCount(const char* Name) const
+	{
+		if(Scenarios.empty())
+		{
+			return 0;
+		}
+		for(const std::pair<std::string, int64_t>& Entry : Scenarios.back().Counters)
+		{
+			if(Entry.first == Name)
+			{
+				return Entry.second;
+			}
+		}
+		return 0;
+	}
+
+	std::string StatsCollector::ToJson() const
+	{
+		std::string Out = "{\"scenarios\": [";
+		for(size_t Index = 0; Index < Scenarios.size(); Index++)
+		{
+			const Scenario& Written = Scenarios[Index];
+			Out += Index == 0 ? "\n\t{\"name\": " : ",\n\t{\"name\": ";
+			AppendString(Out, Written.Name);
+
+			Out += ", \"phases\": {";
+			for(size_t Phase = 0; Phase < Written.Phases.size(); Phase++)
+			{
+				const PhaseTimes& Times = Written.Phases[Phase].second;
+				Out += Phase == 0 ? "" : ", ";
+				AppendString(Out, Written.Phases[Phase].first);
+				Out += ": {\"count\": " + std::to_string(Times.Count) + ", ";
+				AppendMilliseconds(Out, "total_ms", Times.TotalSeconds);
+				Out += ", ";
+				AppendMilliseconds(Out, "mean_ms", Times.Count > 0 ? Times.TotalSeconds / Times.Count : 0.0);
+				Out += ", ";
+				AppendMilliseconds(Out, "min_ms", Times.MinSeconds);
+				Out += ", ";
+				AppendMilliseconds(Out, "max_ms", Times.MaxSeconds);
+				Out += "}";
+			}
+
+			Out += "}, \"counters\": {";
+			for(size_t Counted = 0; Counted < Written.Counters.size(); Counted++)
+			{
+				Out += Counted == 0 ? "" : ", ";
+				AppendString(Out, Written.Counters[Counted].first);
+				Out += ": " + std::to_string(Written.Counters[Counted].second);
+			}
+			Out += "}}";
+		}
+		Out += Scenarios.empty() ? "]}\n" : "\n]}\n";
+		return Out;
+	}
+
+	StatsCollector::Scenario& StatsCollector::Current()
+	{
+		//Anything recorded before the first BeginScenario still has a home
+		if(Scenarios.empty())
+		{
+			BeginScenario("");
+		}
+		return Scenarios.back();
+	}
+
+	int64_t& StatsCollector::Counter(const char* Name)
+	{
+		Scenario& Target = Current();
+		for(std::pair<std::string, int64_t>& Entry : Target.Counters)
+		{
+			if(Entry.first == Name)
+			{
+				return Entry.second;
+			}
+		}
+		Target.Counters.emplace_back(Name, 0);
+		return Target.Counters.back().second;
+	}
+}
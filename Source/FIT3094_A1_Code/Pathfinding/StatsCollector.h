@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Pathfinding
+{
+	struct PhaseTimes
+	{
+		int64_t Count = 0;
+		double TotalSeconds = 0;
+		double MinSeconds = 0;
+		double MaxSeconds = 0;
+	};
+
+	/**
+	 * Wall time of the phases of a run (map load, spawning, plans, searches, replans) and counters, grouped by
+	 * scenario and written out as JSON. Phases and counters are found by name in the current scenario, a scenario
+	 * only holds a handful of them so a scan beats a map. Nothing here reads a clock, that is ScopedPhaseTimer's job,
+	 * so the owner decides whether to time anything at all. Not thread safe.
+	 */
+	class StatsCollector
+	{
+
+	public:
+
+		//Everything recorded from now on goes into a new scenario of this name
+		void BeginScenario(const std::string& Name);
+		void Clear() { Scenarios.clear(); }
+
+		void AddTime(const char* Phase, double Seconds);
+		void AddCount(const char* Name, int64_t Amount);
+		//Keeps the larger of the counter and Value, for peaks
+		void SetMax(const char* Name, int64_t Value);
+
+		//Null when the current scenario has no such phase
+		const PhaseTimes* FindPhase(const char* Phase) const;
+		int64_t GetCount(const char* Name) const;
+		int GetScenarioCount() const { return static_cast<int>(Scenarios.size()); }
+
+		/*
+		 * {"scenarios": [{"name": ..., "phases": {name: {"count", "total_ms", "mean_ms", "min_ms", "max_ms"}},
+		 * "counters": {name: value}}]} in the order the scenarios were begun
+		 */
+		std::string ToJson() const;
+
+	private:
+
+		struct Scenario
+		{
+			std::string Name;
+			std::vector<std::pair<std::string, PhaseTimes>> Phases;
+			std::vector<std::pair<std::string, int64_t>> Counters;
+		};
+
+		std::vector<Scenario> Scenarios;
+
+		Scenario& Current();
+		int64_t& Counter(const char* Name);
+	};
+
+	//Times its scope into Collector, without a collector it never reads the clock
+	class ScopedPhaseTimer
+	{
+
+	public:
+
+		ScopedPhaseTimer(StatsCollector* InCollector, const char* InPhase)
+			: Collector(InCollector), Phase(InPhase)
+		{
+			if(Collector)
+			{
+				StartTime = std::chrono::steady_clock::now();
+			}
+		}
+		~ScopedPhaseTimer()
+		{
+			if(Collector)
+			{
+				Collector->AddTime(Phase, std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count());
+			}
+		}
+		ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+		ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+	private:
+
+		StatsCollector* Collector;
+		const char* Phase;
+		std::chrono::steady_clock::time_point StartTime;
+	};
+}
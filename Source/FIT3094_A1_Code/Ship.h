@@ -2,8 +2,8 @@
 
 #pragma once
 #include "CoreMinimal.h"
-#include "GridNode.h"
 #include "GameFramework/Actor.h"
+#include "Pathfinding/ShipPath.h"
 #include "Ship.generated.h"
 
 class ALevelGenerator;
@@ -22,9 +22,10 @@ protected:
 	virtual void BeginPlay() override;
 
 public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	//Turns the ship gold, ALevelGenerator::MarkShipAtGoal counts it
+	void MarkAtGoal();
 
+	//Read once when the level generator adds the ship to its ShipFleet, which moves it from then on
 	UPROPERTY(EditAnywhere)
 		float MoveSpeed;
 	UPROPERTY(EditAnywhere)
@@ -33,14 +34,15 @@ public:
 		UMaterial* FinishedMaterial;
 	TArray<UActorComponent*> Meshes;
 
-	TArray<GridNode*> Path;
-	GridNode* GoalNode;
-	GridNode* LastNode;
+	//Cell indices into ALevelGenerator::Grid, ShipId is the index in ALevelGenerator::Ships and its ShipFleet and marks occupied cells
+	//Path[0] is the next cell, arriving there pops it off the front in O(1)
+	Pathfinding::ShipPath Path;
+	int GoalNode;
+	int LastNode;
+	int ShipId = -1;
 	bool FirstMove = true;
 	int CellsSearched = 0;
 	ALevelGenerator* LevelGenerator;
-	FVector Direction;
 	AShip* PotentialCrash = nullptr;
-	bool AtGoal = false;
 
 };
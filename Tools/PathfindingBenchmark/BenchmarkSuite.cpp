@@ -0,0 +1,372 @@
+// Batch benchmark over every MovingAI map in a directory tree.
+
+#include "BenchmarkSuite.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "GridMap.h"
+#include "MapLoader.h"
+
+using namespace Pathfinding;
+namespace fs = std::filesystem;
+
+namespace
+{
+	//Same ladder and start row as ALevelGenerator::Scenarios and TotalIndex
+	const int Scenarios[7] = {1, 2, 5, 10, 25, 50, 100};
+	const int LadderQueries = 193;
+	const int FirstScenarioRow = 200;
+
+	struct Query
+	{
+		int Bucket = 0;
+		int32_t Start = NoCell;
+		int32_t Goal = NoCell;
+		double ScenarioOptimal = -1;
+	};
+
+	struct QueryResult
+	{
+		bool bFound = false;
+		int64_t Expansions = 0;
+		int32_t PathCost = 0;
+		int32_t OptimalCost = 0;
+		double LatencyMicroseconds = 0;
+	};
+
+	int LadderBucketOf(int QueryIndex)
+	{
+		int Level = 0;
+		int Count = Scenarios[0];
+		while(QueryIndex >= Count && Level < 6)
+		{
+			Level++;
+			Count += Scenarios[Level];
+		}
+		return Level;
+	}
+
+	double Percentile(std::vector<double> Values, double Fraction)
+	{
+		if(Values.empty())
+		{
+			return 0;
+		}
+		std::sort(Values.begin(), Values.end());
+		const size_t Rank = static_cast<size_t>(Fraction * (Values.size() - 1) + 0.5);
+		return Values[std::min(Rank, Values.size() - 1)];
+	}
+
+	//Map file stem -> scenario file, a scenario belongs to a map when its name starts with the map name
+	std::map<std::string, fs::path> FindScenarioFiles(const fs::path& Root)
+	{
+		std::vector<fs::path> ScenarioFiles;
+		for(const fs::directory_entry& Entry : fs::recursive_directory_iterator(Root))
+		{
+			if(Entry.is_regular_file() && Entry.path().extension() == ".scen")
+			{
+				ScenarioFiles.push_back(Entry.path());
+			}
+		}
+
+		std::map<std::string, fs::path> Result;
+		for(const fs::directory_entry& Entry : fs::recursive_directory_iterator(Root))
+		{
+			if(!Entry.is_regular_file() || Entry.path().extension() != ".map")
+			{
+				continue;
+			}
+			const std::string Stem = Entry.path().stem().string();
+			for(const fs::path& Scenario : ScenarioFiles)
+			{
+				const std::string ScenarioName = Scenario.filename().string();
+				if(ScenarioName.compare(0, Stem.size(), Stem) == 0 && ScenarioName.size() > Stem.size()
+					&& (ScenarioName[Stem.size()] == '.' || ScenarioName[Stem.size()] == '-'))
+				{
+					Result[Entry.path().string()] = Scenario;
+					break;
+				}
+			}
+		}
+		return Result;
+	}
+
+	bool LoadScenarioQueries(const fs::path& ScenarioPath, const GridMap& Grid, std::vector<Query>& OutQueries)
+	{
+		std::string Text;
+		std::vector<ScenarioEntry> Entries;
+		if(!LoadTextFile(ScenarioPath.string(), Text) || !ParseScenario(Text, Entries))
+		{
+			return false;
+		}
+
+		//Use the rows the game plays when the file is long enough, otherwise start at the top
+		const int FirstRow = static_cast<int>(Entries.size()) >= FirstScenarioRow + LadderQueries ? FirstScenarioRow : 0;
+		for(int i = 0; i < LadderQueries && FirstRow + i < static_cast<int>(Entries.size()); i++)
+		{
+			const ScenarioEntry& Entry = Entries[FirstRow + i];
+			if(!Grid.IsInside(Entry.StartX, Entry.StartY) || !Grid.IsInside(Entry.GoalX, Entry.GoalY))
+			{
+				continue;
+			}
+			Query NewQuery;
+			NewQuery.Bucket = LadderBucketOf(i);
+			NewQuery.Start = Grid.ToIndex(Entry.StartX, Entry.StartY);
+			NewQuery.Goal = Grid.ToIndex(Entry.GoalX, Entry.GoalY);
+			NewQuery.ScenarioOptimal = Entry.OptimalLength;
+			OutQueries.push_back(NewQuery);
+		}
+		return !OutQueries.empty();
+	}
+
+	//Random water start and goal pairs that are connected, checked with the optimal planner
+	void GenerateQueries(const GridMap& Grid, PathPlanner& OptimalPlanner, uint32_t Seed, std::vector<Query>& OutQueries)
+	{
+		std::vector<int32_t> WaterCells;
+		for(int Y = 0; Y < Grid.GetHeight(); Y++)
+		{
+			for(int X = 0; X < Grid.GetWidth(); X++)
+			{
+				if(Grid.IsPassable(Grid.ToIndex(X, Y)))
+				{
+					WaterCells.push_back(Grid.ToIndex(X, Y));
+				}
+			}
+		}
+		if(WaterCells.size() < 2)
+		{
+			return;
+		}
+
+		std::mt19937 Random(Seed);
+		std::uniform_int_distribution<size_t> Pick(0, WaterCells.size() - 1);
+		std::vector<int32_t> Path;
+		const int MaxAttempts = LadderQueries * 20;
+
+		for(int Attempt = 0; Attempt < MaxAttempts && static_cast<int>(OutQueries.size()) < LadderQueries; Attempt++)
+		{
+			Query NewQuery;
+			NewQuery.Start = WaterCells[Pick(Random)];
+			NewQuery.Goal = WaterCells[Pick(Random)];
+			if(NewQuery.Start == NewQuery.Goal || !OptimalPlanner.FindPath(NewQuery.Start, NewQuery.Goal, Path))
+			{
+				continue;
+			}
+			NewQuery.Bucket = LadderBucketOf(static_cast<int>(OutQueries.size()));
+			OutQueries.push_back(NewQuery);
+		}
+	}
+
+	QueryResult RunQuery(PathPlanner& Planner, PathPlanner& OptimalPlanner, const Query& Item, const SuiteOptions& Options)
+	{
+		QueryResult Result;
+		std::vector<int32_t> Path;
+
+		OptimalPlanner.FindPath(Item.Start, Item.Goal, Path);
+		Result.OptimalCost = OptimalPlanner.GetLastPathCost();
+
+		for(int i = 0; i < Options.WarmupRuns; i++)
+		{
+			Planner.FindPath(Item.Start, Item.Goal, Path);
+		}
+
+		double TotalMicroseconds = 0;
+		const int Repetitions = std::max(1, Options.Repetitions);
+		for(int i = 0; i < Repetitions; i++)
+		{
+			const auto StartTime = std::chrono::steady_clock::now();
+			Result.bFound = Planner.FindPath(Item.Start, Item.Goal, Path);
+			TotalMicroseconds += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - StartTime).count();
+		}
+
+		Result.LatencyMicroseconds = TotalMicroseconds / Repetitions;
+		Result.Expansions = Planner.GetLastExpansions();
+		Result.PathCost = Planner.GetLastPathCost();
+		return Result;
+	}
+}
+
+void PrepareSearchData(PathPlanner& Planner, const GridMap& Grid, const PlannerSetup& Setup, SearchData& OutData)
+{
+	const auto StartTime = std::chrono::steady_clock::now();
+	Planner.SetHeuristicWeight(Setup.Weight);
+	Planner.SetSearchMode(Setup.Mode);
+	//Every mode rejects unreachable goals with the component labels
+	OutData.Components.Build(Grid);
+	Planner.SetComponents(&OutData.Components, nullptr);
+	OutData.MemoryBytes = OutData.Components.GetMemoryBytes();
+	if(Setup.Mode == SearchMode::JumpPoint)
+	{
+		OutData.Jumps.Build(Grid);
+		Planner.SetJumpTable(&OutData.Jumps);
+		OutData.MemoryBytes += OutData.Jumps.GetMemoryBytes();
+	}
+	else if(Setup.Mode == SearchMode::Hierarchical)
+	{
+		OutData.Sectors.Build(Grid, Setup.SectorSize);
+		Planner.SetSectorGraph(&OutData.Sectors);
+		OutData.MemoryBytes += OutData.Sectors.GetMemoryBytes();
+	}
+	if(Setup.Landmarks > 0)
+	{
+		OutData.Landmarks.Build(Grid, Setup.Landmarks, Setup.Selection);
+		Planner.SetLandmarks(&OutData.Landmarks);
+		OutData.MemoryBytes += OutData.Landmarks.GetMemoryBytes();
+	}
+	OutData.BuildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+}
+
+const char* SearchModeName(SearchMode Mode)
+{
+	switch(Mode)
+	{
+	case SearchMode::JumpPoint:
+		return "jps";
+	case SearchMode::Hierarchical:
+		return "hpa";
+	default:
+		return "astar";
+	}
+}
+
+int RunBenchmarkSuite(const SuiteOptions& Options)
+{
+	const fs::path Root(Options.RootDirectory);
+	if(!fs::is_directory(Root))
+	{
+		std::fprintf(stderr, "Not a directory: %s\n", Options.RootDirectory.c_str());
+		return 0;
+	}
+
+	std::vector<fs::path> MapFiles;
+	for(const fs::directory_entry& Entry : fs::recursive_directory_iterator(Root))
+	{
+		if(Entry.is_regular_file() && Entry.path().extension() == ".map")
+		{
+			MapFiles.push_back(Entry.path());
+		}
+	}
+	std::sort(MapFiles.begin(), MapFiles.end());
+	const std::map<std::string, fs::path> ScenarioFiles = FindScenarioFiles(Root);
+
+	std::ofstream Csv;
+	std::ofstream Json;
+	if(!Options.CsvPath.empty())
+	{
+		Csv.open(Options.CsvPath);
+		Csv << "map,query,bucket,start_x,start_y,goal_x,goal_y,found,expansions,path_cost,optimal_cost,suboptimality,scen_optimal,latency_us\n";
+	}
+	if(!Options.JsonPath.empty())
+	{
+		Json.open(Options.JsonPath);
+		Json << "{\n  \"weight\": " << Options.Setup.Weight << ",\n  \"mode\": \"" << SearchModeName(Options.Setup.Mode) << "\",\n  \"landmarks\": " << Options.Setup.Landmarks
+			<< ",\n  \"warmup\": " << Options.WarmupRuns
+			<< ",\n  \"repetitions\": " << Options.Repetitions << ",\n  \"maps\": [";
+	}
+
+	std::printf("%-24s %6s %5s %8s %10s %10s %10s %10s %9s %9s\n",
+		"map", "source", "qry", "unreach", "exp_mean", "p50_us", "p90_us", "p99_us", "sub_mean", "sub_max");
+
+	int MapsRun = 0;
+	for(const fs::path& MapPath : MapFiles)
+	{
+		std::string MapText;
+		GridMap Grid;
+		if(!LoadTextFile(MapPath.string(), MapText) || !ParseMap(MapText, Grid))
+		{
+			std::fprintf(stderr, "Skipping unreadable map %s\n", MapPath.string().c_str());
+			continue;
+		}
+
+		PathPlanner Planner;
+		Planner.SetGrid(&Grid);
+		SearchData Data;
+		PrepareSearchData(Planner, Grid, Options.Setup, Data);
+		PathPlanner OptimalPlanner;
+		OptimalPlanner.SetGrid(&Grid);
+		OptimalPlanner.SetHeuristicWeight(0);
+
+		std::vector<Query> Queries;
+		const auto ScenarioFile = ScenarioFiles.find(MapPath.string());
+		const bool bFromScenario = ScenarioFile != ScenarioFiles.end() && LoadScenarioQueries(ScenarioFile->second, Grid, Queries);
+		if(!bFromScenario)
+		{
+			Queries.clear();
+			GenerateQueries(Grid, OptimalPlanner, Options.Seed, Queries);
+		}
+		if(Queries.empty())
+		{
+			continue;
+		}
+
+		std::vector<double> Latencies;
+		std::vector<double> Suboptimality;
+		int64_t TotalExpansions = 0;
+		int Unreachable = 0;
+		const std::string MapName = MapPath.filename().string();
+
+		for(size_t i = 0; i < Queries.size(); i++)
+		{
+			const Query& Item = Queries[i];
+			const QueryResult Result = RunQuery(Planner, OptimalPlanner, Item, Options);
+			const double Ratio = Result.bFound && Result.OptimalCost > 0 ? static_cast<double>(Result.PathCost) / Result.OptimalCost : 1.0;
+
+			Latencies.push_back(Result.LatencyMicroseconds);
+			TotalExpansions += Result.Expansions;
+			if(Result.bFound)
+			{
+				Suboptimality.push_back(Ratio);
+			}
+			else
+			{
+				Unreachable++;
+			}
+
+			if(Csv.is_open())
+			{
+				Csv << MapName << ',' << i << ',' << Item.Bucket << ','
+					<< Grid.GetX(Item.Start) << ',' << Grid.GetY(Item.Start) << ',' << Grid.GetX(Item.Goal) << ',' << Grid.GetY(Item.Goal) << ','
+					<< (Result.bFound ? 1 : 0) << ',' << Result.Expansions << ',' << Result.PathCost << ',' << Result.OptimalCost << ','
+					<< Ratio << ',' << Item.ScenarioOptimal << ',' << Result.LatencyMicroseconds << '\n';
+			}
+		}
+
+		double SuboptimalityMean = 0;
+		for(const double Value : Suboptimality)
+		{
+			SuboptimalityMean += Value;
+		}
+		SuboptimalityMean = Suboptimality.empty() ? 0 : SuboptimalityMean / Suboptimality.size();
+		const double SuboptimalityMax = Suboptimality.empty() ? 0 : *std::max_element(Suboptimality.begin(), Suboptimality.end());
+		const double ExpansionsMean = static_cast<double>(TotalExpansions) / Queries.size();
+		const double P50 = Percentile(Latencies, 0.50);
+		const double P90 = Percentile(Latencies, 0.90);
+		const double P99 = Percentile(Latencies, 0.99);
+
+		std::printf("%-24s %6s %5zu %8d %10.1f %10.2f %10.2f %10.2f %9.4f %9.4f\n",
+			MapName.c_str(), bFromScenario ? "scen" : "gen", Queries.size(), Unreachable, ExpansionsMean, P50, P90, P99, SuboptimalityMean, SuboptimalityMax);
+
+		if(Json.is_open())
+		{
+			Json << (MapsRun > 0 ? "," : "") << "\n    {\"map\": \"" << MapName << "\", \"width\": " << Grid.GetWidth() << ", \"height\": " << Grid.GetHeight()
+				<< ", \"source\": \"" << (bFromScenario ? "scen" : "generated") << "\", \"queries\": " << Queries.size()
+				<< ", \"unreachable\": " << Unreachable << ", \"expansions_total\": " << TotalExpansions << ", \"expansions_mean\": " << ExpansionsMean
+				<< ", \"latency_us\": {\"p50\": " << P50 << ", \"p90\": " << P90 << ", \"p99\": " << P99
+				<< ", \"max\": " << Percentile(Latencies, 1.0) << "}, \"suboptimality\": {\"mean\": " << SuboptimalityMean << ", \"max\": " << SuboptimalityMax << "}}";
+		}
+		MapsRun++;
+	}
+
+	if(Json.is_open())
+	{
+		Json << "\n  ]\n}\n";
+	}
+	return MapsRun;
+}
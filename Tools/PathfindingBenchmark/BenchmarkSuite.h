@@ -0,0 +1,58 @@
+// Batch benchmark over every MovingAI map in a directory tree.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ConnectedComponents.h"
+#include "JumpTable.h"
+#include "LandmarkTable.h"
+#include "PathPlanner.h"
+#include "SectorGraph.h"
+
+//How the planner under test searches, shared by every benchmark mode
+struct PlannerSetup
+{
+	int Weight = 2;
+	Pathfinding::SearchMode Mode = Pathfinding::SearchMode::AStar;
+	int SectorSize = 16;
+	int Landmarks = 0;
+	Pathfinding::LandmarkSelection Selection = Pathfinding::LandmarkSelection::Farthest;
+};
+
+struct SuiteOptions
+{
+	std::string RootDirectory;
+	std::string CsvPath;
+	std::string JsonPath;
+	PlannerSetup Setup;
+	int WarmupRuns = 1;
+	int Repetitions = 5;
+	uint32_t Seed = 3094;
+};
+
+//Precomputed data a PathPlanner reads, owned by the benchmark
+struct SearchData
+{
+	Pathfinding::JumpTable Jumps;
+	Pathfinding::SectorGraph Sectors;
+	Pathfinding::LandmarkTable Landmarks;
+	Pathfinding::ConnectedComponents Components;
+	double BuildMilliseconds = 0;
+	size_t MemoryBytes = 0;
+};
+
+//Configure Planner and build whatever the setup precomputes for Grid
+void PrepareSearchData(Pathfinding::PathPlanner& Planner, const Pathfinding::GridMap& Grid, const PlannerSetup& Setup, SearchData& OutData);
+const char* SearchModeName(Pathfinding::SearchMode Mode);
+
+/*
+ * Run the planner over every .map below RootDirectory.
+ * Queries come from the matching .scen file when there is one (same ladder as the game),
+ * otherwise a ladder of reachable random queries is generated from Seed.
+ * Every query is compared against an optimal Dijkstra search with the same cost model.
+ * Returns the number of maps that were benchmarked.
+ */
+int RunBenchmarkSuite(const SuiteOptions& Options);
@@ -0,0 +1,2031 @@
+// Headless benchmark for the pathfinding core.
+// Runs the same scenario ladder as ALevelGenerator::NextLevel and reports expansions, path cost and wall time.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BatchPlanner.h"
+#include "BenchmarkSuite.h"
+#include "ConflictSearch.h"
+#include "ConnectedComponents.h"
+#include "CookedMap.h"
+#include "CooperativePlanner.h"
+#include "GoalFieldCache.h"
+#include "GridMap.h"
+#include "MapLoader.h"
+#include "OccupancyGrid.h"
+#include "PathMarkerBuffer.h"
+#include "PathPlanner.h"
+#include "ShipFleet.h"
+#include "ShipPath.h"
+#include "ShipSimulation.h"
+#include "StatsCollector.h"
+
+using namespace Pathfinding;
+
+namespace
+{
+	//Same ladder and start row as ALevelGenerator::Scenarios and TotalIndex
+	const int Scenarios[7] = {1, 2, 5, 10, 25, 50, 100};
+	const int FirstScenarioRow = 200;
+
+	struct Options
+	{
+		std::string MapPath = std::string(PATHFINDING_CONTENT_DIR) + "/Assessed/Map/ht_chantry.map";
+		std::string ScenarioPath = std::string(PATHFINDING_CONTENT_DIR) + "/Assessed/Scen/ht_chantry-random-10.scen";
+		PlannerSetup Setup;
+		bool bPrintRows = false;
+		bool bSuite = false;
+		bool bScaling = false;
+		bool bReplan = false;
+		bool bCooperative = false;
+		bool bConflictSearch = false;
+		double Suboptimality = 1.2;
+		double BudgetMilliseconds = 1000;
+		int MaxNodes = 20000;
+		int Window = 32;
+		int GoalFieldCapacity = 64;
+		bool bShipUpdate = false;
+		bool bFleet = false;
+		bool bReplay = false;
+		bool bMarkers = false;
+		SimulationSettings Replay;
+		std::vector<int> FleetSizes = {100, 1000, 10000};
+		bool bOccupancy = false;
+		bool bPathCache = false;
+		int PathCacheKB = 1024;
+		bool bLoadTimes = false;
+		std::string LoadDirectory;
+		bool bCook = false;
+		std::string CookPath;
+		bool bLandmarksGiven = false;
+		int Threads = 0;
+		SuiteOptions Suite;
+	};
+
+	void PrintUsage()
+	{
+		std::printf("Usage: PathfindingBenchmark [--map <file.map>] [--scen <file.scen>] [--weight <w>] [--jps | --hpa [<sector size>]] [--landmarks <k>] [--rows]\n");
+		std::printf("       PathfindingBenchmark --scaling [--map <file.map>] [--scen <file.scen>] [--jps | --hpa [<sector size>]] [--threads <max>] [--reps <n>]\n");
+		std::printf("       --landmarks <k> adds an ALT heuristic with k landmarks, --landmark-select farthest|random picks them\n");
+		std::printf("       PathfindingBenchmark --replan [--map <file.map>] [--scen <file.scen>] [--landmarks <k>] [--goal-fields <capacity>]\n");
+		std::printf("       PathfindingBenchmark --cooperative [--map <file.map>] [--scen <file.scen>] [--window <steps>]\n");
+		std::printf("       PathfindingBenchmark --cbs [--map <file.map>] [--scen <file.scen>] [--suboptimality <w>] [--budget <ms>] [--max-nodes <n>]\n");
+		std::printf("       PathfindingBenchmark --path-cache [<KB>] [--map <file.map>] [--scen <file.scen>] [--weight <w>] [--jps | --hpa [<sector size>]] [--landmarks <k>]\n");
+		std::printf("       PathfindingBenchmark --occupancy [--map <file.map>] [--scen <file.scen>]\n");
+		std::printf("       PathfindingBenchmark --ship-update [--map <file.map>] [--scen <file.scen>] [--window <steps>] [--reps <n>]\n");
+		std::printf("       PathfindingBenchmark --replay [--map <file.map>] [--scen <file.scen>] [--seed <n>] [--reps <n>] [--no-replan] [--fresh-replans] [--landmarks <k>] [--json <file>]\n");
+		std::printf("       PathfindingBenchmark --markers [--map <file.map>] [--scen <file.scen>] [--seed <n>] [--landmarks <k>]\n");
+		std::printf("       PathfindingBenchmark --fleet [<ships,ships,...>] [--map <file.map>] [--scen <file.scen>] [--seed <n>]\n");
+		std::printf("       PathfindingBenchmark --load-times [<dir>] [--reps <n>]\n");
+		std::printf("       PathfindingBenchmark --cook [<file.map | dir>] [--landmarks <k>] [--landmark-select farthest|random]\n");
+		std::printf("       PathfindingBenchmark --suite [<dir>] [--weight <w>] [--jps | --hpa [<sector size>]] [--warmup <n>] [--reps <n>] [--seed <n>] [--csv <file>] [--json <file>]\n");
+	}
+
+	bool ParseOptions(int Argc, char** Argv, Options& Out)
+	{
+		for(int i = 1; i < Argc; i++)
+		{
+			const char* Arg = Argv[i];
+			const bool bHasValue = i + 1 < Argc;
+			if(std::strcmp(Arg, "--map") == 0 && bHasValue)
+			{
+				Out.MapPath = Argv[++i];
+			}
+			else if(std::strcmp(Arg, "--scen") == 0 && bHasValue)
+			{
+				Out.ScenarioPath = Argv[++i];
+			}
+			else if(std::strcmp(Arg, "--weight") == 0 && bHasValue)
+			{
+				Out.Setup.Weight = std::atoi(Argv[++i]);
+			}
+			else if(std::strcmp(Arg, "--jps") == 0)
+			{
+				Out.Setup.Mode = SearchMode::JumpPoint;
+			}
+			else if(std::strcmp(Arg, "--hpa") == 0)
+			{
+				Out.Setup.Mode = SearchMode::Hierarchical;
+				if(bHasValue && Argv[i + 1][0] != '-')
+				{
+					Out.Setup.SectorSize = std::atoi(Argv[++i]);
+				}
+			}
+			else if(std::strcmp(Arg, "--landmarks") == 0 && bHasValue)
+			{
+				Out.Setup.Landmarks = std::atoi(Argv[++i]);
+				Out.bLandmarksGiven = true;
+			}
+			else if(std::strcmp(Arg, "--landmark-select") == 0 && bHasValue)
+			{
+				const char* Name = Argv[++i];
+				if(std::strcmp(Name, "random") == 0)
+				{
+					Out.Setup.Selection = LandmarkSelection::Random;
+				}
+				else if(std::strcmp(Name, "farthest") == 0)
+				{
+					Out.Setup.Selection = LandmarkSelection::Farthest;
+				}
+				else
+				{
+					return false;
+				}
+			}
+			else if(std::strcmp(Arg, "--rows") == 0)
+			{
+				Out.bPrintRows = true;
+			}
+			else if(std::strcmp(Arg, "--suite") == 0)
+			{
+				Out.bSuite = true;
+				Out.Suite.RootDirectory = bHasValue && Argv[i + 1][0] != '-' ? Argv[++i] : PATHFINDING_CONTENT_DIR;
+			}
+			else if(std::strcmp(Arg, "--load-times") == 0)
+			{
+				Out.bLoadTimes = true;
+				Out.LoadDirectory = bHasValue && Argv[i + 1][0] != '-' ? Argv[++i] : std::string(PATHFINDING_CONTENT_DIR) + "/Other Maps";
+			}
+			else if(std::strcmp(Arg, "--cook") == 0)
+			{
+				Out.bCook = true;
+				Out.CookPath = bHasValue && Argv[i + 1][0] != '-' ? Argv[++i] : PATHFINDING_CONTENT_DIR;
+			}
+			else if(std::strcmp(Arg, "--cooperative") == 0)
+			{
+				Out.bCooperative = true;
+			}
+			else if(std::strcmp(Arg, "--cbs") == 0)
+			{
+				Out.bConflictSearch = true;
+			}
+			else if(std::strcmp(Arg, "--suboptimality") == 0 && bHasValue)
+			{
+				Out.Suboptimality = std::atof(Argv[++i]);
+			}
+			else if(std::strcmp(Arg, "--budget") == 0 && bHasValue)
+			{
+				Out.BudgetMilliseconds = std::atof(Argv[++i]);
+			}
+			else if(std::strcmp(Arg, "--max-nodes") == 0 && bHasValue)
+			{
+				Out.MaxNodes = std::atoi(Argv[++i]);
+			}
+			else if(std::strcmp(Arg, "--window") == 0 && bHasValue)
+			{
+				Out.Window = std::atoi(Argv[++i]);
+			}
+			else if(std::strcmp(Arg, "--replan") == 0)
+			{
+				Out.bReplan = true;
+			}
+			else if(std::strcmp(Arg, "--path-cache") == 0)
+			{
+				Out.bPathCache = true;
+				if(bHasValue && Argv[i + 1][0] != '-')
+				{
+					Out.PathCacheKB = std::atoi(Argv[++i]);
+				}
+			}
+			else if(std::strcmp(Arg, "--occupancy") == 0)
+			{
+				Out.bOccupancy = true;
+			}
+			else if(std::strcmp(Arg, "--ship-update") == 0)
+			{
+				Out.bShipUpdate = true;
+			}
+			else if(std::strcmp(Arg, "--replay") == 0)
+			{
+				Out.bReplay = true;
+			}
+			else if(std::strcmp(Arg, "--markers") == 0)
+			{
+				Out.bMarkers = true;
+			}
+			else if(std::strcmp(Arg, "--no-replan") == 0)
+			{
+				Out.Replay.bReplan = false;
+			}
+			else if(std::strcmp(Arg, "--fresh-replans") == 0)
+			{
+				Out.Replay.bIncremental = false;
+			}
+			else if(std::strcmp(Arg, "--fleet") == 0)
+			{
+				Out.bFleet = true;
+				if(bHasValue && Argv[i + 1][0] != '-')
+				{
+					Out.FleetSizes.clear();
+					std::stringstream Sizes(Argv[++i]);
+					std::string Size;
+					while(std::getline(Sizes, Size, ','))
+					{
+						Out.FleetSizes.push_back(std::max(1, std::atoi(Size.c_str())));
+					}
+				}
+			}
+			else if(std::strcmp(Arg, "--goal-fields") == 0 && bHasValue)
+			{
+				Out.GoalFieldCapacity = std::atoi(Argv[++i]);
+			}
+			else if(std::strcmp(Arg, "--scaling") == 0)
+			{
+				Out.bScaling = true;
+			}
+			else if(std::strcmp(Arg, "--threads") == 0 && bHasValue)
+			{
+				Out.Threads = std::atoi(Argv[++i]);
+			}
+			else if(std::strcmp(Arg, "--warmup") == 0 && bHasValue)
+			{
+				Out.Suite.WarmupRuns = std::atoi(Argv[++i]);
+			}
+			else if(std::strcmp(Arg, "--reps") == 0 && bHasValue)
+			{
+				Out.Suite.Repetitions = std::atoi(Argv[++i]);
+			}
+			else if(std::strcmp(Arg, "--seed") == 0 && bHasValue)
+			{
+				Out.Suite.Seed = static_cast<uint32_t>(std::strtoul(Argv[++i], nullptr, 10));
+				Out.Replay.Seed = Out.Suite.Seed;
+			}
+			else if(std::strcmp(Arg, "--csv") == 0 && bHasValue)
+			{
+				Out.Suite.CsvPath = Argv[++i];
+			}
+			else if(std::strcmp(Arg, "--json") == 0 && bHasValue)
+			{
+				Out.Suite.JsonPath = Argv[++i];
+			}
+			else
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	double MillisecondsSince(std::chrono::steady_clock::time_point Start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+	}
+
+	bool SameResults(const std::vector<PathResult>& A, const std::vector<PathResult>& B)
+	{
+		if(A.size() != B.size())
+		{
+			return false;
+		}
+		for(size_t i = 0; i < A.size(); i++)
+		{
+			if(A[i].bFound != B[i].bFound || A[i].PathCost != B[i].PathCost || A[i].Expansions != B[i].Expansions || A[i].Path != B[i].Path)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//The way the game used to read a map: one string per line, a char grid copied out of them and two more copies passed by value
+	bool ParseMapByLines(const std::string& Text, GridMap& OutGrid)
+	{
+		std::istringstream Stream(Text);
+		std::vector<std::string> Lines;
+		std::string Line;
+		while(std::getline(Stream, Line))
+		{
+			Lines.push_back(Line);
+		}
+		if(Lines.size() < 4)
+		{
+			return false;
+		}
+		const int Height = std::atoi(Lines[1].c_str() + 7);
+		const int Width = std::atoi(Lines[2].c_str() + 6);
+		if(Width <= 0 || Height <= 0 || static_cast<int>(Lines.size()) < Height + 4)
+		{
+			return false;
+		}
+
+		std::vector<std::vector<char>> CharGrid(Height, std::vector<char>(Width, 'x'));
+		for(int Y = 0; Y < Height; Y++)
+		{
+			for(int X = 0; X < Width && X < static_cast<int>(Lines[Y + 4].size()); X++)
+			{
+				CharGrid[Y][X] = Lines[Y + 4][X];
+			}
+		}
+
+		const std::vector<std::vector<char>> NodeGridCopy = CharGrid;
+		const std::vector<std::vector<char>> ActorCopy = CharGrid;
+		OutGrid.Init(Width, Height);
+		for(int Y = 0; Y < Height; Y++)
+		{
+			for(int X = 0; X < Width; X++)
+			{
+				OutGrid.SetTerrain(X, Y, GridMap::TerrainFromChar(NodeGridCopy[Y][X]));
+			}
+		}
+		return ActorCopy.size() == NodeGridCopy.size();
+	}
+
+	/*
+	 * Times reading and decoding the largest maps under Directory, once with LoadTextFile + ParseMap and once the
+	 * line by line way the game used before, and checks that both produce the same grid.
+	 */
+	int RunLoadTimes(const Options& Opts)
+	{
+		namespace fs = std::filesystem;
+
+		std::vector<std::pair<uintmax_t, fs::path>> MapFiles;
+		std::error_code Error;
+		for(const fs::directory_entry& Entry : fs::recursive_directory_iterator(Opts.LoadDirectory, Error))
+		{
+			if(Entry.is_regular_file() && Entry.path().extension() == ".map")
+			{
+				MapFiles.emplace_back(Entry.file_size(), Entry.path());
+			}
+		}
+		if(MapFiles.empty())
+		{
+			std::fprintf(stderr, "No .map files under %s\n", Opts.LoadDirectory.c_str());
+			return 1;
+		}
+		std::sort(MapFiles.begin(), MapFiles.end(), [](const auto& A, const auto& B) { return A.first > B.first; });
+		MapFiles.resize(std::min<size_t>(MapFiles.size(), 8));
+
+		//The maps are small, so every timing is the mean of many loads
+		const int Loads = 200 * std::max(1, Opts.Suite.Repetitions);
+		std::printf("%d loads per map\n", Loads);
+		std::printf("%-16s %9s %10s %10s %10s %8s %s\n", "map", "bytes", "cells", "fast_us", "lines_us", "speedup", "grid");
+
+		bool bAllSame = true;
+		std::string Text;
+		GridMap Fast;
+		GridMap Reference;
+		for(const auto& [Bytes, MapPath] : MapFiles)
+		{
+			auto StartTime = std::chrono::steady_clock::now();
+			bool bLoaded = true;
+			for(int Run = 0; Run < Loads && bLoaded; Run++)
+			{
+				bLoaded = LoadTextFile(MapPath.string(), Text) && ParseMap(Text, Fast);
+			}
+			const double FastMicroseconds = MillisecondsSince(StartTime) * 1000.0 / Loads;
+
+			StartTime = std::chrono::steady_clock::now();
+			for(int Run = 0; Run < Loads && bLoaded; Run++)
+			{
+				std::string LineText;
+				bLoaded = LoadTextFile(MapPath.string(), LineText) && ParseMapByLines(LineText, Reference);
+			}
+			const double LinesMicroseconds = MillisecondsSince(StartTime) * 1000.0 / Loads;
+
+			bool bSame = bLoaded && Fast.GetWidth() == Reference.GetWidth() && Fast.GetHeight() == Reference.GetHeight();
+			for(int32_t Cell = 0; bSame && Cell < Fast.Num(); Cell++)
+			{
+				bSame = Fast.GetTravelCost(Cell) == Reference.GetTravelCost(Cell);
+			}
+			bAllSame = bAllSame && bSame;
+			std::printf("%-16s %9ju %10d %10.2f %10.2f %7.2fx %s\n", MapPath.filename().string().c_str(), Bytes, Fast.GetWidth() * Fast.GetHeight(),
+				FastMicroseconds, LinesMicroseconds, LinesMicroseconds / FastMicroseconds, bSame ? "identical" : "DIFFERENT");
+		}
+		return bAllSame ? 0 : 1;
+	}
+
+	bool WriteBinaryFile(const std::string& Path, const std::vector<uint8_t>& Bytes)
+	{
+		std::ofstream File(Path, std::ios::binary | std::ios::trunc);
+		File.write(reinterpret_cast<const char*>(Bytes.data()), static_cast<std::streamsize>(Bytes.size()));
+		return static_cast<bool>(File);
+	}
+
+	/*
+	 * Cooks every .map under Path (or the single file) into a .cmap next to it, then reads each one back, checks it
+	 * against the text map and compares loading the cooked file with parsing the text and rebuilding the same data.
+	 */
+	int RunCook(const Options& Opts)
+	{
+		namespace fs = std::filesystem;
+
+		std::vector<fs::path> MapFiles;
+		std::error_code Error;
+		if(fs::is_directory(Opts.CookPath, Error))
+		{
+			for(const fs::directory_entry& Entry : fs::recursive_directory_iterator(Opts.CookPath, Error))
+			{
+				if(Entry.is_regular_file() && Entry.path().extension() == ".map")
+				{
+					MapFiles.push_back(Entry.path());
+				}
+			}
+			std::sort(MapFiles.begin(), MapFiles.end());
+		}
+		else
+		{
+			MapFiles.push_back(Opts.CookPath);
+		}
+
+		CookOptions Cook;
+		//Without --landmarks the maps are cooked with the level generator's default LandmarkCount
+		Cook.LandmarkCount = Opts.bLandmarksGiven ? Opts.Setup.Landmarks : 8;
+		Cook.Selection = Opts.Setup.Selection;
+		std::printf("cooking %zu maps with %d landmarks\n", MapFiles.size(), Cook.LandmarkCount);
+		std::printf("%-24s %9s %9s %6s %10s %10s %s\n", "map", "src_bytes", "cmap_KB", "comps", "text_ms", "cooked_ms", "check");
+
+		int Failed = 0;
+		std::string Text;
+		std::string CookedText;
+		std::vector<uint8_t> Bytes;
+		for(const fs::path& MapPath : MapFiles)
+		{
+			const fs::path CookedPath = fs::path(MapPath).replace_extension(".cmap");
+			if(!LoadTextFile(MapPath.string(), Text) || !CookMap(Text.data(), Text.size(), Cook, Bytes) || !WriteBinaryFile(CookedPath.string(), Bytes))
+			{
+				std::fprintf(stderr, "Could not cook %s\n", MapPath.string().c_str());
+				Failed++;
+				continue;
+			}
+
+			//What a load without the cooked file has to do
+			auto StartTime = std::chrono::steady_clock::now();
+			GridMap TextGrid;
+			ConnectedComponents TextComponents;
+			LandmarkTable TextLandmarks;
+			LoadTextFile(MapPath.string(), Text);
+			ParseMap(Text, TextGrid);
+			TextComponents.Build(TextGrid);
+			TextLandmarks.Build(TextGrid, Cook.LandmarkCount, Cook.Selection, Cook.LandmarkSeed);
+			const double TextMilliseconds = MillisecondsSince(StartTime);
+
+			StartTime = std::chrono::steady_clock::now();
+			GridMap CookedGrid;
+			ConnectedComponents CookedComponents;
+			LandmarkTable CookedLandmarks;
+			CookedMapInfo Info;
+			bool bOk = LoadTextFile(CookedPath.string(), CookedText) && ReadCookedMapInfo(reinterpret_cast<const uint8_t*>(CookedText.data()), CookedText.size(), Info)
+				&& IsCookedMapCurrent(Info, Text.data(), Text.size())
+				&& ReadCookedMap(reinterpret_cast<const uint8_t*>(CookedText.data()), CookedText.size(), CookedGrid, &CookedComponents, &CookedLandmarks);
+			const double CookedMilliseconds = MillisecondsSince(StartTime);
+
+			bOk = bOk && CookedGrid.GetWidth() == TextGrid.GetWidth() && CookedGrid.GetHeight() == TextGrid.GetHeight()
+				&& CookedComponents.GetIds() == TextComponents.GetIds() && CookedLandmarks.GetLandmarks() == TextLandmarks.GetLandmarks()
+				&& CookedLandmarks.GetForward() == TextLandmarks.GetForward() && CookedLandmarks.GetBackward() == TextLandmarks.GetBackward();
+			for(int32_t Cell = 0; bOk && Cell < TextGrid.Num(); Cell++)
+			{
+				bOk = CookedGrid.GetTravelCost(Cell) == TextGrid.GetTravelCost(Cell);
+			}
+			Failed += bOk ? 0 : 1;
+			std::printf("%-24s %9zu %9.1f %6d %10.3f %10.3f %s\n", MapPath.filename().string().c_str(), Text.size(), Bytes.size() / 1024.0,
+				Info.ComponentCount, TextMilliseconds, CookedMilliseconds, bOk ? "ok" : "MISMATCH");
+		}
+		return Failed == 0 ? 0 : 1;
+	}
+
+	//Ticks --replan simulates at most, a little more than the longest ladder path needs
+	constexpr int ReplanTickLimit = 2000;
+
+	//The ships of one level of the ladder, Level 6 is the last one with 100 ships
+	std::vector<PathQuery> LevelQueries(const GridMap& Grid, const std::vector<ScenarioEntry>& Entries, int Level)
+	{
+		int FirstRow = FirstScenarioRow;
+		for(int Previous = 0; Previous < Level; Previous++)
+		{
+			FirstRow += Scenarios[Previous];
+		}
+
+		std::vector<PathQuery> Queries;
+		for(int Row = FirstRow; Row < FirstRow + Scenarios[Level] && Row < static_cast<int>(Entries.size()); Row++)
+		{
+			PathQuery Query;
+			Query.Start = Grid.ToIndex(Entries[Row].StartX, Entries[Row].StartY);
+			Query.Goal = Grid.ToIndex(Entries[Row].GoalX, Entries[Row].GoalY);
+			Queries.push_back(Query);
+		}
+		return Queries;
+	}
+
+	std::vector<PathQuery> LastLevelQueries(const GridMap& Grid, const std::vector<ScenarioEntry>& Entries)
+	{
+		return LevelQueries(Grid, Entries, 6);
+	}
+
+	/*
+	 * Moves the ships of the last level one cell per tick along their paths, like ALevelGenerator::SimulateShips does. A ship whose next
+	 * cell is occupied replans around it and every other ship three times: with a fresh optimal A* search, with the
+	 * kept D* Lite search of BatchPlanner::Replan and with the shared field of its goal from a GoalFieldCache. All
+	 * must find the same cost, the expansions and times are compared.
+	 */
+	int RunReplan(const Options& Opts, const GridMap& Grid, const std::vector<ScenarioEntry>& Entries)
+	{
+		const std::vector<PathQuery> Queries = LastLevelQueries(Grid, Entries);
+		const int ShipCount = static_cast<int>(Queries.size());
+
+		OccupancyGrid Occupancy;
+		Occupancy.Init(Grid.Num());
+		BatchPlanner Planner;
+		Planner.SetLandmarks(Opts.Setup.Landmarks, Opts.Setup.Selection);
+		Planner.SetHeuristicWeight(1);
+		Planner.SetGrid(&Grid);
+		Planner.SetOccupancy(&Occupancy);
+		Planner.SetReplanSlots(ShipCount);
+
+		PathPlanner Fresh;
+		Fresh.SetGrid(&Grid);
+		Fresh.SetHeuristicWeight(1);
+		Fresh.SetLandmarks(&Planner.GetLandmarkTable());
+		Fresh.SetComponents(&Planner.GetComponents(), &Planner.GetFreeWater());
+		Fresh.SetOccupancy(&Occupancy);
+
+		GoalFieldCache Fields;
+		Fields.SetGrid(&Grid);
+		Fields.SetCapacity(Opts.GoalFieldCapacity);
+		Fields.SetComponents(&Planner.GetFreeWater());
+		Fields.SetOccupancy(&Occupancy);
+
+		std::vector<PathResult> Plans;
+		Planner.PlanAll(Queries, Plans);
+		std::vector<int32_t> Position(ShipCount);
+		std::vector<size_t> Cursor(ShipCount, 0);
+		for(int Ship = 0; Ship < ShipCount; Ship++)
+		{
+			Position[Ship] = Queries[Ship].Start;
+			Occupancy.Place(Ship, Position[Ship]);
+			Planner.OnOccupancyChanged(Position[Ship]);
+		}
+
+		int64_t Replans = 0;
+		int64_t FreshExpansions = 0;
+		int64_t IncrementalExpansions = 0;
+		double FreshMilliseconds = 0;
+		double IncrementalMilliseconds = 0;
+		double FieldMilliseconds = 0;
+		int Mismatches = 0;
+		int Arrived = 0;
+		int Tick = 0;
+		std::vector<int32_t> FreshPath;
+		std::vector<int32_t> FieldPath;
+		PathResult Repaired;
+		//Ships that meet head on can keep stepping around each other forever, so the run is capped
+		for(; Tick < ReplanTickLimit && Arrived < ShipCount; Tick++)
+		{
+			Arrived = 0;
+			for(int Ship = 0; Ship < ShipCount; Ship++)
+			{
+				std::vector<int32_t>& Path = Plans[Ship].Path;
+				if(Cursor[Ship] == Path.size())
+				{
+					Arrived++;
+					continue;
+				}
+				const int32_t Next = Path[Cursor[Ship]];
+				if(Occupancy.IsHeld(Next) && Occupancy.GetHolder(Next) != Ship)
+				{
+					PathQuery Query;
+					Query.Start = Position[Ship];
+					Query.Goal = Queries[Ship].Goal;
+					Query.Options.AvoidCell = Next;
+					Query.Options.bAvoidOccupied = true;
+
+					auto StartTime = std::chrono::steady_clock::now();
+					const bool bFreshFound = Fresh.FindPath(Query.Start, Query.Goal, FreshPath, Query.Options);
+					FreshMilliseconds += MillisecondsSince(StartTime);
+					FreshExpansions += Fresh.GetLastExpansions();
+
+					StartTime = std::chrono::steady_clock::now();
+					const bool bFound = Planner.Replan(Ship, Query, Repaired);
+					IncrementalMilliseconds += MillisecondsSince(StartTime);
+					IncrementalExpansions += Repaired.Expansions;
+
+					StartTime = std::chrono::steady_clock::now();
+					const bool bFieldFound = Fields.FindPath(Query.Start, Query.Goal, FieldPath, Query.Options);
+					FieldMilliseconds += MillisecondsSince(StartTime);
+
+					Replans++;
+					if(bFound != bFreshFound || (bFound && Repaired.PathCost != Fresh.GetLastPathCost()))
+					{
+						Mismatches++;
+					}
+					if(bFieldFound != bFreshFound || (bFieldFound && Fields.GetLastPathCost() != Fresh.GetLastPathCost()))
+					{
+						Mismatches++;
+					}
+					if(bFound)
+					{
+						Path.swap(Repaired.Path);
+						Cursor[Ship] = 0;
+					}
+					//Blocked all around, wait for the others to move
+					continue;
+				}
+
+				//A whole cell per tick, so the move starts and ends at once
+				Occupancy.BeginMove(Ship, Next, static_cast<float>(Tick));
+				Occupancy.Arrive(Ship);
+				Planner.OnOccupancyChanged(Position[Ship]);
+				Planner.OnOccupancyChanged(Next);
+				Position[Ship] = Next;
+				Cursor[Ship]++;
+			}
+		}
+
+		std::printf("%d ships, %d arrived after %d ticks, %lld replans\n", ShipCount, Arrived, Tick, static_cast<long long>(Replans));
+		std::printf("%-12s %14s %12s\n", "replanner", "expansions", "time_ms");
+		std::printf("%-12s %14lld %12.3f\n", "fresh A*", static_cast<long long>(FreshExpansions), FreshMilliseconds);
+		std::printf("%-12s %14lld %12.3f\n", "D* Lite", static_cast<long long>(IncrementalExpansions), IncrementalMilliseconds);
+		//A field build is a Dijkstra over the whole map, counted as one expansion per cell it reached
+		const GoalFieldStats& FieldStats = Fields.GetStats();
+		std::printf("%-12s %14lld %12.3f\n", "goal field", static_cast<long long>(FieldStats.LocalExpansions + FieldStats.Misses * Grid.GetWidth() * Grid.GetHeight()), FieldMilliseconds);
+		std::printf("goal fields: capacity %d, %lld hits, %lld misses, %lld evicted, %.1f KB kept\n", Fields.GetCapacity(), static_cast<long long>(FieldStats.Hits),
+			static_cast<long long>(FieldStats.Misses), static_cast<long long>(FieldStats.Evictions), Fields.GetMemoryBytes() / 1024.0);
+		std::printf("goal field paths: %lld followed downhill, %lld searched around blocked cells with %lld expansions\n", static_cast<long long>(FieldStats.Descents),
+			static_cast<long long>(FieldStats.LocalSearches), static_cast<long long>(FieldStats.LocalExpansions));
+		std::printf("path cost mismatches %d\n", Mismatches);
+		return Mismatches == 0 ? 0 : 1;
+	}
+
+	/*
+	 * Moves the ships of the last level along their planned paths in real time, like ALevelGenerator::SimulateShips at 60 frames a
+	 * second, without replanning, and compares two crash detectors against the ships' actual positions. "cell" is the
+	 * rule the game used before OccupancyGrid: a ship claims the cell it moves into, frees it on arrival and counts a
+	 * crash when the ship it found there is within 90 units or just left that cell. "windowed" asks
+	 * OccupancyGrid::FindConflict when a ship sets off. A crash is true when the two ships' centres came closer than
+	 * 90 units during that move, a contact is missed when neither ship counted it.
+	 */
+	int RunOccupancy(const GridMap& Grid, const std::vector<ScenarioEntry>& Entries)
+	{
+		const std::vector<PathQuery> Queries = LastLevelQueries(Grid, Entries);
+		const int ShipCount = static_cast<int>(Queries.size());
+		BatchPlanner Planner;
+		Planner.SetGrid(&Grid);
+		std::vector<PathResult> Plans;
+		Planner.PlanAll(Queries, Plans);
+
+		//Same speed, tolerance and crash distance as AShip
+		const float CellSize = 100;
+		const float MoveSpeed = 500;
+		const float Tolerance = MoveSpeed / 20;
+		const float CrashDistance = 90;
+		const float DeltaTime = 1.0f / 60;
+		const int FrameLimit = 60 * 600;
+		//Halfway a ship crosses into the next cell, it holds the one it leaves until it arrives
+		const float CrossDistance = 0.5f * CellSize;
+
+		struct ShipState
+		{
+			float X = 0;
+			float Y = 0;
+			size_t Cursor = 0;
+			bool bMoving = false;
+			int SetOffFrame = 0;
+			int32_t LastNode = NoCell;
+		};
+		std::vector<ShipState> State(ShipCount);
+
+		//Contacts of a pair as frame ranges, and per detector whether one of its crashes covered them
+		struct Contact
+		{
+			int First = 0;
+			int Last = 0;
+			bool bFound[2] = {false, false};
+		};
+		std::vector<std::vector<Contact>> Contacts(ShipCount * ShipCount);
+		auto PairOf = [ShipCount](int A, int B) { return A < B ? A * ShipCount + B : B * ShipCount + A; };
+
+		struct Detector
+		{
+			int64_t Flagged = 0;
+			int64_t Crashes = 0;
+			int64_t True = 0;
+			double Milliseconds = 0;
+			std::vector<int32_t> Potential;
+		};
+		Detector Detectors[2];
+		for(Detector& Each : Detectors)
+		{
+			Each.Potential.assign(ShipCount, NoShip);
+		}
+		std::vector<int32_t> CellHolder(Grid.Num(), NoShip);
+		OccupancyGrid Occupancy;
+		Occupancy.Init(Grid.Num());
+
+		for(int Ship = 0; Ship < ShipCount; Ship++)
+		{
+			State[Ship].X = Grid.GetX(Queries[Ship].Start) * CellSize;
+			State[Ship].Y = Grid.GetY(Queries[Ship].Start) * CellSize;
+			State[Ship].LastNode = Queries[Ship].Start;
+			Occupancy.Place(Ship, Queries[Ship].Start);
+		}
+
+		auto CountCrash = [&](int Which, int Ship, int Frame)
+		{
+			Detector& Counting = Detectors[Which];
+			const int32_t Other = Counting.Potential[Ship];
+			Counting.Crashes++;
+			for(Contact& Touch : Contacts[PairOf(Ship, Other)])
+			{
+				if(Touch.Last >= State[Ship].SetOffFrame && Touch.First <= Frame)
+				{
+					Touch.bFound[Which] = true;
+					Counting.True++;
+					break;
+				}
+			}
+			//Head on both ships flag each other for the same crash, it counts once
+			const ShipState& Coming = State[Other];
+			if(Counting.Potential[Other] == Ship && Coming.bMoving && Plans[Other].Path[Coming.Cursor] == State[Ship].LastNode)
+			{
+				Counting.Potential[Other] = NoShip;
+			}
+			Counting.Potential[Ship] = NoShip;
+		};
+
+		std::vector<uint8_t> InContact(ShipCount * ShipCount, 0);
+		std::vector<int32_t> Arrivals;
+		std::vector<int32_t> SetOffs;
+		int64_t HeldCellsGathered = 0;
+		double GatherMilliseconds = 0;
+		std::vector<int32_t> HeldCells;
+		int Frame = 0;
+		int Arrived = 0;
+		for(; Frame < FrameLimit && Arrived < ShipCount; Frame++)
+		{
+			//Movement, the same for both detectors
+			Arrived = 0;
+			SetOffs.clear();
+			Arrivals.clear();
+			for(int Ship = 0; Ship < ShipCount; Ship++)
+			{
+				ShipState& Moving = State[Ship];
+				const std::vector<int32_t>& Path = Plans[Ship].Path;
+				if(Moving.Cursor == Path.size())
+				{
+					Arrived++;
+					continue;
+				}
+				if(!Moving.bMoving)
+				{
+					Moving.bMoving = true;
+					Moving.SetOffFrame = Frame;
+					SetOffs.push_back(Ship);
+				}
+				const float TargetX = Grid.GetX(Path[Moving.Cursor]) * CellSize;
+				const float TargetY = Grid.GetY(Path[Moving.Cursor]) * CellSize;
+				const float DX = TargetX - Moving.X;
+				const float DY = TargetY - Moving.Y;
+				const float Distance = std::sqrt(DX * DX + DY * DY);
+				const float Step = MoveSpeed * DeltaTime;
+				Moving.X += Distance > 0 ? DX / Distance * Step : 0;
+				Moving.Y += Distance > 0 ? DY / Distance * Step : 0;
+				if(std::fabs(TargetX - Moving.X) + std::fabs(TargetY - Moving.Y) <= Tolerance || Distance <= Step)
+				{
+					Moving.X = TargetX;
+					Moving.Y = TargetY;
+					Arrivals.push_back(Ship);
+				}
+			}
+
+			//What actually touched, parked ships included
+			for(int A = 0; A < ShipCount; A++)
+			{
+				for(int B = A + 1; B < ShipCount; B++)
+				{
+					const float DX = State[A].X - State[B].X;
+					const float DY = State[A].Y - State[B].Y;
+					const bool bTouching = DX * DX + DY * DY < CrashDistance * CrashDistance;
+					const int Pair = PairOf(A, B);
+					if(bTouching && !InContact[Pair])
+					{
+						Contacts[Pair].push_back(Contact{Frame, Frame});
+					}
+					else if(bTouching)
+					{
+						Contacts[Pair].back().Last = Frame;
+					}
+					InContact[Pair] = bTouching;
+				}
+			}
+
+			const float Now = Frame * DeltaTime;
+			auto StartTime = std::chrono::steady_clock::now();
+			for(const int32_t Ship : SetOffs)
+			{
+				const int32_t Next = Plans[Ship].Path[State[Ship].Cursor];
+				const int32_t Other = CellHolder[Next];
+				if(Other != NoShip && Other != Ship)
+				{
+					Detectors[0].Potential[Ship] = Other;
+					Detectors[0].Flagged++;
+				}
+				else
+				{
+					CellHolder[Next] = Ship;
+				}
+			}
+			for(const int32_t Ship : Arrivals)
+			{
+				const int32_t Next = Plans[Ship].Path[State[Ship].Cursor];
+				const int32_t Other = Detectors[0].Potential[Ship];
+				if(Other != NoShip)
+				{
+					const float DX = State[Ship].X - State[Other].X;
+					const float DY = State[Ship].Y - State[Other].Y;
+					if(DX * DX + DY * DY <= CrashDistance * CrashDistance || Next == State[Other].LastNode)
+					{
+						CountCrash(0, Ship, Frame);
+					}
+					Detectors[0].Potential[Ship] = NoShip;
+				}
+				if(Next != Queries[Ship].Goal && CellHolder[Next] == Ship)
+				{
+					CellHolder[Next] = NoShip;
+				}
+			}
+			Detectors[0].Milliseconds += MillisecondsSince(StartTime);
+
+			StartTime = std::chrono::steady_clock::now();
+			for(const int32_t Ship : SetOffs)
+			{
+				const int32_t Next = Plans[Ship].Path[State[Ship].Cursor];
+				const int32_t Other = Occupancy.FindConflict(Ship, Next, Now + CrossDistance / MoveSpeed);
+				if(Other != NoShip)
+				{
+					Detectors[1].Potential[Ship] = Other;
+					Detectors[1].Flagged++;
+				}
+				Occupancy.BeginMove(Ship, Next, Now + CellSize / MoveSpeed);
+			}
+			for(const int32_t Ship : Arrivals)
+			{
+				if(Detectors[1].Potential[Ship] != NoShip)
+				{
+					CountCrash(1, Ship, Frame);
+				}
+				Occupancy.Arrive(Ship);
+			}
+			Detectors[1].Milliseconds += MillisecondsSince(StartTime);
+
+			//What a replan would read in bulk
+			StartTime = std::chrono::steady_clock::now();
+			Occupancy.GetHeldCells(HeldCells);
+			GatherMilliseconds += MillisecondsSince(StartTime);
+			HeldCellsGathered += static_cast<int64_t>(HeldCells.size());
+
+			for(const int32_t Ship : Arrivals)
+			{
+				State[Ship].LastNode = Plans[Ship].Path[State[Ship].Cursor];
+				State[Ship].Cursor++;
+				State[Ship].bMoving = false;
+			}
+		}
+
+		int64_t ContactCount = 0;
+		int64_t Missed[2] = {0, 0};
+		for(const std::vector<Contact>& Pair : Contacts)
+		{
+			for(const Contact& Touch : Pair)
+			{
+				ContactCount++;
+				Missed[0] += Touch.bFound[0] ? 0 : 1;
+				Missed[1] += Touch.bFound[1] ? 0 : 1;
+			}
+		}
+
+		std::printf("%d ships, %d arrived after %d frames at 60 Hz, %lld contacts closer than %.0f units\n", ShipCount, Arrived, Frame, static_cast<long long>(ContactCount), CrashDistance);
+		std::printf("%-10s %8s %8s %8s %8s %8s %10s\n", "detector", "flagged", "crashes", "true", "false", "missed", "frame_us");
+		const char* Names[2] = {"cell", "windowed"};
+		for(int Which = 0; Which < 2; Which++)
+		{
+			const Detector& Each = Detectors[Which];
+			std::printf("%-10s %8lld %8lld %8lld %8lld %8lld %10.3f\n", Names[Which], static_cast<long long>(Each.Flagged), static_cast<long long>(Each.Crashes),
+				static_cast<long long>(Each.True), static_cast<long long>(Each.Crashes - Each.True), static_cast<long long>(Missed[Which]), Each.Milliseconds * 1000 / std::max(1, Frame));
+		}
+		const OccupancyStats& Stats = Occupancy.GetStats();
+		std::printf("windowed: %lld moves, %lld followed a ship out of its cell, %lld blocked, %lld head on\n", static_cast<long long>(Stats.Moves),
+			static_cast<long long>(Stats.Followed), static_cast<long long>(Stats.Blocked), static_cast<long long>(Stats.Oncoming));
+		std::printf("occupancy %.1f KB for %d cells, held cells gathered in %.3f us per frame (%.1f cells on average)\n", Occupancy.GetMemoryBytes() / 1024.0, Grid.Num(),
+			GatherMilliseconds * 1000 / std::max(1, Frame), static_cast<double>(HeldCellsGathered) / std::max(1, Frame));
+		return 0;
+	}
+
+	/*
+	 * Runs the same queries through a BatchPlanner with the path cache and one without, in three rounds: the whole
+	 * ladder, then every ship of the last level again from every 8th cell of its path (what a ship asks when it gets
+	 * back onto its route), then the ladder once more like a replayed game. Both planners must find the same costs,
+	 * and a cached planner with a worker per core must return the same paths and expansions as the one worker run,
+	 * in the rounds and in one batch of the last level with its mid-route queries, which can hit each other.
+	 */
+	int RunPathCache(const Options& Opts, const GridMap& Grid, const std::vector<ScenarioEntry>& Entries)
+	{
+		BatchPlanner Cached;
+		BatchPlanner Uncached;
+		BatchPlanner Threaded;
+		BatchPlanner SerialMixed;
+		BatchPlanner ThreadedMixed;
+		for(BatchPlanner* Planner : {&Cached, &Uncached, &Threaded, &SerialMixed, &ThreadedMixed})
+		{
+			Planner->SetHeuristicWeight(Opts.Setup.Weight);
+			Planner->SetSectorSize(Opts.Setup.SectorSize);
+			Planner->SetSearchMode(Opts.Setup.Mode);
+			Planner->SetLandmarks(Opts.Setup.Landmarks, Opts.Setup.Selection);
+			Planner->SetGrid(&Grid);
+			Planner->SetWorkerCount(1);
+		}
+		for(BatchPlanner* Planner : {&Cached, &Threaded, &SerialMixed, &ThreadedMixed})
+		{
+			Planner->SetPathCache(static_cast<size_t>(std::max(Opts.PathCacheKB, 0)) * 1024);
+		}
+		Threaded.SetWorkerCount(std::max(2, static_cast<int>(std::thread::hardware_concurrency())));
+		ThreadedMixed.SetWorkerCount(Threaded.GetWorkerCount());
+
+		std::vector<std::vector<PathQuery>> Ladder;
+		for(int Level = 0; Level < 7; Level++)
+		{
+			Ladder.push_back(LevelQueries(Grid, Entries, Level));
+		}
+		std::vector<PathQuery> MidRoute;
+		std::vector<PathResult> Plans;
+		Uncached.PlanAll(Ladder.back(), Plans);
+		for(size_t Ship = 0; Ship < Plans.size(); Ship++)
+		{
+			for(size_t Step = 7; Step + 1 < Plans[Ship].Path.size(); Step += 8)
+			{
+				PathQuery Query = Ladder.back()[Ship];
+				Query.Start = Plans[Ship].Path[Step];
+				MidRoute.push_back(Query);
+			}
+		}
+
+		std::printf("weight %d, %s, cache %d KB, suffix reuse %s\n", Opts.Setup.Weight, SearchModeName(Opts.Setup.Mode), Opts.PathCacheKB,
+			Opts.Setup.Weight <= 1 && Opts.Setup.Mode != SearchMode::Hierarchical ? "on" : "off");
+		std::printf("%-10s %8s %8s %8s %12s %12s %12s %12s\n", "round", "queries", "hits", "suffix", "expansions", "saved", "cached_ms", "uncached_ms");
+		int Mismatches = 0;
+		int ThreadMismatches = 0;
+		auto RunRound = [&](const char* Name, const std::vector<std::vector<PathQuery>>& Rounds)
+		{
+			const PathCacheStats Before = Cached.GetPathCache().GetStats();
+			int64_t Expansions = 0;
+			size_t Queries = 0;
+			double CachedMilliseconds = 0;
+			double UncachedMilliseconds = 0;
+			std::vector<PathResult> CachedResults;
+			std::vector<PathResult> UncachedResults;
+			std::vector<PathResult> ThreadedResults;
+			for(const std::vector<PathQuery>& Round : Rounds)
+			{
+				auto StartTime = std::chrono::steady_clock::now();
+				Cached.PlanAll(Round, CachedResults);
+				CachedMilliseconds += MillisecondsSince(StartTime);
+				StartTime = std::chrono::steady_clock::now();
+				Uncached.PlanAll(Round, UncachedResults);
+				UncachedMilliseconds += MillisecondsSince(StartTime);
+				Threaded.PlanAll(Round, ThreadedResults);
+
+				for(size_t i = 0; i < Round.size(); i++)
+				{
+					Expansions += CachedResults[i].Expansions;
+					if(CachedResults[i].bFound != UncachedResults[i].bFound || CachedResults[i].PathCost != UncachedResults[i].PathCost)
+					{
+						Mismatches++;
+					}
+					if(CachedResults[i].Path != ThreadedResults[i].Path || CachedResults[i].Expansions != ThreadedResults[i].Expansions)
+					{
+						ThreadMismatches++;
+					}
+				}
+				Queries += Round.size();
+			}
+			const PathCacheStats& After = Cached.GetPathCache().GetStats();
+			std::printf("%-10s %8zu %8lld %8lld %12lld %12lld %12.3f %12.3f\n", Name, Queries, static_cast<long long>(After.Hits - Before.Hits),
+				static_cast<long long>(After.SuffixHits - Before.SuffixHits), static_cast<long long>(Expansions),
+				static_cast<long long>(After.SavedExpansions - Before.SavedExpansions), CachedMilliseconds, UncachedMilliseconds);
+		};
+		RunRound("ladder", Ladder);
+		RunRound("mid-route", {MidRoute});
+		RunRound("replay", Ladder);
+
+		std::vector<PathQuery> Mixed = Ladder.back();
+		Mixed.insert(Mixed.end(), MidRoute.begin(), MidRoute.end());
+		std::vector<PathResult> SerialResults;
+		std::vector<PathResult> ThreadedResults;
+		SerialMixed.PlanAll(Mixed, SerialResults);
+		ThreadedMixed.PlanAll(Mixed, ThreadedResults);
+		for(size_t i = 0; i < Mixed.size(); i++)
+		{
+			if(SerialResults[i].Path != ThreadedResults[i].Path || SerialResults[i].Expansions != ThreadedResults[i].Expansions)
+			{
+				ThreadMismatches++;
+			}
+		}
+
+		const PathCache& Cache = Cached.GetPathCache();
+		const PathCacheStats& Stats = Cache.GetStats();
+		std::printf("%d paths kept in %.1f KB, %lld evicted\n", Cache.GetPathCount(), Cache.GetMemoryBytes() / 1024.0, static_cast<long long>(Stats.Evictions));
+		std::printf("%lld cells stored as %lld bytes of runs (%.1f bytes per cell, %.1fx smaller than cell indices)\n", static_cast<long long>(Stats.StoredCells),
+			static_cast<long long>(Stats.StoredRunBytes), Stats.StoredCells > 0 ? static_cast<double>(Stats.StoredRunBytes) / Stats.StoredCells : 0.0,
+			Stats.StoredRunBytes > 0 ? 4.0 * Stats.StoredCells / Stats.StoredRunBytes : 0.0);
+		std::printf("path cost mismatches %d\n", Mismatches);
+		std::printf("%d workers against 1: path or expansion mismatches %d\n", Threaded.GetWorkerCount(), ThreadMismatches);
+		return Mismatches == 0 && ThreadMismatches == 0 ? 0 : 1;
+	}
+
+	/*
+	 * Moves every ship from Positions to Next at once and counts the pairs that would crash: two ships ending in
+	 * the same cell, or two ships swapping cells. Owner is scratch of one entry per cell, all NoShip.
+	 */
+	int CountConflicts(const std::vector<int32_t>& Positions, const std::vector<int32_t>& Next, std::vector<int32_t>& Owner)
+	{
+		int Conflicts = 0;
+		for(size_t Ship = 0; Ship < Positions.size(); Ship++)
+		{
+			Owner[Positions[Ship]] = static_cast<int32_t>(Ship);
+		}
+		for(size_t Ship = 0; Ship < Positions.size(); Ship++)
+		{
+			const int32_t Other = Owner[Next[Ship]];
+			if(Other != NoShip && Other > static_cast<int32_t>(Ship) && Next[Other] == Positions[Ship] && Next[Ship] != Positions[Ship])
+			{
+				Conflicts++;
+			}
+		}
+		for(const int32_t Cell : Positions)
+		{
+			Owner[Cell] = NoShip;
+		}
+		for(size_t Ship = 0; Ship < Next.size(); Ship++)
+		{
+			if(Owner[Next[Ship]] != NoShip)
+			{
+				Conflicts++;
+			}
+			Owner[Next[Ship]] = static_cast<int32_t>(Ship);
+		}
+		for(const int32_t Cell : Next)
+		{
+			Owner[Cell] = NoShip;
+		}
+		return Conflicts;
+	}
+
+	/*
+	 * The path side of the ship update loop on the last level: every frame each ship reads the next cell of its path
+	 * and walks into it, and every Window frames the ships are handed a new plan the way cooperative planning does.
+	 * Once with paths that shift every cell left on arrival, the way AShip::Path did as a TArray with RemoveAt(0), and
+	 * once with ShipPath moving its cursor. Both have to walk through the same cells
+	 */
+	int RunShipUpdate(const Options& Opts, const GridMap& Grid, const std::vector<ScenarioEntry>& Entries)
+	{
+		BatchPlanner Planner;
+		Planner.SetGrid(&Grid);
+		std::vector<PathResult> Plans;
+		Planner.PlanAll(LastLevelQueries(Grid, Entries), Plans);
+
+		int Frames = 0;
+		size_t Cells = 0;
+		for(const PathResult& Plan : Plans)
+		{
+			Frames = std::max(Frames, static_cast<int>(Plan.Path.size()));
+			Cells += Plan.Path.size();
+		}
+		const int Window = std::max(1, Opts.Window);
+		const int Repetitions = std::max(1, Opts.Suite.Repetitions);
+		std::printf("%zu ships, %zu path cells, %d frames, new plans every %d frames, %d repetitions\n", Plans.size(), Cells, Frames, Window, Repetitions);
+
+		//The new plan is the rest of the old one, so both runs walk every cell once whatever the window
+		int64_t ShiftedSum = 0;
+		std::vector<std::vector<int32_t>> Shifted(Plans.size());
+		auto StartTime = std::chrono::steady_clock::now();
+		for(int Rep = 0; Rep < Repetitions; Rep++)
+		{
+			for(size_t Ship = 0; Ship < Plans.size(); Ship++)
+			{
+				Shifted[Ship] = Plans[Ship].Path;
+			}
+			for(int Frame = 0; Frame < Frames; Frame++)
+			{
+				for(size_t Ship = 0; Ship < Plans.size(); Ship++)
+				{
+					std::vector<int32_t>& Path = Shifted[Ship];
+					if(Frame > 0 && Frame % Window == 0)
+					{
+						const size_t Walked = Plans[Ship].Path.size() - Path.size();
+						Path.assign(Plans[Ship].Path.begin() + Walked, Plans[Ship].Path.end());
+					}
+					if(!Path.empty())
+					{
+						ShiftedSum += Path[0];
+						Path.erase(Path.begin());
+					}
+				}
+			}
+		}
+		const double ShiftedMilliseconds = MillisecondsSince(StartTime) / Repetitions;
+
+		int64_t CursorSum = 0;
+		std::vector<ShipPath> Cursors(Plans.size());
+		StartTime = std::chrono::steady_clock::now();
+		for(int Rep = 0; Rep < Repetitions; Rep++)
+		{
+			for(size_t Ship = 0; Ship < Plans.size(); Ship++)
+			{
+				Cursors[Ship].Assign(Plans[Ship].Path);
+			}
+			for(int Frame = 0; Frame < Frames; Frame++)
+			{
+				for(size_t Ship = 0; Ship < Plans.size(); Ship++)
+				{
+					ShipPath& Path = Cursors[Ship];
+					if(Frame > 0 && Frame % Window == 0)
+					{
+						const int32_t Walked = static_cast<int32_t>(Plans[Ship].Path.size()) - Path.Num();
+						Path.Assign(Plans[Ship].Path.data() + Walked, Path.Num());
+					}
+					if(!Path.IsEmpty())
+					{
+						CursorSum += Path[0];
+						Path.PopFront();
+					}
+				}
+			}
+		}
+		const double CursorMilliseconds = MillisecondsSince(StartTime) / Repetitions;
+
+		std::printf("%-10s %12s %14s\n", "path", "run_ms", "frame_us");
+		std::printf("%-10s %12.3f %14.3f\n", "shifted", ShiftedMilliseconds, ShiftedMilliseconds * 1000 / std::max(1, Frames));
+		std::printf("%-10s %12.3f %14.3f\n", "cursor", CursorMilliseconds, CursorMilliseconds * 1000 / std::max(1, Frames));
+		if(ShiftedSum != CursorSum)
+		{
+			std::printf("the cursor walked through different cells\n");
+			return 1;
+		}
+		return 0;
+	}
+
+	/*
+	 * One heap object per ship with its own virtual Tick, the way every AShip used to move itself: it reads its
+	 * location, heads for its target and writes location and rotation back, and the frame ends with a scan of every
+	 * ship for the ones on their goal
+	 */
+	class ActorShip
+	{
+
+	public:
+
+		virtual ~ActorShip() = default;
+
+		virtual void Tick(float DeltaTime)
+		{
+			if(!bMoving)
+			{
+				return;
+			}
+			//Same arithmetic as ShipFleet::Advance, so both runs arrive on the same frames
+			const float DX = TargetX - Location[0];
+			const float DY = TargetY - Location[1];
+			const float Distance = std::sqrt(DX * DX + DY * DY);
+			const float Step = Speed * DeltaTime;
+			const float InvDistance = 1 / (Distance + 1e-30f);
+			const float NewX = Location[0] + DX * InvDistance * Step;
+			const float NewY = Location[1] + DY * InvDistance * Step;
+			const float LeftX = TargetX - NewX;
+			const float LeftY = TargetY - NewY;
+			bArrived = LeftX * LeftX + LeftY * LeftY <= ToleranceSquared || Distance <= Step;
+			Location[0] = bArrived ? TargetX : NewX;
+			Location[1] = bArrived ? TargetY : NewY;
+			if(Distance > 0)
+			{
+				Yaw = std::atan2(DY, DX);
+			}
+			bMoving = !bArrived;
+		}
+
+		float Location[3] = {0, 0, 0};
+		float Yaw = 0;
+		float TargetX = 0;
+		float TargetY = 0;
+		float Speed = 0;
+		float ToleranceSquared = 0;
+		bool bMoving = false;
+		bool bArrived = false;
+		bool bAtGoal = false;
+	};
+
+	/*
+	 * Ship update loop at 100, 1000 and 10000 ships on a fixed 60 Hz step: ships set off through an OccupancyGrid,
+	 * move, arrive and stop on their goal, without replanning. The first ships are the scenario rows from the last
+	 * level on, the rest random connected water pairs from --seed. Once with one ActorShip per ship, once with a
+	 * ShipFleet. Both have to arrive on the same frames; the checksum of those frames is the regression value
+	 */
+	int RunFleet(const Options& Opts, const GridMap& Grid, const std::vector<ScenarioEntry>& Entries)
+	{
+		const float CellSize = 100;
+		const float MoveSpeed = 500;
+		const float Tolerance = MoveSpeed / 20;
+		const float DeltaTime = 1.0f / 60;
+		const int FrameLimit = 60 * 600;
+
+		ConnectedComponents Components;
+		Components.Build(Grid);
+		std::vector<int32_t> WaterCells;
+		for(int32_t Cell = 0; Cell < Grid.Num(); Cell++)
+		{
+			if(Grid.IsPassable(Cell))
+			{
+				WaterCells.push_back(Cell);
+			}
+		}
+
+		std::printf("%-8s %8s %8s %10s %12s %12s %12s %12s %18s\n", "ships", "frames", "arrived", "conflicts", "actor_us", "fleet_us", "actor_move", "fleet_move", "checksum");
+		int Result = 0;
+		for(const int ShipCount : Opts.FleetSizes)
+		{
+			int LastLevelRow = FirstScenarioRow;
+			for(int Level = 0; Level < 6; Level++)
+			{
+				LastLevelRow += Scenarios[Level];
+			}
+			std::vector<PathQuery> Queries;
+			for(int Row = LastLevelRow; static_cast<int>(Queries.size()) < ShipCount && Row < static_cast<int>(Entries.size()); Row++)
+			{
+				PathQuery Query;
+				Query.Start = Grid.ToIndex(Entries[Row].StartX, Entries[Row].StartY);
+				Query.Goal = Grid.ToIndex(Entries[Row].GoalX, Entries[Row].GoalY);
+				Queries.push_back(Query);
+			}
+			std::mt19937 Random(Opts.Suite.Seed);
+			std::uniform_int_distribution<size_t> Pick(0, WaterCells.size() - 1);
+			while(static_cast<int>(Queries.size()) < ShipCount)
+			{
+				PathQuery Query;
+				Query.Start = WaterCells[Pick(Random)];
+				Query.Goal = WaterCells[Pick(Random)];
+				if(Query.Start != Query.Goal && Components.CanReach(Query.Start, Query.Goal))
+				{
+					Queries.push_back(Query);
+				}
+			}
+			BatchPlanner Planner;
+			Planner.SetGrid(&Grid);
+			Planner.SetWorkerCount(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+			std::vector<PathResult> Plans;
+			Planner.PlanAll(Queries, Plans);
+
+			//What both runs share: claiming the next cell on setting off and letting go of the last one on arrival
+			OccupancyGrid Occupancy;
+			std::vector<size_t> Cursor;
+			std::vector<int> ArrivalFrame;
+			int64_t Conflicts = 0;
+			auto Begin = [&]()
+			{
+				Occupancy.Init(Grid.Num());
+				Cursor.assign(ShipCount, 0);
+				ArrivalFrame.assign(ShipCount, -1);
+				Conflicts = 0;
+				for(int Ship = 0; Ship < ShipCount; Ship++)
+				{
+					Occupancy.Place(Ship, Queries[Ship].Start);
+				}
+			};
+			auto SetOff = [&](int Ship, float Now)
+			{
+				const int32_t Next = Plans[Ship].Path[Cursor[Ship]];
+				Conflicts += Occupancy.FindConflict(Ship, Next, Now + 0.5f * CellSize / MoveSpeed) != NoShip ? 1 : 0;
+				Occupancy.BeginMove(Ship, Next, Now + CellSize / MoveSpeed);
+				return Next;
+			};
+			auto Arrive = [&](int Ship, int Frame)
+			{
+				Occupancy.Arrive(Ship);
+				ArrivalFrame[Ship] = Frame;
+				return ++Cursor[Ship] == Plans[Ship].Path.size();
+			};
+
+			Begin();
+			std::vector<std::unique_ptr<ActorShip>> Actors;
+			for(int Ship = 0; Ship < ShipCount; Ship++)
+			{
+				Actors.push_back(std::make_unique<ActorShip>());
+				Actors[Ship]->Location[0] = Grid.GetX(Queries[Ship].Start) * CellSize;
+				Actors[Ship]->Location[1] = Grid.GetY(Queries[Ship].Start) * CellSize;
+				Actors[Ship]->Location[2] = 20;
+				Actors[Ship]->Speed = MoveSpeed;
+				Actors[Ship]->ToleranceSquared = Tolerance * Tolerance;
+				Actors[Ship]->bAtGoal = Plans[Ship].Path.empty();
+			}
+			double ActorMilliseconds = 0;
+			double ActorMoveMilliseconds = 0;
+			int ActorFrames = 0;
+			for(bool bAllAtGoal = false; !bAllAtGoal && ActorFrames < FrameLimit; ActorFrames++)
+			{
+				const float Now = ActorFrames * DeltaTime;
+				const auto StartTime = std::chrono::steady_clock::now();
+				for(int Ship = 0; Ship < ShipCount; Ship++)
+				{
+					ActorShip& Actor = *Actors[Ship];
+					if(!Actor.bMoving && !Actor.bAtGoal)
+					{
+						const int32_t Next = SetOff(Ship, Now);
+						Actor.TargetX = Grid.GetX(Next) * CellSize;
+						Actor.TargetY = Grid.GetY(Next) * CellSize;
+						Actor.bMoving = true;
+					}
+				}
+				const auto MoveTime = std::chrono::steady_clock::now();
+				for(const std::unique_ptr<ActorShip>& Actor : Actors)
+				{
+					Actor->Tick(DeltaTime);
+				}
+				ActorMoveMilliseconds += MillisecondsSince(MoveTime);
+				for(int Ship = 0; Ship < ShipCount; Ship++)
+				{
+					if(Actors[Ship]->bArrived)
+					{
+						Actors[Ship]->bArrived = false;
+						Actors[Ship]->bAtGoal = Arrive(Ship, ActorFrames);
+					}
+				}
+				const auto ScanTime = std::chrono::steady_clock::now();
+				int AtGoal = 0;
+				for(const std::unique_ptr<ActorShip>& Actor : Actors)
+				{
+					AtGoal += Actor->bAtGoal ? 1 : 0;
+				}
+				bAllAtGoal = AtGoal == ShipCount;
+				ActorMoveMilliseconds += MillisecondsSince(ScanTime);
+				ActorMilliseconds += MillisecondsSince(StartTime);
+			}
+			const std::vector<int> ActorArrivals = ArrivalFrame;
+			const int64_t ActorConflicts = Conflicts;
+
+			Begin();
+			ShipFleet Fleet;
+			for(int Ship = 0; Ship < ShipCount; Ship++)
+			{
+				Fleet.Add(Grid.GetX(Queries[Ship].Start) * CellSize, Grid.GetY(Queries[Ship].Start) * CellSize, 20, MoveSpeed, Tolerance);
+				if(Plans[Ship].Path.empty())
+				{
+					Fleet.MarkAtGoal(Ship);
+				}
+			}
+			//Stands in for the actors' transforms, written in one pass over the ships that moved
+			std::vector<float> Transforms(ShipCount * 4, 0);
+			std::vector<int32_t> Moved;
+			std::vector<int32_t> Turned;
+			double FleetMilliseconds = 0;
+			double FleetMoveMilliseconds = 0;
+			int FleetFrames = 0;
+			for(; !Fleet.AllAtGoal() && FleetFrames < FrameLimit; FleetFrames++)
+			{
+				const float Now = FleetFrames * DeltaTime;
+				const auto StartTime = std::chrono::steady_clock::now();
+				for(int Ship = 0; Ship < ShipCount; Ship++)
+				{
+					if(!Fleet.IsMoving(Ship) && !Fleet.IsAtGoal(Ship))
+					{
+						const int32_t Next = SetOff(Ship, Now);
+						Fleet.SetTarget(Ship, Grid.GetX(Next) * CellSize, Grid.GetY(Next) * CellSize);
+					}
+				}
+				const auto MoveTime = std::chrono::steady_clock::now();
+				Fleet.Advance(DeltaTime);
+				FleetMoveMilliseconds += MillisecondsSince(MoveTime);
+				for(const int32_t Ship : Fleet.GetArrivals())
+				{
+					if(Arrive(Ship, FleetFrames))
+					{
+						Fleet.MarkAtGoal(Ship);
+					}
+				}
+				const auto PushTime = std::chrono::steady_clock::now();
+				Fleet.CollectChanged(Moved, Turned);
+				for(const int32_t Ship : Moved)
+				{
+					Transforms[Ship * 4] = Fleet.GetX(Ship);
+					Transforms[Ship * 4 + 1] = Fleet.GetY(Ship);
+					Transforms[Ship * 4 + 2] = Fleet.GetZ(Ship);
+				}
+				for(const int32_t Ship : Turned)
+				{
+					Transforms[Ship * 4] = Fleet.GetX(Ship);
+					Transforms[Ship * 4 + 1] = Fleet.GetY(Ship);
+					Transforms[Ship * 4 + 2] = Fleet.GetZ(Ship);
+					Transforms[Ship * 4 + 3] = std::atan2(Fleet.GetDirY(Ship), Fleet.GetDirX(Ship));
+				}
+				FleetMoveMilliseconds += MillisecondsSince(PushTime);
+				FleetMilliseconds += MillisecondsSince(StartTime);
+			}
+
+			//FNV-1a over the frame each ship last arrived on
+			uint64_t Checksum = 14695981039346656037ull;
+			for(const int Frame : ArrivalFrame)
+			{
+				Checksum = (Checksum ^ static_cast<uint32_t>(Frame)) * 1099511628211ull;
+			}
+			std::printf("%-8d %8d %8d %10lld %12.3f %12.3f %12.3f %12.3f %18llx\n", ShipCount, FleetFrames, Fleet.GetAtGoalCount(), static_cast<long long>(Conflicts),
+				ActorMilliseconds * 1000 / std::max(1, ActorFrames), FleetMilliseconds * 1000 / std::max(1, FleetFrames),
+				ActorMoveMilliseconds * 1000 / std::max(1, ActorFrames), FleetMoveMilliseconds * 1000 / std::max(1, FleetFrames), static_cast<unsigned long long>(Checksum));
+			if(ActorArrivals != ArrivalFrame || ActorConflicts != Conflicts || ActorFrames != FleetFrames)
+			{
+				std::printf("the fleet moved the %d ships differently from the actors\n", ShipCount);
+				Result = 1;
+			}
+		}
+		return Result;
+	}
+
+	/*
+	 * Runs the whole ladder through ShipSimulation, the real time ship, crash and replan loop on a step clock, with
+	 * the game's planner defaults (8 landmarks unless --landmarks says otherwise, path cache on). Every level runs
+	 * --reps times with a fresh simulation and must give the same checksum each time
+	 */
+	//The planner of the game's defaults, 8 landmarks unless --landmarks says otherwise and the path cache on
+	void SetUpSimulation(const Options& Opts, const GridMap& Grid, ShipSimulation& Simulation)
+	{
+		const int Landmarks = Opts.bLandmarksGiven ? Opts.Setup.Landmarks : 8;
+		Simulation.GetPlanner().SetHeuristicWeight(Landmarks > 0 ? 1 : Opts.Setup.Weight);
+		Simulation.GetPlanner().SetSectorSize(Opts.Setup.SectorSize);
+		Simulation.GetPlanner().SetSearchMode(Opts.Setup.Mode);
+		Simulation.GetPlanner().SetLandmarks(Landmarks, Opts.Setup.Selection);
+		Simulation.GetPlanner().SetPathCache(static_cast<size_t>(std::max(Opts.PathCacheKB, 0)) * 1024);
+		Simulation.SetGrid(&Grid);
+	}
+
+	int RunReplay(const Options& Opts, const GridMap& Grid, const std::vector<ScenarioEntry>& Entries)
+	{
+		const int Repetitions = std::max(1, Opts.Suite.Repetitions);
+		std::printf("seed %u, %d steps a move, replans %s, %d repetitions\n", Opts.Replay.Seed, Opts.Replay.StepsPerMove,
+			!Opts.Replay.bReplan ? "off" : (Opts.Replay.bIncremental ? "repaired" : "searched again"), Repetitions);
+		std::printf("%-6s %6s %8s %10s %10s %8s %10s %8s %12s %10s %18s\n", "level", "ships", "arrived", "planned", "taken", "crashes", "actual", "replans", "expansions", "time_ms", "checksum");
+
+		//The first repetition of each level is timed phase by phase, the others only as a whole
+		StatsCollector Stats;
+		int Differences = 0;
+		for(int Level = 0; Level < 7; Level++)
+		{
+			const std::vector<PathQuery> Queries = LevelQueries(Grid, Entries, Level);
+			SimulationResult First;
+			double Milliseconds = 0;
+			Stats.BeginScenario("L" + std::to_string(Level + 1));
+			for(int Rep = 0; Rep < Repetitions; Rep++)
+			{
+				StatsCollector* Collector = Rep == 0 && !Opts.Suite.JsonPath.empty() ? &Stats : nullptr;
+				//Nothing is kept between runs, so a repetition starts from the same planner state as the game's level
+				ShipSimulation Simulation;
+				{
+					const ScopedPhaseTimer Timer(Collector, "SetGrid");
+					SetUpSimulation(Opts, Grid, Simulation);
+				}
+				Simulation.SetStatsCollector(Collector);
+
+				const auto StartTime = std::chrono::steady_clock::now();
+				const SimulationResult Run = Simulation.Run(Queries, Opts.Replay);
+				Milliseconds += MillisecondsSince(StartTime);
+				if(Rep == 0)
+				{
+					First = Run;
+					const PlannerStats Searches = Simulation.GetPlanner().GetStats();
+					const PlannerStats& Repairs = Simulation.GetPlanner().GetReplanStats();
+					Stats.AddCount("Ships", Run.Ships);
+					Stats.AddCount("Arrived", Run.Arrived);
+					Stats.AddCount("Steps", Run.Steps);
+					Stats.AddCount("Crashes", Run.Crashes);
+					Stats.AddCount("Replans", Run.Replans);
+					Stats.AddCount("Expansions", Run.Expansions);
+					Stats.AddCount("Searches", Searches.Searches + Repairs.Searches);
+					Stats.SetMax("OpenPeak", Searches.OpenPeak);
+					Stats.AddCount("DecreaseKeys", Searches.DecreaseKeys);
+					Stats.AddCount("HeuristicEvaluations", Searches.HeuristicEvaluations);
+				}
+				else if(Run.Checksum != First.Checksum || Run.CostTaken != First.CostTaken || Run.CrashPenalty != First.CrashPenalty || Run.Expansions != First.Expansions)
+				{
+					Differences++;
+				}
+			}
+			std::printf("L%-5d %6d %8d %10lld %10lld %8lld %10lld %8lld %12lld %10.3f %18llx\n", Level + 1, First.Ships, First.Arrived, static_cast<long long>(First.PlannedCost),
+				static_cast<long long>(First.CostTaken), static_cast<long long>(First.Crashes), static_cast<long long>(First.CostTaken + First.CrashPenalty),
+				static_cast<long long>(First.Replans), static_cast<long long>(First.Expansions), Milliseconds / Repetitions, static_cast<unsigned long long>(First.Checksum));
+		}
+		if(!Opts.Suite.JsonPath.empty())
+		{
+			std::ofstream Json(Opts.Suite.JsonPath, std::ios::trunc);
+			Json << Stats.ToJson();
+		}
+		if(Differences > 0)
+		{
+			std::printf("%d repetitions differed from the first run of their level\n", Differences);
+			return 1;
+		}
+		return 0;
+	}
+
+	/*
+	 * Checks the bookkeeping ALevelGenerator draws its instanced path markers with. First a random run of plans, resets
+	 * and flushes is written into a copy of the instances the way FlushPathMarkers writes them, only the ranges each
+	 * flush names: after every flush the first instances must show the queued cells in order and all the others must
+	 * be hidden. Then every level of the
+	 * ladder is replayed with and without a PathMarkerBuffer fed by every plan and replan, and the ships must arrive
+	 * the same either way. Prints the markers each level queued, which used to be one actor spawn each, and the
+	 * instances that were created, moved and hidden instead
+	 */
+	int RunMarkers(const Options& Opts, const GridMap& Grid, const std::vector<ScenarioEntry>& Entries)
+	{
+		int Failures = 0;
+		std::mt19937 Random(Opts.Suite.Seed);
+		PathMarkerBuffer Scripted;
+		std::vector<int32_t> Instances;
+		std::vector<int32_t> Path;
+		for(int Round = 0; Round < 20000; Round++)
+		{
+			const uint32_t Action = Random() % 8;
+			if(Action == 0)
+			{
+				Scripted.Clear();
+				continue;
+			}
+			if(Action < 5)
+			{
+				Path.resize(Random() % 40);
+				for(int32_t& Cell : Path)
+				{
+					Cell = static_cast<int32_t>(Random() % Grid.Num());
+				}
+				Scripted.Add(Path);
+				continue;
+			}
+
+			const bool bChanged = Scripted.IsChanged();
+			const MarkerFlush Plan = Scripted.Flush();
+			const std::vector<int32_t>& Cells = Scripted.GetCells();
+			const int32_t End = Plan.First + Plan.Moved;
+			if(bChanged && (End + Plan.Hidden > static_cast<int32_t>(Instances.size()) || (Plan.Added > 0 && End != static_cast<int32_t>(Instances.size()))))
+			{
+				Failures++;
+				continue;
+			}
+			for(int32_t i = Plan.First; i < End; i++)
+			{
+				Instances[i] = Cells[i];
+			}
+			for(int32_t i = End; i < End + Plan.Hidden; i++)
+			{
+				Instances[i] = NoCell;
+			}
+			for(int32_t i = End; i < End + Plan.Added; i++)
+			{
+				Instances.push_back(Cells[i]);
+			}
+
+			bool bShown = static_cast<int32_t>(Instances.size()) == Scripted.GetInstanceCount() && Instances.size() >= Cells.size();
+			for(size_t i = 0; bShown && i < Instances.size(); i++)
+			{
+				bShown = Instances[i] == (i < Cells.size() ? Cells[i] : NoCell);
+			}
+			Failures += bShown ? 0 : 1;
+		}
+		std::printf("random plans, resets and flushes: %lld flushes, %d instances, %d wrong\n", static_cast<long long>(Scripted.GetStats().Flushes),
+			Scripted.GetInstanceCount(), Failures);
+
+		std::printf("%-6s %6s %8s %8s %10s %10s %10s %8s %10s %10s\n", "level", "ships", "arrived", "same", "markers", "instances", "flushes", "added", "moved", "hidden");
+		for(int Level = 0; Level < 7; Level++)
+		{
+			const std::vector<PathQuery> Queries = LevelQueries(Grid, Entries, Level);
+			ShipSimulation Plain;
+			SetUpSimulation(Opts, Grid, Plain);
+			const SimulationResult Expected = Plain.Run(Queries, Opts.Replay);
+
+			ShipSimulation Marked;
+			SetUpSimulation(Opts, Grid, Marked);
+			PathMarkerBuffer Markers;
+			Marked.SetPathMarkers(&Markers);
+			const SimulationResult Run = Marked.Run(Queries, Opts.Replay);
+
+			const bool bSame = Run.Arrived == Expected.Arrived && Run.Checksum == Expected.Checksum && Run.CostTaken == Expected.CostTaken;
+			Failures += bSame && Run.Arrived == Run.Ships ? 0 : 1;
+			const MarkerStats& Stats = Markers.GetStats();
+			std::printf("L%-5d %6d %8d %8s %10lld %10d %10lld %8lld %10lld %10lld\n", Level + 1, Run.Ships, Run.Arrived, bSame ? "yes" : "NO",
+				static_cast<long long>(Stats.Cells), Markers.GetInstanceCount(), static_cast<long long>(Stats.Flushes), static_cast<long long>(Stats.Added),
+				static_cast<long long>(Stats.Moved), static_cast<long long>(Stats.Hidden));
+		}
+		return Failures > 0 ? 1 : 0;
+	}
+
+	/*
+	 * Plans every ship on its own with optimal A* and moves them along their paths on a fixed step clock, each ship
+	 * waiting on its goal once it is there, the way the game did before the multi ship planners. Returns the crashes
+	 */
+	int RunIndependent(const GridMap& Grid, const std::vector<PathQuery>& Queries, std::vector<int32_t>& Owner, int64_t& OutCost, int& OutSteps)
+	{
+		BatchPlanner Independent;
+		Independent.SetHeuristicWeight(1);
+		Independent.SetGrid(&Grid);
+		std::vector<PathResult> Plans;
+		Independent.PlanAll(Queries, Plans);
+
+		const int ShipCount = static_cast<int>(Queries.size());
+		std::vector<int32_t> Positions(ShipCount);
+		std::vector<int32_t> Next(ShipCount);
+		for(int Ship = 0; Ship < ShipCount; Ship++)
+		{
+			Positions[Ship] = Queries[Ship].Start;
+		}
+		int Conflicts = 0;
+		OutCost = 0;
+		for(OutSteps = 0; ; OutSteps++)
+		{
+			bool bMoved = false;
+			for(int Ship = 0; Ship < ShipCount; Ship++)
+			{
+				const std::vector<int32_t>& Path = Plans[Ship].Path;
+				Next[Ship] = OutSteps < static_cast<int>(Path.size()) ? Path[OutSteps] : Positions[Ship];
+				bMoved |= Next[Ship] != Positions[Ship];
+			}
+			if(!bMoved)
+			{
+				break;
+			}
+			Conflicts += CountConflicts(Positions, Next, Owner);
+			Positions.swap(Next);
+		}
+		for(const PathResult& Plan : Plans)
+		{
+			OutCost += Plan.PathCost;
+		}
+		return Conflicts;
+	}
+
+	/*
+	 * Solves every level of the ladder with ECBS and checks the paths on a fixed step clock. Compares the sum of costs
+	 * with the independent plans, whose actual cost like in DetailActual adds the crash penalty of 50 per crash
+	 */
+	int RunConflictSearch(const Options& Opts, const GridMap& Grid, const std::vector<ScenarioEntry>& Entries)
+	{
+		ConflictSearch Solver;
+		Solver.SetGrid(&Grid);
+		Solver.SetSuboptimality(Opts.Suboptimality);
+		Solver.SetBudget(Opts.BudgetMilliseconds, Opts.MaxNodes);
+		std::vector<int32_t> Owner(Grid.Num(), NoShip);
+
+		std::printf("suboptimality %.2f, budget %.0f ms / %d nodes\n", Opts.Suboptimality, Opts.BudgetMilliseconds, Opts.MaxNodes);
+		std::printf("%-6s %6s %11s %8s %9s %11s %9s %10s %9s %9s %12s %8s %11s %7s %8s\n", "level", "ships", "indep_cost", "crashes", "actual",
+			"conflicts", "solved", "solve_ms", "hl_nodes", "move_cost", "sum_of_costs", "crashes", "path_allocs", "blocks", "peak_kb");
+		int Failures = 0;
+		for(int Level = 0; Level < 7; Level++)
+		{
+			const std::vector<PathQuery> Queries = LevelQueries(Grid, Entries, Level);
+			const int ShipCount = static_cast<int>(Queries.size());
+			std::vector<int32_t> Starts(ShipCount);
+			std::vector<int32_t> Goals(ShipCount);
+			for(int Ship = 0; Ship < ShipCount; Ship++)
+			{
+				Starts[Ship] = Queries[Ship].Start;
+				Goals[Ship] = Queries[Ship].Goal;
+			}
+
+			int64_t IndependentCost = 0;
+			int IndependentSteps = 0;
+			const int IndependentConflicts = RunIndependent(Grid, Queries, Owner, IndependentCost, IndependentSteps);
+
+			std::vector<std::vector<int32_t>> Paths;
+			const bool bSolved = Solver.Solve(Starts, Goals, Paths);
+			const ConflictSearchStats& Stats = Solver.GetStats();
+
+			//Replay the solution, every ship must reach its goal without a crash
+			int64_t MoveCost = 0;
+			int Conflicts = 0;
+			if(bSolved)
+			{
+				std::vector<int32_t> Positions = Starts;
+				std::vector<int32_t> Next(ShipCount);
+				size_t Steps = 0;
+				for(const std::vector<int32_t>& Path : Paths)
+				{
+					Steps = std::max(Steps, Path.size());
+				}
+				for(size_t Step = 0; Step < Steps; Step++)
+				{
+					for(int Ship = 0; Ship < ShipCount; Ship++)
+					{
+						Next[Ship] = Step < Paths[Ship].size() ? Paths[Ship][Step] : Positions[Ship];
+						MoveCost += Next[Ship] != Positions[Ship] ? Grid.GetTravelCost(Next[Ship]) : 0;
+					}
+					Conflicts += CountConflicts(Positions, Next, Owner);
+					Positions.swap(Next);
+				}
+				for(int Ship = 0; Ship < ShipCount; Ship++)
+				{
+					Conflicts += Positions[Ship] != Goals[Ship] ? 1 : 0;
+				}
+			}
+			Failures += !bSolved || Conflicts > 0 ? 1 : 0;
+
+			//The node paths come out of an arena that is reset per solve, blocks are only taken from the heap while it grows
+			const PathArenaStats& ArenaStats = Solver.GetPathArena().GetStats();
+			std::printf("L%-5d %6d %11lld %8d %9lld %11d %9s %10.3f %9lld %9lld %12lld %8d %11lld %7lld %8.1f\n", Level + 1, ShipCount,
+				static_cast<long long>(IndependentCost), IndependentConflicts, static_cast<long long>(IndependentCost + 50 * IndependentConflicts),
+				Stats.InitialConflicts, bSolved ? "yes" : Stats.bTimedOut ? "budget" : "no", Stats.Milliseconds, static_cast<long long>(Stats.HighLevelNodes),
+				static_cast<long long>(MoveCost), static_cast<long long>(Solver.GetSumOfCosts()), Conflicts, static_cast<long long>(ArenaStats.Allocations),
+				static_cast<long long>(ArenaStats.BlockAllocations), ArenaStats.PeakBytes / 1024.0);
+		}
+		return Failures == 0 ? 0 : 1;
+	}
+
+	/*
+	 * Runs the last level of the ladder twice on a fixed step clock, every ship moving one cell or waiting per step:
+	 * once with the independently planned paths (what the game did before, crashes included) and once with the
+	 * windowed cooperative planner. Reports the crashes, costs and steps of both, how fast the windows were
+	 * planned and how much memory a reservation takes.
+	 */
+	int RunCooperative(const Options& Opts, const GridMap& Grid, const std::vector<ScenarioEntry>& Entries)
+	{
+		const std::vector<PathQuery> Queries = LastLevelQueries(Grid, Entries);
+		const int ShipCount = static_cast<int>(Queries.size());
+		std::vector<int32_t> Goals(ShipCount);
+		std::vector<int32_t> Starts(ShipCount);
+		for(int Ship = 0; Ship < ShipCount; Ship++)
+		{
+			Starts[Ship] = Queries[Ship].Start;
+			Goals[Ship] = Queries[Ship].Goal;
+		}
+		std::vector<int32_t> Owner(Grid.Num(), NoShip);
+
+		int64_t IndependentCost = 0;
+		int IndependentSteps = 0;
+		const int IndependentConflicts = RunIndependent(Grid, Queries, Owner, IndependentCost, IndependentSteps);
+
+		CooperativePlanner Cooperative;
+		Cooperative.SetGrid(&Grid);
+		Cooperative.SetWindow(Opts.Window);
+		auto StartTime = std::chrono::steady_clock::now();
+		Cooperative.Begin(Goals);
+		const double BeginMilliseconds = MillisecondsSince(StartTime);
+
+		std::vector<int32_t> Positions = Starts;
+		std::vector<int32_t> Next(ShipCount);
+		std::vector<std::vector<int32_t>> Paths;
+		size_t Cursor = 0;
+		int Conflicts = 0;
+		int64_t Cost = 0;
+		int64_t Waits = 0;
+		int Arrived = 0;
+		int32_t Time = 0;
+		double PlanMilliseconds = 0;
+		size_t PeakSlotBytes = 0;
+		for(; Time < ReplanTickLimit; Time++)
+		{
+			Arrived = 0;
+			for(int Ship = 0; Ship < ShipCount; Ship++)
+			{
+				Arrived += Positions[Ship] == Goals[Ship] ? 1 : 0;
+			}
+			if(Arrived == ShipCount)
+			{
+				break;
+			}
+			if(Time % Cooperative.GetReplanInterval() == 0)
+			{
+				StartTime = std::chrono::steady_clock::now();
+				Cooperative.PlanWindows(Time, Positions, Paths);
+				PlanMilliseconds += MillisecondsSince(StartTime);
+				PeakSlotBytes = std::max(PeakSlotBytes, Cooperative.GetReservations().GetSlotBytes());
+				Cursor = 0;
+			}
+			for(int Ship = 0; Ship < ShipCount; Ship++)
+			{
+				Next[Ship] = Cursor < Paths[Ship].size() ? Paths[Ship][Cursor] : Positions[Ship];
+				if(Next[Ship] != Positions[Ship])
+				{
+					Cost += Grid.GetTravelCost(Next[Ship]);
+				}
+				else if(Positions[Ship] != Goals[Ship])
+				{
+					Waits++;
+				}
+			}
+			Cursor++;
+			Conflicts += CountConflicts(Positions, Next, Owner);
+			Positions.swap(Next);
+		}
+
+		const CooperativeStats& Stats = Cooperative.GetStats();
+		std::printf("%d ships, window %d, planned again every %d steps\n", ShipCount, Cooperative.GetWindow(), Cooperative.GetReplanInterval());
+		std::printf("%-12s %8s %10s %8s %8s %10s\n", "planner", "arrived", "move_cost", "waits", "steps", "crashes");
+		std::printf("%-12s %8d %10lld %8d %8d %10d\n", "independent", ShipCount, static_cast<long long>(IndependentCost), 0, IndependentSteps, IndependentConflicts);
+		std::printf("%-12s %8d %10lld %8lld %8d %10d\n", "cooperative", Arrived, static_cast<long long>(Cost), static_cast<long long>(Waits), Time, Conflicts);
+		std::printf("goal costs built in %.3f ms, %lld windows planned in %.3f ms (%.1f windows/s, %lld expansions, %lld boxed in)\n",
+			BeginMilliseconds, static_cast<long long>(Stats.Searches), PlanMilliseconds, PlanMilliseconds > 0 ? Stats.Searches * 1000.0 / PlanMilliseconds : 0.0,
+			static_cast<long long>(Stats.Expansions), static_cast<long long>(Stats.Failed));
+		std::printf("peak reservations %d, %zu slot bytes (%.1f bytes per reservation), planner memory %.1f KB\n",
+			Stats.PeakReservations, PeakSlotBytes, Stats.PeakReservations > 0 ? static_cast<double>(PeakSlotBytes) / Stats.PeakReservations : 0.0,
+			Cooperative.GetMemoryBytes() / 1024.0);
+		return Conflicts == 0 && Arrived == ShipCount ? 0 : 1;
+	}
+
+	/*
+	 * Plans the last level of the ladder (every ship at once, like ALevelGenerator::CalculatePath) with 1..MaxThreads
+	 * search contexts and reports the wall time of each. Every run is checked against the single threaded results.
+	 */
+	int RunScaling(const Options& Opts, const GridMap& Grid, const std::vector<ScenarioEntry>& Entries)
+	{
+		const std::vector<PathQuery> Queries = LastLevelQueries(Grid, Entries);
+
+		const int MaxThreads = Opts.Threads > 0 ? Opts.Threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+		const int Repetitions = std::max(1, Opts.Suite.Repetitions);
+		std::printf("%zu ships, up to %d threads (%u hardware threads), %d repetitions\n", Queries.size(), MaxThreads, std::thread::hardware_concurrency(), Repetitions);
+		std::printf("%-8s %10s %10s %s\n", "threads", "time_ms", "speedup", "results");
+
+		BatchPlanner Planner;
+		Planner.SetGrid(&Grid);
+		Planner.SetHeuristicWeight(Opts.Setup.Weight);
+		Planner.SetSectorSize(Opts.Setup.SectorSize);
+		Planner.SetSearchMode(Opts.Setup.Mode);
+		Planner.SetLandmarks(Opts.Setup.Landmarks, Opts.Setup.Selection);
+
+		std::vector<PathResult> Serial;
+		std::vector<PathResult> Results;
+		double SerialMilliseconds = 0;
+		bool bAllSame = true;
+
+		for(int Threads = 1; Threads <= MaxThreads; Threads++)
+		{
+			Planner.SetWorkerCount(Threads);
+			//One untimed run so every context has grown its scratch arrays
+			Planner.PlanAll(Queries, Results);
+
+			const auto StartTime = std::chrono::steady_clock::now();
+			for(int Rep = 0; Rep < Repetitions; Rep++)
+			{
+				Planner.PlanAll(Queries, Results);
+			}
+			const double Milliseconds = MillisecondsSince(StartTime) / Repetitions;
+
+			if(Threads == 1)
+			{
+				Serial = Results;
+				SerialMilliseconds = Milliseconds;
+			}
+			const bool bSame = SameResults(Serial, Results);
+			bAllSame = bAllSame && bSame;
+			std::printf("%-8d %10.3f %9.2fx %s\n", Threads, Milliseconds, SerialMilliseconds / Milliseconds, bSame ? "identical" : "DIFFERENT");
+		}
+		return bAllSame ? 0 : 1;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	Options Opts;
+	if(!ParseOptions(Argc, Argv, Opts))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if(Opts.bLoadTimes)
+	{
+		return RunLoadTimes(Opts);
+	}
+
+	if(Opts.bCook)
+	{
+		return RunCook(Opts);
+	}
+
+	if(Opts.bSuite)
+	{
+		Opts.Suite.Setup = Opts.Setup;
+		return RunBenchmarkSuite(Opts.Suite) > 0 ? 0 : 1;
+	}
+
+	std::string MapText;
+	std::string ScenarioText;
+	GridMap Grid;
+	std::vector<ScenarioEntry> Entries;
+
+	if(!LoadTextFile(Opts.MapPath, MapText) || !ParseMap(MapText, Grid))
+	{
+		std::fprintf(stderr, "Could not load map %s\n", Opts.MapPath.c_str());
+		return 1;
+	}
+	if(!LoadTextFile(Opts.ScenarioPath, ScenarioText) || !ParseScenario(ScenarioText, Entries))
+	{
+		std::fprintf(stderr, "Could not load scenario %s\n", Opts.ScenarioPath.c_str());
+		return 1;
+	}
+
+	if(Opts.bScaling)
+	{
+		return RunScaling(Opts, Grid, Entries);
+	}
+	if(Opts.bConflictSearch)
+	{
+		return RunConflictSearch(Opts, Grid, Entries);
+	}
+	if(Opts.bCooperative)
+	{
+		return RunCooperative(Opts, Grid, Entries);
+	}
+	if(Opts.bReplan)
+	{
+		return RunReplan(Opts, Grid, Entries);
+	}
+	if(Opts.bPathCache)
+	{
+		return RunPathCache(Opts, Grid, Entries);
+	}
+	if(Opts.bOccupancy)
+	{
+		return RunOccupancy(Grid, Entries);
+	}
+	if(Opts.bShipUpdate)
+	{
+		return RunShipUpdate(Opts, Grid, Entries);
+	}
+	if(Opts.bReplay)
+	{
+		return RunReplay(Opts, Grid, Entries);
+	}
+	if(Opts.bMarkers)
+	{
+		return RunMarkers(Opts, Grid, Entries);
+	}
+	if(Opts.bFleet)
+	{
+		return RunFleet(Opts, Grid, Entries);
+	}
+
+	PathPlanner Planner;
+	Planner.SetGrid(&Grid);
+	SearchData Data;
+	PrepareSearchData(Planner, Grid, Opts.Setup, Data);
+
+	std::printf("map %s (%dx%d), %zu scenario rows, weight %d, %s\n", Opts.MapPath.c_str(), Grid.GetWidth(), Grid.GetHeight(), Entries.size(), Opts.Setup.Weight,
+		SearchModeName(Opts.Setup.Mode));
+	if(Opts.Setup.Mode == SearchMode::Hierarchical)
+	{
+		std::printf("%d sectors of %d, %d entrance nodes\n", Data.Sectors.GetSectorCount(), Opts.Setup.SectorSize, Data.Sectors.GetNodeCount());
+	}
+	if(Opts.Setup.Landmarks > 0)
+	{
+		std::printf("%d %s landmarks\n", Data.Landmarks.GetCount(), Opts.Setup.Selection == LandmarkSelection::Random ? "random" : "farthest");
+	}
+	std::printf("%-6s %6s %12s %12s %10s\n", "level", "ships", "expansions", "path_cost", "time_ms");
+
+	std::vector<int32_t> Path;
+	int Row = FirstScenarioRow;
+	int64_t TotalExpansions = 0;
+	double TotalMilliseconds = 0;
+
+	for(int Level = 0; Level < 7; Level++)
+	{
+		int64_t LevelExpansions = 0;
+		int64_t LevelCost = 0;
+		double LevelMilliseconds = 0;
+
+		for(int i = 0; i < Scenarios[Level] && Row < static_cast<int>(Entries.size()); i++, Row++)
+		{
+			const ScenarioEntry& Entry = Entries[Row];
+			const int32_t Start = Grid.ToIndex(Entry.StartX, Entry.StartY);
+			const int32_t Goal = Grid.ToIndex(Entry.GoalX, Entry.GoalY);
+
+			const auto StartTime = std::chrono::steady_clock::now();
+			const bool bFound = Planner.FindPath(Start, Goal, Path);
+			const double Milliseconds = MillisecondsSince(StartTime);
+
+			LevelExpansions += Planner.GetLastExpansions();
+			LevelCost += Planner.GetLastPathCost();
+			LevelMilliseconds += Milliseconds;
+
+			if(Opts.bPrintRows)
+			{
+				std::printf("  row %4d (%d,%d)->(%d,%d) %s expansions %lld cost %d steps %zu time %.3f ms\n",
+					Row, Entry.StartX, Entry.StartY, Entry.GoalX, Entry.GoalY, bFound ? "found" : "unreachable",
+					static_cast<long long>(Planner.GetLastExpansions()), Planner.GetLastPathCost(), Path.size(), Milliseconds);
+			}
+		}
+
+		std::printf("L%-5d %6d %12lld %12lld %10.3f\n", Level + 1, Scenarios[Level], static_cast<long long>(LevelExpansions), static_cast<long long>(LevelCost), LevelMilliseconds);
+		TotalExpansions += LevelExpansions;
+		TotalMilliseconds += LevelMilliseconds;
+	}
+
+	std::printf("total expansions %lld, search time %.3f ms, node resets skipped %lld, unreachable goals rejected %lld\n",
+		static_cast<long long>(TotalExpansions), TotalMilliseconds, static_cast<long long>(Planner.GetNodeResetsSkipped()),
+		static_cast<long long>(Planner.GetStats().Unreachable));
+	std::printf("memory: flat scratch %zu KB, hierarchical scratch %zu KB, precomputed %zu KB built in %.3f ms\n",
+		Planner.GetFlatMemoryBytes() / 1024, Planner.GetHierarchicalMemoryBytes() / 1024, Data.MemoryBytes / 1024, Data.BuildMilliseconds);
+	return 0;
+}